@@ -5,7 +5,10 @@ import keras as K
 from collections import namedtuple
 
 
-Args = namedtuple("Args", "output namespace dropout flatten verbose")
+Args = namedtuple("Args", "output namespace dropout flatten verbose quantize calibration")
+# quantize: header written by Calibrator::write_header, the layers become int8 quantized layers
+# calibration: name of the constants of that header
+Args.__new__.__defaults__ = (None, "calibration")
 
 
 class LayerWrapper(object):
@@ -32,6 +35,12 @@ class LayerWrapper(object):
 
     CONVERSION = dict(zip(TYPES, NAMES))
 
+    QUANTIZED_NAMES = {
+        "ConvLayer1D": "QuantizedConvLayer1D<>",
+        "ConvLayer2D": "QuantizedConvLayer2D<>",
+        "DenseLayer": "QuantizedDenseLayer<>",
+    }
+
     ACTIVATIONS = {
         "relu": "ReLUActivation<TYPE>()",
         "softmax": "SoftmaxActivation<TYPE>()",
@@ -42,6 +51,9 @@ class LayerWrapper(object):
 
     def __init__(self, keras_layer, args):
         self.keras_layer = keras_layer
+        # index of the layer in the NeuralNetwork and of the parameters of its inputs, see write_layers
+        self.index = 0
+        self.input_index = 0
         self.use_dropout = args.dropout
         self.use_flatten = args.flatten
         self.args = args
@@ -80,14 +92,14 @@ class LayerWrapper(object):
                     print("")
 
                 wb, width, height, depth = res
-                f.write("TYPE arr_{}[] PROGMEM = {{\n".format(self.name))
+                f.write("{} arr_{}[] PROGMEM = {{\n".format(self.weights_type, self.name))
                 for i, w in enumerate(wb):
                     if i % width == 0 and i != 0:
                         f.write("\n")
                     f.write("{}, ".format(w))
                 if len(wb) % 20:
                     f.write("\n")
-                f.write("}};\ntensor<TYPE> w_{0}(ProgmemHelper<TYPE>(arr_{0}), /* width= */ {1}, /* height= */ {2}, /* depth= */ {3});\n\n".format(self.name, width, height, depth))
+                f.write("}};\ntensor<{4}> w_{0}(ProgmemHelper<{4}>(arr_{0}), /* width= */ {1}, /* height= */ {2}, /* depth= */ {3});\n\n".format(self.name, width, height, depth, self.weights_type))
         except KeyError:
             pass
 
@@ -95,18 +107,23 @@ class LayerWrapper(object):
         print("Writing layers for", self.name)
         if not last:
             shape = self.keras_layer.input_shape[1:]
-            f.write("InputLayer<TYPE> input({});\n".format(", ".join("/* {} */ {}".format(n, i) for n, i in zip("width height depth".split(), shape))))
+            f.write("InputLayer<{}> input({});\n".format(self.type, ", ".join("/* {} */ {}".format(n, i) for n, i in zip("width height depth".split(), shape))))
         try:
             getattr(self, "a_" + self.keras_layer.__class__.__name__)(f)
         except KeyError:
             pass
 
-        f.write("{}<TYPE> {}(".format(self.enn_class, self.name))
+        f.write("{} {}(".format(self.enn_type_class, self.name))
         if last:
             f.write(last.name)
         else:
             f.write("input")
+        if self.quantized:
+            f.write(", /* input_params= */ {}_params[{}]".format(self.args.calibration, self.input_index))
         getattr(self, "l_" + self.keras_layer.__class__.__name__)(f, last)
+        if self.quantized:
+            f.write(", /* output_params= */ {}_params[{}]".format(self.args.calibration, self.index))
+            f.write(", /* pre_params= */ {}_pre_params[{}]".format(self.args.calibration, self.index))
         f.write(");\n")
 
     @property
@@ -117,9 +134,28 @@ class LayerWrapper(object):
     def enn_class(self):
         return LayerWrapper.CONVERSION[self.keras_layer.__class__]
 
+    @property
+    def enn_type_class(self):
+        if self.quantized:
+            return LayerWrapper.QUANTIZED_NAMES[self.enn_class]
+        return "{}<{}>".format(self.enn_class, self.type)
+
+    @property
+    def quantized(self):
+        return self.args.quantize is not None and self.enn_class in LayerWrapper.QUANTIZED_NAMES
+
+    @property
+    def type(self):
+        return "int8_t" if self.args.quantize is not None else "TYPE"
+
+    @property
+    def weights_type(self):
+        """ quantized layers are imported from the float weights """
+        return "float" if self.args.quantize is not None else "TYPE"
+
     @property
     def enn_activation(self):
-        return LayerWrapper.ACTIVATIONS[self.keras_layer.activation.__name__]
+        return LayerWrapper.ACTIVATIONS[self.keras_layer.activation.__name__].replace("TYPE", self.weights_type)
 
     @property
     def active(self):
@@ -238,6 +274,15 @@ def export_model_to_header(model, args):
     layers = [LayerWrapper(l, args) for l in model.layers]
     layers = [l for l in layers if l.active]
 
+    # the input layer is layer 0 of the NeuralNetwork, pooling, flatten and dropout layers
+    # keep the quantization parameters of the layer before them
+    input_index = 0
+    for i, l in enumerate(layers):
+        l.index = i + 1
+        l.input_index = input_index
+        if l.quantized:
+            input_index = l.index
+
     with open(args.output, "w") as f:
         f.write("""// Automatically generated NN header using keras2enn.py
 //
@@ -245,13 +290,14 @@ def export_model_to_header(model, args):
 #define K2ENN_{0}_H
 
 #include <NeuralNetwork.h>
-
+{2}
 namespace {1} {{
 
 using namespace EasyNeuralNetworks;
 
 // Neural network weights definition
-""".format(args.output.split(".")[0].upper(), args.namespace))
+""".format(args.output.split(".")[0].upper(), args.namespace,
+           '#include "{}"\n'.format(args.quantize) if args.quantize is not None else ""))
 
         for l in layers:
             l.write_weights(f)
@@ -264,12 +310,12 @@ using namespace EasyNeuralNetworks;
             last = l
 
         f.write("""// Neural network
-NeuralNetwork<TYPE> nn({}, &input, {});
+NeuralNetwork<{}> nn({}, &input, {});
 
 }};
 
 #endif
-""".format(sum(l.active for l in layers) + 1, ", ".join("&" + l.name for l in layers if l.active)))
+""".format("int8_t" if args.quantize is not None else "TYPE", sum(l.active for l in layers) + 1, ", ".join("&" + l.name for l in layers if l.active)))
 
 
 def main(args):
@@ -286,6 +332,10 @@ if __name__ == "__main__":
                         help="Include DropOut layers (default False)")
     parser.add_argument("--flatten", const=True, default=False, action='store_const',
                         help="Include Flatten layers (default False)")
+    parser.add_argument("--quantize", default=None, metavar="CALIBRATION_HEADER",
+                        help="Write int8 quantized layers with the parameters of a header written by Calibrator::write_header (default None)")
+    parser.add_argument("--calibration", default="calibration",
+                        help="Name of the calibration constants, see Calibrator::write_header (default calibration)")
     parser.add_argument("-v", "--verbose", const=True, default=False, action='store_const', help="Verbose output to stdout")
     args = parser.parse_args()
 
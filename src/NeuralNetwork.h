@@ -8,6 +8,9 @@
 #include <activations/TanhActivation.h>
 #include <activations/SoftplusActivation.h>
 #include <activations/SoftmaxActivation.h>
+#include <activations/SigmoidLUTActivation.h>
+#include <activations/TanhLUTActivation.h>
+#include <activations/SoftplusLUTActivation.h>
 
 /// FF and RNN layers
 #include <layers/InputLayer.h>
@@ -35,14 +38,32 @@
 #include <layers/DropOutLayer1D.h>
 #include <layers/DropOutLayer2D.h>
 
+/// Quantized layers used for inference
+#include <layers/QuantizedDenseLayer.h>
+#include <layers/QuantizedConvLayer1D.h>
+#include <layers/QuantizedConvLayer2D.h>
+#include <layers/QuantizedWeightsDenseLayer.h>
+#include <layers/HalfWeightsDenseLayer.h>
+#include <layers/HalfWeightsLSTMLayer.h>
+
+/// Block floating point layers used for inference
+#include <layers/BlockFloatDenseLayer.h>
+#include <layers/BlockFloatConvLayer2D.h>
+
+/// Mixed precision layers used for inference
+#include <layers/ConversionLayer.h>
+#include <layers/MixedDenseLayer.h>
+
 /// Various data types
 #include <core/FixedPointType.h>
+#include <core/HalfFloatType.h>
 
 /// Loss functions
 #include <core/loss.h>
 
 #include <cstdarg>
 #include <vector>
+#include <type_traits>
 #include <stdlib.h>
 
 namespace EasyNeuralNetworks {
@@ -107,7 +128,7 @@ public:
 
 	inline void calculate() {
 		for (auto & L : _layers)
-			L->forward();
+			layer_forward(L);
 	}
 
 	///
@@ -139,8 +160,60 @@ public:
 	}
 };
 
+///
+/// A network of layers of different types, inference only. e.g. the first convolution and the last
+/// softmax stay float while the layers in between run in FixedPointType or int8, connected with
+/// ConversionLayer and MixedDenseLayer (which fuses the conversion into the dense kernel).
+/// T_IN is the type of the inputs of the first layer and T_OUT the type of the outputs of the last one,
+/// the types of the adjacent layers are checked at compile time, e.g.
+///		MixedNeuralNetwork<float, float> nn(&input, &conv, &to_fixed, &dense, &dense_to_float);
+///
+template<typename T_IN, typename T_OUT, typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+class MixedNeuralNetwork {
+	std::vector<LayerInterface*> _layers;
+	tensor<T_IN, T_SIZE> _input;
+	tensor<T_OUT, T_SIZE> _output;
+
+public:
+	template<typename T_FIRST, typename... T_LAYERS>
+	MixedNeuralNetwork(T_FIRST* first, T_LAYERS*... layers) {
+		_input = first->inputs();
+		add(first, layers...);
+	}
+
+	inline std::vector<LayerInterface*>& layers() { return _layers; }
+
+	inline tensor<T_IN, T_SIZE>& input() { return _input; }
+	inline tensor<T_OUT, T_SIZE>& output() { return _output; }
+	inline const tensor<T_IN, T_SIZE>& input() const { return _input; }
+	inline const tensor<T_OUT, T_SIZE>& output() const { return _output; }
+
+	inline void calculate() {
+		for (auto & L : _layers)
+			layer_forward(L);
+	}
+
+private:
+	template<typename T_LAST>
+	void add(T_LAST* last) {
+		_layers.push_back(last);
+		_output = last->outputs();
+	}
+
+	template<typename T_LAYER, typename T_NEXT, typename... T_LAYERS>
+	void add(T_LAYER* layer, T_NEXT* next, T_LAYERS*... layers) {
+		static_assert(std::is_same<typename std::decay<decltype(layer->outputs())>::type, typename std::decay<decltype(next->inputs())>::type>::value,
+			"the outputs of a layer must have the type of the inputs of the next one");
+		_layers.push_back(layer);
+		add(next, layers...);
+	}
+};
+
 };
 
 #include <trainers/BackPropTrainer.h>
 
+/// Calibration of the quantized and fixed point layers
+#include <core/Calibrator.h>
+
 #endif
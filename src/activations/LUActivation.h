@@ -17,8 +17,29 @@ public:
 	{
 		return 1;
 	}
+
+	virtual bool fused(fused_activation<T>& f) const {
+		f.op = ENN_FUSED_NONE;
+		return true;
+	}
+
+	/// identity, nothing to do
+	virtual void apply_forward_inplace(tensor<T, T_SIZE>& a) const {}
+	virtual void apply_backward_inplace(tensor<T, T_SIZE>& deltas, const tensor<T, T_SIZE>& outputs) const {
+		assert(deltas.size() == outputs.size());
+	}
 };
 
+///
+/// identity of the layers without an activation, e.g. pooling.
+/// layers keep a reference to their activation, so it can't be a temporary
+///
+template <typename T, typename T_SIZE>
+inline const ActivationBase<T, T_SIZE>& lu_activation() {
+	static const LUActivation<T, T_SIZE> lu;
+	return lu;
+}
+
 };
 
 #endif
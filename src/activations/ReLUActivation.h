@@ -2,11 +2,12 @@
 #define ENN_RELU_ACTIVATION_H
 
 #include <core/LayerBase.h>
+#include <core/matvecop.h>
 
 namespace EasyNeuralNetworks {
 
 template <typename T = ENN_DEFAULT_TYPE, typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
-class ReLUActivation : public ActivationBase<T, T_SIZE> {
+class ReLUActivation : public ActivationImpl<ReLUActivation<T, T_SIZE>, T, T_SIZE> {
 	T _negative_d;
 public:
 	ReLUActivation() : ReLUActivation(0) {}
@@ -21,6 +22,16 @@ public:
 	{
 		return val < 0 ? _negative_d : 1;
 	}
+
+	virtual bool fused(fused_activation<T>& f) const {
+		f.op = ENN_FUSED_RELU;
+		f.param = _negative_d;
+		return true;
+	}
+
+	virtual void apply_forward_inplace(tensor<T, T_SIZE>& a) const {
+		relu_arr<T, T_SIZE>(a.data(), a.data(), _negative_d, a.size());
+	}
 };
 
 };
@@ -2,13 +2,20 @@
 #define ENN_SIGMOID_ACTIVATION_H
 
 #include <core/LayerBase.h>
+#include <core/matvecop.h>
 #include <math.h>
 
 namespace EasyNeuralNetworks {
 
 template <typename T = ENN_DEFAULT_TYPE, typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
 class SigmoidActivation : public ActivationBase<T, T_SIZE> {
+	const ENN_MATH_ACCURACY _accuracy;
 public:
+	///
+	/// accuracy of the bulk functions, see ENN_MATH_ACCURACY
+	///
+	SigmoidActivation(ENN_MATH_ACCURACY accuracy = ENN_MATH_ACCURACY_DEFAULT) : _accuracy(accuracy) {}
+
 	inline virtual T forward(T val) const
 	{
 		return 1.0 / (1.0 + exp(-(double)val));
@@ -18,6 +25,22 @@ public:
 	{
 		return val * ((T)1 - val);
 	}
+
+	virtual bool fused(fused_activation<T>& f) const {
+		f.op = ENN_FUSED_MATH;
+		f.func = ENN_MATH_SIGMOID;
+		f.accuracy = _accuracy;
+		return true;
+	}
+
+	virtual void apply_forward_inplace(tensor<T, T_SIZE>& a) const {
+		sigmoid_arr<T, T_SIZE>(a.data(), a.data(), a.size(), _accuracy);
+	}
+
+	virtual void apply_backward_inplace(tensor<T, T_SIZE>& deltas, const tensor<T, T_SIZE>& outputs) const {
+		assert(deltas.size() == outputs.size());
+		math_grad_arr<T, T_SIZE>(ENN_MATH_SIGMOID, deltas.data(), outputs.data(), outputs.size(), _accuracy);
+	}
 };
 
 };
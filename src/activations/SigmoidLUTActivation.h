@@ -0,0 +1,60 @@
+#if !defined(ENN_SIGMOID_LUT_ACTIVATION_H)
+#define ENN_SIGMOID_LUT_ACTIVATION_H
+
+#include <core/LayerBase.h>
+#include <core/FixedPointLUT.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// Sigmoid for FixedPointType, using a linearly interpolated table of 2^BITS + 1 entries
+/// and integer arithmetic only, see FixedPointLUT.
+/// sigmoid(-x) = 1 - sigmoid(x), so only x >= 0 is tabulated.
+///
+template <typename T, typename T_SIZE = ENN_DEFAULT_SIZE_TYPE, int BITS = ENN_LUT_BITS_DEFAULT>
+class SigmoidLUTActivation : public ActivationBase<T, T_SIZE> {
+	typedef typename T::raw_type T_RAW;
+	typedef FixedPointLUT<ENN_MATH_SIGMOID, T_RAW, T::exponent, BITS> T_LUT;
+	typedef typename T_LUT::T_WIDE T_WIDE;
+public:
+	/// max |sigmoid(x) - forward(x)|
+	static constexpr double error_bound = T_LUT::error_bound;
+
+	static inline T sigmoid(T val) {
+		const T_WIDE x = val.get_raw();
+		if (x < 0)
+			return T::from_raw((T_RAW)(((T_WIDE)1 << T::exponent) - T_LUT::lookup(-x)));
+		return T::from_raw(T_LUT::lookup(x));
+	}
+
+	inline virtual T forward(T val) const
+	{
+		return sigmoid(val);
+	}
+
+	inline virtual T backward(T val) const
+	{
+		return val * ((T)1 - val);
+	}
+
+	virtual void apply_forward_inplace(tensor<T, T_SIZE>& a) const {
+		T * I = a.data();
+		for (T_SIZE i = 0; i < a.size(); i++)
+			I[i] = sigmoid(I[i]);
+	}
+
+	virtual void apply_backward_inplace(tensor<T, T_SIZE>& deltas, const tensor<T, T_SIZE>& outputs) const {
+		assert(deltas.size() == outputs.size());
+		T * D = deltas.data();
+		const T * O = outputs.data();
+		for (T_SIZE i = 0; i < outputs.size(); i++)
+			D[i] = D[i] * (O[i] * ((T)1 - O[i]));
+	}
+};
+
+template <typename T, typename T_SIZE, int BITS>
+constexpr double SigmoidLUTActivation<T, T_SIZE, BITS>::error_bound;
+
+};
+
+#endif
@@ -2,13 +2,20 @@
 #define ENN_SOFTMAX_ACTIVATION_H
 
 #include <core/LayerBase.h>
+#include <core/matvecop.h>
 #include <math.h>
 
 namespace EasyNeuralNetworks {
 
 template <typename T = ENN_DEFAULT_TYPE, typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
 class SoftmaxActivation : public ActivationBase<T, T_SIZE> {
+	const ENN_MATH_ACCURACY _accuracy;
 public:
+	///
+	/// accuracy of the bulk functions, see ENN_MATH_ACCURACY
+	///
+	SoftmaxActivation(ENN_MATH_ACCURACY accuracy = ENN_MATH_ACCURACY_DEFAULT) : _accuracy(accuracy) {}
+
 	inline virtual T forward(T val) const
 	{
 		return exp((double)val);
@@ -19,27 +26,24 @@ public:
 		return val * ((T)1 - val);
 	}
 
+	virtual bool elementwise() const { return false; }
+
 	virtual void apply_forward_inplace(tensor<T, T_SIZE>& a) const {
 		auto I = a.data();
 		auto num = a.size();
 
-		T mv = max_arr(NULL, I, num);
-		T acc = 0;
+		T mv = max_arr<T, T_SIZE>(NULL, I, num);
+		diff_arr<T, T_SIZE>(I, I, mv, num);
+		exp_arr<T, T_SIZE>(I, I, num, _accuracy);
 
-		while (num--) {
-			T tmp = forward(*I - mv);
-			*I = tmp;
-			acc += tmp;
-			++I;
-		}
-
-		I = a.data();
-		num = a.size();
+		T acc = sum_arr<T, T_SIZE>(I, num);
+		div_arr<T, T_SIZE>(I, I, acc, num);
+	}
 
-		while (num--) {
-			*I = *I / acc;
-			++I;
-		}
+	virtual void apply_backward_inplace(tensor<T, T_SIZE>& deltas, const tensor<T, T_SIZE>& outputs) const {
+		assert(deltas.size() == outputs.size());
+		// same as the sigmoid
+		math_grad_arr<T, T_SIZE>(ENN_MATH_SIGMOID, deltas.data(), outputs.data(), outputs.size(), _accuracy);
 	}
 };
 
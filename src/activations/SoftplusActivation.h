@@ -2,6 +2,7 @@
 #define ENN_SOFTPLUS_ACTIVATION_H
 
 #include <core/LayerBase.h>
+#include <core/matvecop.h>
 #include <math.h>
 
 namespace EasyNeuralNetworks {
@@ -9,16 +10,38 @@ namespace EasyNeuralNetworks {
 template <typename T = ENN_DEFAULT_TYPE, typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
 class SoftplusActivation : public ActivationBase<T, T_SIZE> {
 	const double ln1 = log(1);
+	const ENN_MATH_ACCURACY _accuracy;
 public:
+	///
+	/// accuracy of the bulk functions, see ENN_MATH_ACCURACY
+	///
+	SoftplusActivation(ENN_MATH_ACCURACY accuracy = ENN_MATH_ACCURACY_DEFAULT) : _accuracy(accuracy) {}
+
 	inline virtual T forward(T val) const
 	{
-		return log(1.0 + exp((double)val));
+		return math_func_exact<ENN_MATH_SOFTPLUS>((double)val);
 	}
 
+	/// sigmoid of the response, i.e. 1 - e^-val
 	inline virtual T backward(T val) const
 	{
-		double response = log(exp((double)val) - 1);
-		return 1 / (1 + exp(-response));
+		return 1.0 - exp(-(double)val);
+	}
+
+	virtual bool fused(fused_activation<T>& f) const {
+		f.op = ENN_FUSED_MATH;
+		f.func = ENN_MATH_SOFTPLUS;
+		f.accuracy = _accuracy;
+		return true;
+	}
+
+	virtual void apply_forward_inplace(tensor<T, T_SIZE>& a) const {
+		softplus_arr<T, T_SIZE>(a.data(), a.data(), a.size(), _accuracy);
+	}
+
+	virtual void apply_backward_inplace(tensor<T, T_SIZE>& deltas, const tensor<T, T_SIZE>& outputs) const {
+		assert(deltas.size() == outputs.size());
+		math_grad_arr<T, T_SIZE>(ENN_MATH_SOFTPLUS, deltas.data(), outputs.data(), outputs.size(), _accuracy);
 	}
 };
 
@@ -0,0 +1,68 @@
+#if !defined(ENN_SOFTPLUS_LUT_ACTIVATION_H)
+#define ENN_SOFTPLUS_LUT_ACTIVATION_H
+
+#include <core/LayerBase.h>
+#include <core/FixedPointLUT.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// Softplus for FixedPointType, using linearly interpolated tables of 2^BITS + 1 entries
+/// and integer arithmetic only, see FixedPointLUT.
+/// log(1 + e^x) = max(x, 0) + log(1 + e^-|x|), the gradient 1 - e^-y is looked up from
+/// a second table of e^-y.
+///
+template <typename T, typename T_SIZE = ENN_DEFAULT_SIZE_TYPE, int BITS = ENN_LUT_BITS_DEFAULT>
+class SoftplusLUTActivation : public ActivationBase<T, T_SIZE> {
+	typedef typename T::raw_type T_RAW;
+	typedef FixedPointLUT<ENN_MATH_SOFTPLUS, T_RAW, T::exponent, BITS> T_LUT;
+	typedef FixedPointLUT<ENN_MATH_EXP, T_RAW, T::exponent, BITS> T_EXP_LUT;
+	typedef typename T_LUT::T_WIDE T_WIDE;
+public:
+	/// max |softplus(x) - forward(x)|
+	static constexpr double error_bound = T_LUT::error_bound;
+
+	static inline T softplus(T val) {
+		const T_WIDE x = val.get_raw();
+		if (x < 0)
+			return T::from_raw(T_LUT::lookup(-x));
+		return T::from_raw((T_RAW)(x + T_LUT::lookup(x)));
+	}
+
+	/// 1 - e^-val, val >= 0
+	static inline T gradient(T val) {
+		const T_WIDE y = val.get_raw();
+		return T::from_raw((T_RAW)(((T_WIDE)1 << T::exponent) - T_EXP_LUT::lookup(y > 0 ? y : 0)));
+	}
+
+	inline virtual T forward(T val) const
+	{
+		return softplus(val);
+	}
+
+	inline virtual T backward(T val) const
+	{
+		return gradient(val);
+	}
+
+	virtual void apply_forward_inplace(tensor<T, T_SIZE>& a) const {
+		T * I = a.data();
+		for (T_SIZE i = 0; i < a.size(); i++)
+			I[i] = softplus(I[i]);
+	}
+
+	virtual void apply_backward_inplace(tensor<T, T_SIZE>& deltas, const tensor<T, T_SIZE>& outputs) const {
+		assert(deltas.size() == outputs.size());
+		T * D = deltas.data();
+		const T * O = outputs.data();
+		for (T_SIZE i = 0; i < outputs.size(); i++)
+			D[i] = D[i] * gradient(O[i]);
+	}
+};
+
+template <typename T, typename T_SIZE, int BITS>
+constexpr double SoftplusLUTActivation<T, T_SIZE, BITS>::error_bound;
+
+};
+
+#endif
@@ -0,0 +1,60 @@
+#if !defined(ENN_TANH_LUT_ACTIVATION_H)
+#define ENN_TANH_LUT_ACTIVATION_H
+
+#include <core/LayerBase.h>
+#include <core/FixedPointLUT.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// Tanh for FixedPointType, using a linearly interpolated table of 2^BITS + 1 entries
+/// and integer arithmetic only, see FixedPointLUT.
+/// tanh(-x) = -tanh(x), so only x >= 0 is tabulated.
+///
+template <typename T, typename T_SIZE = ENN_DEFAULT_SIZE_TYPE, int BITS = ENN_LUT_BITS_DEFAULT>
+class TanhLUTActivation : public ActivationBase<T, T_SIZE> {
+	typedef typename T::raw_type T_RAW;
+	typedef FixedPointLUT<ENN_MATH_TANH, T_RAW, T::exponent, BITS> T_LUT;
+	typedef typename T_LUT::T_WIDE T_WIDE;
+public:
+	/// max |tanh(x) - forward(x)|
+	static constexpr double error_bound = T_LUT::error_bound;
+
+	static inline T tanh(T val) {
+		const T_WIDE x = val.get_raw();
+		if (x < 0)
+			return T::from_raw((T_RAW)-T_LUT::lookup(-x));
+		return T::from_raw(T_LUT::lookup(x));
+	}
+
+	inline virtual T forward(T val) const
+	{
+		return tanh(val);
+	}
+
+	inline virtual T backward(T val) const
+	{
+		return (T)1 - val * val;
+	}
+
+	virtual void apply_forward_inplace(tensor<T, T_SIZE>& a) const {
+		T * I = a.data();
+		for (T_SIZE i = 0; i < a.size(); i++)
+			I[i] = tanh(I[i]);
+	}
+
+	virtual void apply_backward_inplace(tensor<T, T_SIZE>& deltas, const tensor<T, T_SIZE>& outputs) const {
+		assert(deltas.size() == outputs.size());
+		T * D = deltas.data();
+		const T * O = outputs.data();
+		for (T_SIZE i = 0; i < outputs.size(); i++)
+			D[i] = D[i] * ((T)1 - O[i] * O[i]);
+	}
+};
+
+template <typename T, typename T_SIZE, int BITS>
+constexpr double TanhLUTActivation<T, T_SIZE, BITS>::error_bound;
+
+};
+
+#endif
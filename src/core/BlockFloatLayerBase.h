@@ -0,0 +1,141 @@
+#if !defined(ENN_BLOCK_FLOAT_LAYER_BASE_H)
+#define ENN_BLOCK_FLOAT_LAYER_BASE_H
+
+#include <core/LayerBase.h>
+#include <core/matvecop.h>
+#include <activations/LUActivation.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// A base class of the block floating point layers, inference only, see arch/pure/mvo_bfp.h.
+///
+/// The outputs are int8_t or int16_t mantissas (T) with one exponent per depth slice
+/// (width * height values), see exponents(). Every layer takes the exponents of its input
+/// along with the input and picks the exponents of its outputs from their values, so unlike
+/// FixedPointType there is no exponent to choose for the whole network, and no calibration
+/// as for the int8 quantized layers.
+///
+/// The layers are imported from the float weights (same layout as the float layers):
+///		the weights of each output are split in the same blocks as the input, one exponent per block,
+///		each bias has its own exponent.
+///
+/// Block floating point layers form a NeuralNetwork<T>: the inputs are converted with to_bfp_arr
+/// and the outputs with from_bfp_arr, e.g. with one exponent for an input of N values:
+///		to_bfp_arr<int16_t, size_t>(input, input_exponents, x, N, N);
+/// Max and average pooling layers work on the mantissas as they are, since they keep the depth slices.
+/// Flatten and reshape layers keep the order of the values, a layer after them gets the exponents
+/// of the layer before them, the input is then split in as many blocks of equal size as it has exponents.
+///
+/// Identity and ReLU are applied to the integer sums, any other activation converts the outputs
+/// to float and back, which needs floating point arithmetic (emulated on targets without an FPU).
+///
+template <typename T = int16_t,
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+class BlockFloatLayerBase : public LayerBase<T, T_SIZE> {
+protected:
+	ENN_T_INPUT_TYPEDEF(T_INPUT);
+	ENN_T_LAYER_TYPEDEF(T_LAYER);
+	typedef tensor<int8_t, T_SIZE> T_EXPONENTS;
+	typedef tensor<float, T_SIZE> T_FLOAT_INPUT;
+	typedef ActivationBase<float, T_SIZE> T_FLOAT_ACTIVATION;
+
+	T_EXPONENTS _input_exponents;
+	T_EXPONENTS _exponents;
+	T_EXPONENTS _weight_exponents;
+	T_INPUT _bias;
+	T_EXPONENTS _bias_exponents;
+	tensor<int64_t, T_SIZE> _acc;
+	const T_FLOAT_ACTIVATION& _float_activation;
+	bool _relu;
+	bool _fused;
+	T_FLOAT_INPUT _float_outputs;
+public:
+	BlockFloatLayerBase(T_INPUT& input, T_EXPONENTS& input_exponents, const T_FLOAT_ACTIVATION& activation)
+		: T_LAYER(input, identity()), _float_activation(activation) {
+		assert(input_exponents.size() > 0 && input.size() % input_exponents.size() == 0);
+		_input_exponents = input_exponents;
+		fused_activation<float> f;
+		_fused = activation.fused(f) && (f.op == ENN_FUSED_NONE || (f.op == ENN_FUSED_RELU && f.param == 0));
+		_relu = _fused && f.op == ENN_FUSED_RELU;
+	}
+
+	/// exponents of the outputs, one per depth slice
+	inline T_EXPONENTS& exponents() { return _exponents; }
+	inline const T_EXPONENTS& exponents() const { return _exponents; }
+	inline const T_EXPONENTS& input_exponents() const { return _input_exponents; }
+	/// exponents of the blocks of the weights, one row per output
+	inline const T_EXPONENTS& weight_exponents() const { return _weight_exponents; }
+	inline const T_INPUT& bias() const { return _bias; }
+	inline const T_EXPONENTS& bias_exponents() const { return _bias_exponents; }
+
+	using T_LAYER::weights;
+
+	///
+	/// binds already converted weights, e.g. stored in flash, instead of importing the float weights.
+	/// see weights(), weight_exponents(), bias() and bias_exponents() of an imported layer.
+	///
+	virtual void weights(T_INPUT& weights, T_EXPONENTS& weight_exponents, T_INPUT& bias, T_EXPONENTS& bias_exponents) {
+		assert(weights.size() == this->weights().size());
+		assert(weight_exponents.size() == _weight_exponents.size());
+		T_LAYER::weights(weights);
+		_weight_exponents = weight_exponents;
+		_bias = bias;
+		_bias_exponents = bias_exponents;
+	}
+
+	/// block floating point layers are inference only
+	virtual void training_begin() {}
+	virtual void training_end() {}
+	virtual void backward(T_INPUT& deltas) {}
+	virtual void update(const T_INPUT& gradients, T alpha) {}
+
+protected:
+	static const ActivationBase<T, T_SIZE>& identity() {
+		static const LUActivation<T, T_SIZE> lu;
+		return lu;
+	}
+
+	/// number of values of the input per exponent
+	inline T_SIZE input_block() const { return this->inputs().size() / _input_exponents.size(); }
+
+	/// number of values of the outputs per exponent
+	inline T_SIZE output_block() const { return this->outputs().width() * this->outputs().height(); }
+
+	///
+	/// converts K rows of n float weights, each followed by its bias if bias is true,
+	/// the rows are split in blocks of block values. Weights become (n, K, 1)
+	///
+	void convert_weights(const float * weights, T_SIZE n, bool bias, T_SIZE K, T_SIZE block) {
+		const T_SIZE row = bias ? n + 1 : n;
+		const T_SIZE NB = (n + block - 1) / block;
+
+		this->weights().resize(n, K, 1);
+		_weight_exponents.resize(NB, K, 1);
+		if (bias) {
+			_bias.resize(K, 1, 1);
+			_bias_exponents.resize(K, 1, 1);
+		}
+		for (T_SIZE k = 0; k < K; k++, weights += row) {
+			to_bfp_arr<T, T_SIZE>(this->weights().data(k, 0), _weight_exponents.data(k, 0), weights, n, block);
+			if (bias)
+				_bias_exponents[k] = kernel_bfp_from_float(_bias.data() + k, weights + n, 1);
+		}
+	}
+
+	/// applies an activation which is not fused into kernel_bfp_normalize
+	void activation_forward() {
+		if (_fused)
+			return;
+		const T_SIZE block = output_block();
+		if (_float_outputs.size() != this->outputs().size())
+			_float_outputs.resize(this->outputs().width(), this->outputs().height(), this->outputs().depth());
+		from_bfp_arr<T, T_SIZE>(_float_outputs, this->outputs(), _exponents, this->outputs().size(), block);
+		_float_activation.apply_forward_inplace(_float_outputs);
+		to_bfp_arr<T, T_SIZE>(this->outputs(), _exponents, _float_outputs, this->outputs().size(), block);
+	}
+};
+
+};
+
+#endif
@@ -0,0 +1,353 @@
+#if !defined(ENN_CALIBRATOR_H)
+#define ENN_CALIBRATOR_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include <limits>
+#include <vector>
+#include <NeuralNetwork.h>
+#include <core/matvecop.h>
+
+///
+/// The magnitudes are counted in a log2 histogram of ENN_CALIBRATION_BINS_PER_OCTAVE bins
+/// per power of 2, from 2^ENN_CALIBRATION_MIN_OCTAVE to 2^(ENN_CALIBRATION_MIN_OCTAVE + ENN_CALIBRATION_OCTAVES),
+/// so a percentile is rounded up to at most 1 / ENN_CALIBRATION_BINS_PER_OCTAVE of an octave.
+///
+#if !defined(ENN_CALIBRATION_BINS_PER_OCTAVE)
+#define ENN_CALIBRATION_BINS_PER_OCTAVE 8
+#endif
+#define ENN_CALIBRATION_MIN_OCTAVE (-64)
+#define ENN_CALIBRATION_OCTAVES 128
+#define ENN_CALIBRATION_BINS (ENN_CALIBRATION_OCTAVES * ENN_CALIBRATION_BINS_PER_OCTAVE)
+
+namespace EasyNeuralNetworks {
+
+///
+/// statistics of the values of a tensor over a dataset, see Calibrator.
+/// min and max are exact, the mean and the standard deviation are combined from
+/// the moments of each sample (moments_arr), the percentiles come from the histograms
+/// of the negative and positive magnitudes.
+///
+class calibration_stats {
+	float _min;
+	float _max;
+	double _mean;
+	double _variance;
+	uint64_t _count;
+	std::vector<uint64_t> _histogram;
+public:
+	calibration_stats()
+		: _min(0), _max(0), _mean(0), _variance(0), _count(0), _histogram(2 * ENN_CALIBRATION_BINS, 0) {}
+
+	inline float min() const { return _min; }
+	inline float max() const { return _max; }
+	inline float mean() const { return (float)_mean; }
+	inline float stddev() const { return (float)sqrt(_variance); }
+	inline uint64_t count() const { return _count; }
+
+	void add(const float * a, size_t num) {
+		if (num == 0)
+			return;
+
+		size_t index;
+		const float mn = min_arr<float, size_t>(&index, a, num);
+		const float mx = max_arr<float, size_t>(&index, a, num);
+		_min = _count == 0 || mn < _min ? mn : _min;
+		_max = _count == 0 || mx > _max ? mx : _max;
+
+		// moments_arr returns the variance, and nothing for a single value
+		float mean = a[0], variance = 0;
+		moments_arr<float, size_t>(&mean, &variance, a, num);
+		const double n = (double)_count, m = (double)num, total = n + m;
+		const double delta = mean - _mean;
+		_variance = (_variance * n + variance * m + delta * delta * n * m / total) / total;
+		_mean += delta * m / total;
+		_count += num;
+
+		for (size_t i = 0; i < num; i++) {
+			if (a[i] != 0 && a[i] == a[i])
+				_histogram[(a[i] < 0 ? 0 : ENN_CALIBRATION_BINS) + bin(fabsf(a[i]))]++;
+		}
+	}
+
+	///
+	/// range of the values without the largest (100 - percentile)% of the negative
+	/// and of the positive values, e.g. 99.99 clips one value in 10000 on each side.
+	/// percentile 100 gives min() and max()
+	///
+	void range(float percentile, float * lo, float * hi) const {
+		*lo = _min;
+		*hi = _max;
+		if (percentile >= 100)
+			return;
+		const uint64_t tail = (uint64_t)(_count * (100.0 - percentile) / 100.0);
+		*lo = -clip(&_histogram[0], -_min, tail);
+		*hi = clip(&_histogram[ENN_CALIBRATION_BINS], _max, tail);
+	}
+
+	/// largest magnitude of range(percentile)
+	float absmax(float percentile = 100) const {
+		float lo, hi;
+		range(percentile, &lo, &hi);
+		return -lo > hi ? -lo : hi;
+	}
+
+private:
+	static inline size_t bin(float a) {
+		int e;
+		const float f = frexpf(a, &e);
+		const int octave = e - ENN_CALIBRATION_MIN_OCTAVE;
+		if (octave < 0)
+			return 0;
+		if (octave >= ENN_CALIBRATION_OCTAVES)
+			return ENN_CALIBRATION_BINS - 1;
+		return (size_t)octave * ENN_CALIBRATION_BINS_PER_OCTAVE + (size_t)((2 * f - 1) * ENN_CALIBRATION_BINS_PER_OCTAVE);
+	}
+
+	/// upper bound of the magnitudes of bin b
+	static inline float bin_edge(size_t b) {
+		const int e = (int)(b / ENN_CALIBRATION_BINS_PER_OCTAVE) + ENN_CALIBRATION_MIN_OCTAVE;
+		const float f = 0.5f + 0.5f * (b % ENN_CALIBRATION_BINS_PER_OCTAVE + 1) / ENN_CALIBRATION_BINS_PER_OCTAVE;
+		return ldexpf(f, e);
+	}
+
+	/// smallest bin edge with at most tail magnitudes above it, at most limit
+	static float clip(const uint64_t * histogram, float limit, uint64_t tail) {
+		if (limit <= 0)
+			return limit;
+		uint64_t above = 0;
+		for (size_t b = ENN_CALIBRATION_BINS; b-- > 0; ) {
+			above += histogram[b];
+			if (above > tail) {
+				const float edge = bin_edge(b);
+				return edge < limit ? edge : limit;
+			}
+		}
+		return 0;
+	}
+};
+
+///
+/// Picks the quantization parameters of a float NeuralNetwork from a representative dataset.
+///
+/// The samples are run through the network and the outputs of every layer are recorded
+/// (see calibration_stats), as are the network input and the weights of every layer. From them:
+///		output_params(i) are the int8 parameters of the outputs of layer i, e.g. the output_params
+///			of a QuantizedDenseLayer and the input_params of the layer after it, input_params()
+///			those of the network input;
+///		pre_activation_params(i) are those of the values of layer i before the activation, the
+///			pre_params of the quantized layers with a table activation, e.g. sigmoid;
+///		fixed_exponent<T>(i) is the largest EXPONENT of FixedPointType<T, EXPONENT> that holds the
+///			outputs and the weights of layer i, network_fixed_exponent<T>() the one for the whole network.
+/// A percentile below 100 clips the outliers, which trades saturating a few values for
+/// the resolution of all the others.
+///
+/// NOTE: the outputs are recorded after the activation. The fixed point sums before the activation
+/// saturate as well, e.g. before a sigmoid, headroom bits leave room for them.
+/// The pre-activation values are recovered from the outputs through the inverse of the activation
+/// (see fused_activation), saturated outputs are skipped since they have no finite inverse.
+///
+/// write_header writes the results as C++ constants, e.g. for a header generated by keras2enn.py --quantize.
+///
+template<typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+class Calibrator {
+	typedef tensor<float, T_SIZE> T_INPUT;
+	typedef LayerBase<float, T_SIZE> T_LAYER;
+	NeuralNetwork<float, T_SIZE>& _network;
+	calibration_stats _input;
+	std::vector<calibration_stats> _outputs;
+	std::vector<calibration_stats> _pre_activations;
+	std::vector<calibration_stats> _weights;
+	std::vector<float> _pre;
+	uint64_t _samples;
+public:
+	Calibrator(NeuralNetwork<float, T_SIZE>& network)
+		: _network(network), _outputs(network.layers().size()), _pre_activations(network.layers().size()),
+		  _weights(network.layers().size()), _samples(0) {
+		for (size_t i = 0; i < _weights.size(); i++) {
+			const T_INPUT& w = _network.layers()[i]->weights();
+			_weights[i].add(w.data(), w.size());
+		}
+	}
+
+	/// number of layers
+	inline size_t size() const { return _outputs.size(); }
+	/// number of samples recorded
+	inline uint64_t samples() const { return _samples; }
+	inline const calibration_stats& input() const { return _input; }
+	inline const calibration_stats& outputs(size_t layer) const { return _outputs[layer]; }
+	/// empty if the activation of the layer can't be inverted, e.g. softmax
+	inline const calibration_stats& pre_activations(size_t layer) const { return _pre_activations[layer]; }
+	inline const calibration_stats& weights(size_t layer) const { return _weights[layer]; }
+
+	///
+	/// runs the samples through the network and records them.
+	/// samples are stacked on depth as the inputs of NeuralNetwork::train
+	///
+	void add(const T_INPUT& samples) {
+		const T_SIZE depth = _network.input().depth();
+		assert(samples.depth() % depth == 0);
+		for (T_SIZE z = 0; z < samples.depth(); z += depth) {
+			_network.input().copy(samples.window(z, depth));
+			_network.calculate();
+			record();
+		}
+	}
+
+	/// records the current input and outputs of the network, e.g. after calculate() on a sequence
+	void record() {
+		_input.add(_network.input().data(), _network.input().size());
+		for (size_t i = 0; i < _outputs.size(); i++) {
+			const T_INPUT& out = _network.layers()[i]->outputs();
+			_outputs[i].add(out.data(), out.size());
+			record_pre_activations(i, out);
+		}
+		_samples++;
+	}
+
+	inline quant_params input_params(float percentile = 100) const {
+		float lo, hi;
+		_input.range(percentile, &lo, &hi);
+		return quant_params_from_range(lo, hi);
+	}
+
+	/// int8 parameters of the outputs of layer
+	inline quant_params output_params(size_t layer, float percentile = 100) const {
+		float lo, hi;
+		_outputs[layer].range(percentile, &lo, &hi);
+		return quant_params_from_range(lo, hi);
+	}
+
+	///
+	/// int8 parameters of the values of layer before the activation, see QuantizedLayerBase.
+	/// quant_table_params() if they were not recorded
+	///
+	inline quant_params pre_activation_params(size_t layer, float percentile = 100) const {
+		if (_pre_activations[layer].count() == 0)
+			return quant_table_params();
+		float lo, hi;
+		_pre_activations[layer].range(percentile, &lo, &hi);
+		return quant_params_from_range(lo, hi);
+	}
+
+	/// EXPONENT of FixedPointType<T, EXPONENT> for the outputs and the weights of layer
+	template<typename T>
+	int fixed_exponent(size_t layer, float percentile = 100, int headroom = 0) const {
+		const float out = _outputs[layer].absmax(percentile);
+		const float w = _weights[layer].absmax();
+		return fixed_exponent_from_range<T>(out > w ? out : w, headroom);
+	}
+
+	/// EXPONENT of FixedPointType<T, EXPONENT> for the whole network, including its input
+	template<typename T>
+	int network_fixed_exponent(float percentile = 100, int headroom = 0) const {
+		int e = fixed_exponent_from_range<T>(_input.absmax(percentile), headroom);
+		for (size_t i = 0; i < _outputs.size(); i++) {
+			const int l = fixed_exponent<T>(i, percentile, headroom);
+			e = l < e ? l : e;
+		}
+		return e;
+	}
+
+	///
+	/// writes the calibration as C++ constants named name_* into buf, at most size characters
+	/// including the terminating 0 as snprintf does, and returns the length of the whole text.
+	///		name_input_params and name_params[layers]: quant_params of the input and of the outputs of each layer
+	///		name_pre_params[layers]: quant_params of the values of each layer before the activation
+	///		name_fixed16_exponents[layers] and name_fixed16_exponent: fixed_exponent<int16_t> and network_fixed_exponent<int16_t>, same for int32_t
+	///
+	size_t write_header(char * buf, size_t size, const char * name = "calibration", float percentile = 100, int headroom = 0) const {
+		header_writer w(buf, size);
+		const size_t L = _outputs.size();
+		w("// Calibration of %u layers over %lu samples, percentile %g, headroom %d\n", (unsigned)L, (unsigned long)_samples, percentile, headroom);
+		w("// layer: min, max, mean, stddev, weights min, weights max\n");
+		w("//\tinput: %g, %g, %g, %g\n", _input.min(), _input.max(), _input.mean(), _input.stddev());
+		for (size_t i = 0; i < L; i++)
+			w("//\t%u: %g, %g, %g, %g, %g, %g\n", (unsigned)i, _outputs[i].min(), _outputs[i].max(), _outputs[i].mean(), _outputs[i].stddev(), _weights[i].min(), _weights[i].max());
+
+		const quant_params in = input_params(percentile);
+		w("const EasyNeuralNetworks::quant_params %s_input_params = { %.9g, %d };\n", name, in.scale, (int)in.zero_point);
+		w("const EasyNeuralNetworks::quant_params %s_params[%u] = {\n", name, (unsigned)L);
+		for (size_t i = 0; i < L; i++) {
+			const quant_params p = output_params(i, percentile);
+			w("\t{ %.9g, %d },\n", p.scale, (int)p.zero_point);
+		}
+		w("};\n");
+		w("const EasyNeuralNetworks::quant_params %s_pre_params[%u] = {\n", name, (unsigned)L);
+		for (size_t i = 0; i < L; i++) {
+			const quant_params p = pre_activation_params(i, percentile);
+			w("\t{ %.9g, %d },\n", p.scale, (int)p.zero_point);
+		}
+		w("};\n");
+
+		write_exponents<int16_t>(w, name, "fixed16", percentile, headroom);
+		write_exponents<int32_t>(w, name, "fixed32", percentile, headroom);
+		return w.length;
+	}
+
+private:
+	/// x of y = f(x), NaN or infinite if there is none
+	static double inverse(const fused_activation<float>& f, double y) {
+		switch (f.op) {
+			case ENN_FUSED_NONE: return y;
+			case ENN_FUSED_RELU:
+				if (y > 0)
+					return y;
+				if (y < 0 && f.param != 0)
+					return y / f.param;
+				break;
+			case ENN_FUSED_MATH:
+				switch (f.func) {
+					case ENN_MATH_EXP: return log(y);
+					case ENN_MATH_TANH: return atanh(y);
+					case ENN_MATH_SIGMOID: return log(y / (1 - y));
+					case ENN_MATH_SOFTPLUS: return log(expm1(y));
+				}
+		}
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+
+	void record_pre_activations(size_t layer, const T_INPUT& out) {
+		fused_activation<float> f;
+		if (!_network.layers()[layer]->activation().fused(f))
+			return;
+		_pre.clear();
+		for (T_SIZE i = 0; i < out.size(); i++) {
+			const double x = inverse(f, out.data()[i]);
+			if (fabs(x) <= std::numeric_limits<float>::max())
+				_pre.push_back((float)x);
+		}
+		_pre_activations[layer].add(_pre.data(), _pre.size());
+	}
+
+	struct header_writer {
+		char * buf;
+		size_t size;
+		size_t length;
+		header_writer(char * buf, size_t size) : buf(buf), size(size), length(0) {
+			if (size)
+				buf[0] = 0;
+		}
+		void operator () (const char * format, ...) {
+			va_list args;
+			va_start(args, format);
+			const int n = vsnprintf(length < size ? buf + length : NULL, length < size ? size - length : 0, format, args);
+			va_end(args);
+			length += n > 0 ? n : 0;
+		}
+	};
+
+	template<typename T>
+	void write_exponents(header_writer& w, const char * name, const char * type, float percentile, int headroom) const {
+		w("const int %s_%s_exponents[%u] = {", name, type, (unsigned)_outputs.size());
+		for (size_t i = 0; i < _outputs.size(); i++)
+			w(" %d,", fixed_exponent<T>(i, percentile, headroom));
+		w(" };\n");
+		w("const int %s_%s_exponent = %d;\n", name, type, network_fixed_exponent<T>(percentile, headroom));
+	}
+};
+
+};
+
+#endif
@@ -0,0 +1,177 @@
+#if !defined(ENN_FIXED_POINT_LUT_H)
+#define ENN_FIXED_POINT_LUT_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <core/FixedPointType.h>
+#include <core/arch/pure/mvo_math.h>
+
+///
+/// Tables are constant initialized, so they end up in rodata. On the targets where
+/// rodata is copied into RAM they are placed into flash and read with memcpy_P.
+///
+#if !defined(ENN_LUT_PROGMEM)
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define ENN_LUT_PROGMEM PROGMEM
+#define ENN_LUT_MEMCPY memcpy_P
+#elif defined(ARDUINO_ARCH_ESP8266)
+#include <pgmspace.h>
+#define ENN_LUT_PROGMEM PROGMEM
+#define ENN_LUT_MEMCPY memcpy_P
+#else
+#define ENN_LUT_PROGMEM
+#define ENN_LUT_MEMCPY memcpy
+#endif
+#endif
+
+/// default table resolution, the tables have 2^ENN_LUT_BITS_DEFAULT + 1 entries
+#if !defined(ENN_LUT_BITS_DEFAULT)
+#define ENN_LUT_BITS_DEFAULT 8
+#endif
+
+namespace EasyNeuralNetworks {
+
+///
+/// Compile time helpers used to generate the tables, C++11 constexpr
+///
+namespace lut {
+
+constexpr double sqr(double x) { return x * x; }
+constexpr double pow2(int k) { return k < 0 ? 1.0 / pow2(-k) : k == 0 ? 1.0 : 2.0 * pow2(k - 1); }
+constexpr int ceil_log2(double x, int k = 0) { return pow2(k) >= x ? k : ceil_log2(x, k + 1); }
+
+/// e^x = sum(x^n / n!), |x| <= 1/2
+constexpr double exp_series(double x, int n, double term) {
+	return n > 30 || (term < 0 ? -term : term) < 1e-17 ? term : term + exp_series(x, n + 1, term * x / (n + 1));
+}
+/// e^x = (e^(x/2))^2
+constexpr double exp(double x) { return x > 0.5 || x < -0.5 ? sqr(exp(x / 2)) : exp_series(x, 0, 1.0); }
+
+/// atanh(u) / u = sum(u^2k / (2k + 1))
+constexpr double atanh_series(double u2, double term, int k) {
+	return k > 30 || term < 1e-17 ? term / (2 * k + 1) : term / (2 * k + 1) + atanh_series(u2, term * u2, k + 1);
+}
+constexpr double log1p_u(double u) { return 2.0 * u * atanh_series(u * u, 1.0, 0); }
+/// log(1 + t) = 2 * atanh(t / (2 + t)), 0 <= t <= 1
+constexpr double log1p(double t) { return log1p_u(t / (2.0 + t)); }
+
+///
+/// Tabulated functions of x >= 0, the activations derive the rest from symmetry:
+///		ENN_MATH_EXP			- e^-x
+///		ENN_MATH_TANH			- tanh(x)
+///		ENN_MATH_SIGMOID	- 1 / (1 + e^-x)
+///		ENN_MATH_SOFTPLUS	- log(1 + e^-x)
+///
+constexpr double func(ENN_MATH_FUNC F, double x) {
+	return F == ENN_MATH_EXP ? exp(-x) :
+		F == ENN_MATH_TANH ? 1.0 - 2.0 / (exp(2.0 * x) + 1.0) :
+		F == ENN_MATH_SIGMOID ? 1.0 / (1.0 + exp(-x)) :
+		log1p(exp(-x));
+}
+
+/// func(x) for x -> infinity
+constexpr double func_limit(ENN_MATH_FUNC F) { return F == ENN_MATH_TANH || F == ENN_MATH_SIGMOID ? 1.0 : 0.0; }
+
+/// max |func''(x)|, bounds the linear interpolation error
+constexpr double func_d2(ENN_MATH_FUNC F) {
+	return F == ENN_MATH_EXP ? 1.0 : F == ENN_MATH_TANH ? 0.7698004 : F == ENN_MATH_SIGMOID ? 0.0962251 : 0.25;
+}
+
+///
+/// Smallest power of two range, beyond which func(x) is within half of the
+/// fixed point resolution from its limit: e^-R < 2^-(EXPONENT + 1), tanh: 2 * e^-2R < 2^-(EXPONENT + 1)
+///
+constexpr int range_log2(ENN_MATH_FUNC F, int EXPONENT) {
+	return F == ENN_MATH_TANH ? ceil_log2((EXPONENT + 2) * 0.34657359) : ceil_log2((EXPONENT + 1) * 0.69314718);
+}
+
+/// products in the interpolation need twice the bits of the raw value
+template<typename T> struct wide { typedef int64_t type; };
+template<> struct wide<int8_t> { typedef int32_t type; };
+template<> struct wide<int16_t> { typedef int32_t type; };
+
+template<size_t... I> struct index_seq {};
+template<typename A, typename B> struct concat_seq;
+template<size_t... A, size_t... B> struct concat_seq<index_seq<A...>, index_seq<B...> > {
+	typedef index_seq<A..., (sizeof...(A) + B)...> type;
+};
+/// 0..N-1, logarithmic instantiation depth
+template<size_t N> struct make_index_seq {
+	typedef typename concat_seq<typename make_index_seq<N / 2>::type, typename make_index_seq<N - N / 2>::type>::type type;
+};
+template<> struct make_index_seq<0> { typedef index_seq<> type; };
+template<> struct make_index_seq<1> { typedef index_seq<0> type; };
+
+template<typename T, size_t N>
+struct table {
+	T data[N];
+};
+
+/// round(func(i * step) * 2^EXPONENT)
+template<ENN_MATH_FUNC F, typename T, int EXPONENT, int STEP_LOG2>
+constexpr T entry(size_t i) { return (T)(func(F, i * pow2(STEP_LOG2)) * pow2(EXPONENT) + 0.5); }
+
+template<ENN_MATH_FUNC F, typename T, int EXPONENT, int STEP_LOG2, size_t... I>
+constexpr table<T, sizeof...(I)> make_table(index_seq<I...>) {
+	return {{ entry<F, T, EXPONENT, STEP_LOG2>(I)... }};
+}
+
+};
+
+///
+/// Compile time generated table of lut::func(F, x), x >= 0, for fixed point values
+/// with raw type T_RAW and EXPONENT fractional bits.
+/// The table covers [0, 2^RANGE_LOG2] with 2^TABLE_BITS segments and is linearly interpolated,
+/// which is done entirely in integer arithmetic. Beyond the range the last entry is returned.
+///
+template<ENN_MATH_FUNC F, typename T_RAW, int EXPONENT, int BITS = ENN_LUT_BITS_DEFAULT>
+struct FixedPointLUT {
+	typedef typename lut::wide<T_RAW>::type T_WIDE;
+
+	static const int RANGE_LOG2 = lut::range_log2(F, EXPONENT);
+	/// segments can't be finer than the fixed point resolution
+	static const int TABLE_BITS = BITS < EXPONENT + RANGE_LOG2 ? BITS : EXPONENT + RANGE_LOG2;
+	static const int SHIFT = EXPONENT + RANGE_LOG2 - TABLE_BITS;
+	static const size_t SIZE = ((size_t)1 << TABLE_BITS) + 1;
+
+	///
+	/// max |lut::func(F, x) - lookup(x)|: interpolation error h^2 / 8 * max|func''|,
+	/// rounding of the entries and of the interpolation (one unit of 2^-EXPONENT in total)
+	/// and the error of the saturation beyond the range
+	///
+	static constexpr double error_bound =
+		lut::sqr(lut::pow2(RANGE_LOG2 - TABLE_BITS)) / 8.0 * lut::func_d2(F) +
+		lut::pow2(-EXPONENT) +
+		(lut::func_limit(F) > lut::func(F, lut::pow2(RANGE_LOG2)) ?
+			lut::func_limit(F) - lut::func(F, lut::pow2(RANGE_LOG2)) :
+			lut::func(F, lut::pow2(RANGE_LOG2)) - lut::func_limit(F));
+
+	typedef lut::table<T_RAW, SIZE> table_type;
+	static const table_type table;
+
+	/// raw value of lut::func(F, x), x - raw value >= 0
+	static inline T_RAW lookup(T_WIDE x) {
+		const T_WIDE one = (T_WIDE)1 << SHIFT;
+		const T_WIDE i = x >> SHIFT;
+		T_RAW y[2];
+		if (i >= (T_WIDE)(SIZE - 1)) {
+			ENN_LUT_MEMCPY(y, &table.data[SIZE - 1], sizeof(T_RAW));
+			return y[0];
+		}
+		ENN_LUT_MEMCPY(y, &table.data[i], sizeof(y));
+		return (T_RAW)(y[0] + ((((T_WIDE)y[1] - y[0]) * (x & (one - 1)) + (one >> 1)) >> SHIFT));
+	}
+};
+
+template<ENN_MATH_FUNC F, typename T_RAW, int EXPONENT, int BITS>
+constexpr double FixedPointLUT<F, T_RAW, EXPONENT, BITS>::error_bound;
+
+template<ENN_MATH_FUNC F, typename T_RAW, int EXPONENT, int BITS>
+const typename FixedPointLUT<F, T_RAW, EXPONENT, BITS>::table_type FixedPointLUT<F, T_RAW, EXPONENT, BITS>::table ENN_LUT_PROGMEM =
+	lut::make_table<F, T_RAW, EXPONENT, RANGE_LOG2 - TABLE_BITS>(typename lut::make_index_seq<SIZE>::type());
+
+};
+
+#endif
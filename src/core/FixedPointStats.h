@@ -0,0 +1,66 @@
+#if !defined(ENN_FIXED_POINT_STATS_H)
+#define ENN_FIXED_POINT_STATS_H
+
+#include <stdint.h>
+
+///
+/// Define ENN_FIXED_POINT_STATS (for the whole program) to count the results of the fixed point
+/// arithmetic which do not fit their type:
+///		overflows - FixedPointType operators and assignments which wrap around, and the wide sums of
+///			the dot products (see fixed_wide) which would exceed their type,
+///		saturations - results clamped to the range of their type by the kernels (see fixed_narrow)
+///			and by the conversions of mvo_convert.h,
+///		underflows - non zero results rounded to zero, e.g. the product of two small values.
+/// NeuralNetwork::calculate and MixedNeuralNetwork::calculate count the forward() of each layer into
+/// its fixed_stats(), anything else (e.g. training) counts into fixed_stats_global().
+/// The counters add up until they are reset.
+///
+/// The instrumented build checks every operation and uses the pure kernels (the x86 and NEON
+/// fixed point kernels are bit exact with them but do not count), without it the checks compile
+/// to nothing.
+/// NOTE: the counters are not thread safe.
+///
+
+namespace EasyNeuralNetworks {
+
+/// counters of the fixed point arithmetic, see ENN_FIXED_POINT_STATS
+struct fixed_point_stats {
+	uint32_t overflows;
+	uint32_t saturations;
+	uint32_t underflows;
+
+	fixed_point_stats() : overflows(0), saturations(0), underflows(0) {}
+
+	inline void reset() { overflows = saturations = underflows = 0; }
+	inline uint32_t total() const { return overflows + saturations + underflows; }
+};
+
+#if defined(ENN_FIXED_POINT_STATS)
+
+/// counters of the arithmetic outside of NeuralNetwork::calculate
+inline fixed_point_stats& fixed_stats_global() {
+	static fixed_point_stats stats;
+	return stats;
+}
+
+/// counters the arithmetic counts into, see LayerInterface::fixed_stats
+inline fixed_point_stats*& fixed_stats_current() {
+	static fixed_point_stats * current = &fixed_stats_global();
+	return current;
+}
+
+#define ENN_FIXED_OVERFLOW_IF(COND) do { if (COND) ::EasyNeuralNetworks::fixed_stats_current()->overflows++; } while (0)
+#define ENN_FIXED_SATURATION_IF(COND) do { if (COND) ::EasyNeuralNetworks::fixed_stats_current()->saturations++; } while (0)
+#define ENN_FIXED_UNDERFLOW_IF(COND) do { if (COND) ::EasyNeuralNetworks::fixed_stats_current()->underflows++; } while (0)
+
+#else
+
+#define ENN_FIXED_OVERFLOW_IF(COND) do { } while (0)
+#define ENN_FIXED_SATURATION_IF(COND) do { } while (0)
+#define ENN_FIXED_UNDERFLOW_IF(COND) do { } while (0)
+
+#endif
+
+};
+
+#endif
@@ -3,6 +3,9 @@
 
 #include <stdint.h>
 #include <math.h>
+#include <limits>
+#include <type_traits>
+#include "FixedPointStats.h"
 
 namespace EasyNeuralNetworks {
 
@@ -41,7 +44,7 @@ public:
 	explicit inline operator float () const { return convert_to_float<float>(raw); }
 	explicit inline operator double () const { return convert_to_float<double>(raw); }
 
-	#define ENN_ASSIGNMENT_HELPER(TYPE) inline void operator = (TYPE val) { raw = ((T)val) << EXPONENT; }
+	#define ENN_ASSIGNMENT_HELPER(TYPE) inline void operator = (TYPE val) { ENN_FIXED_OVERFLOW_IF(out_of_range(ldexp((double)val, EXPONENT))); raw = ((T)val) << EXPONENT; }
 
 	ENN_ASSIGNMENT_HELPER(int8_t)
 	ENN_ASSIGNMENT_HELPER(int16_t)
@@ -57,8 +60,8 @@ public:
 	inline void operator =(float val) { raw = convert_from_float<float>(val); }
 	inline void operator =(double val) { raw = convert_from_float<double>(val); }
 
-	inline void operator +=(const FixedPointType<T, EXPONENT> &val) { raw += val.raw; }
-	inline void operator -=(const FixedPointType<T, EXPONENT> &val) { raw -= val.raw; }
+	inline void operator +=(const FixedPointType<T, EXPONENT> &val) { raw = add(raw, val.raw); }
+	inline void operator -=(const FixedPointType<T, EXPONENT> &val) { raw = sub(raw, val.raw); }
 	inline void operator *=(const FixedPointType<T, EXPONENT> &val) { raw = mul(val.raw); }
 	inline void operator /=(const FixedPointType<T, EXPONENT> &val) { raw = div(val.raw); }
 
@@ -66,14 +69,23 @@ public:
 	inline bool operator <(const FixedPointType<T, EXPONENT> &val) const { return raw < val.raw; }
 	inline bool operator >=(const FixedPointType<T, EXPONENT> &val) const { return raw >= val.raw; }
 	inline bool operator <=(const FixedPointType<T, EXPONENT> &val) const { return raw <= val.raw; }
+	inline bool operator ==(const FixedPointType<T, EXPONENT> &val) const { return raw == val.raw; }
+	inline bool operator !=(const FixedPointType<T, EXPONENT> &val) const { return raw != val.raw; }
 
-	inline FixedPointType<T, EXPONENT> operator +(const FixedPointType<T, EXPONENT> &val) const { FixedPointType<T, EXPONENT> tmp; tmp.raw = raw + val.raw; return tmp; }
-	inline FixedPointType<T, EXPONENT> operator -(const FixedPointType<T, EXPONENT> &val) const { FixedPointType<T, EXPONENT> tmp; tmp.raw = raw - val.raw; return tmp; }
+	inline FixedPointType<T, EXPONENT> operator +(const FixedPointType<T, EXPONENT> &val) const { FixedPointType<T, EXPONENT> tmp; tmp.raw = add(raw, val.raw); return tmp; }
+	inline FixedPointType<T, EXPONENT> operator -(const FixedPointType<T, EXPONENT> &val) const { FixedPointType<T, EXPONENT> tmp; tmp.raw = sub(raw, val.raw); return tmp; }
+	inline FixedPointType<T, EXPONENT> operator -() const { FixedPointType<T, EXPONENT> tmp; tmp.raw = sub(0, raw); return tmp; }
 	inline FixedPointType<T, EXPONENT> operator *(const FixedPointType<T, EXPONENT> &val) const { FixedPointType<T, EXPONENT> tmp; tmp.raw = mul(val.raw); return tmp; }
 	inline FixedPointType<T, EXPONENT> operator /(const FixedPointType<T, EXPONENT> &val) const { FixedPointType<T, EXPONENT> tmp; tmp.raw = div(val.raw); return tmp; }
 
+	/// raw fixed point representation, used by the architecture specific kernels
+	typedef T raw_type;
+	static const int exponent = EXPONENT;
+	inline T get_raw() const { return raw; }
+	static inline FixedPointType<T, EXPONENT> from_raw(T val) { FixedPointType<T, EXPONENT> tmp; tmp.raw = val; return tmp; }
+
 	inline FixedPointType<T, EXPONENT>& operator ++() {
-		raw += ((T)1) << EXPONENT;
+		raw = add(raw, ((T)1) << EXPONENT);
 		return *this;
 	}
 	inline FixedPointType<T, EXPONENT> operator ++(int) {
@@ -83,7 +95,7 @@ public:
 	}
 
 	inline FixedPointType<T, EXPONENT>& operator --() {
-		raw -= ((T)1) << EXPONENT;
+		raw = sub(raw, ((T)1) << EXPONENT);
 		return *this;
 	}
 	inline FixedPointType<T, EXPONENT> operator --(int) {
@@ -92,6 +104,25 @@ public:
 		return tmp;
 	}
 private:
+	typedef typename std::make_unsigned<T>::type U;
+
+	/// A + B and A - B wrap around as T does, see ENN_FIXED_POINT_STATS
+	static inline T add(T a, T b) {
+		const T r = (T)((U)a + (U)b);
+		ENN_FIXED_OVERFLOW_IF(b > 0 ? r < a : r > a);
+		return r;
+	}
+
+	static inline T sub(T a, T b) {
+		const T r = (T)((U)a - (U)b);
+		ENN_FIXED_OVERFLOW_IF(b > 0 ? r > a : r < a);
+		return r;
+	}
+
+	/// true if the exact raw value V, rounded towards -infinity, doesn't fit T
+	static inline bool out_of_range(double v) {
+		return !(v >= (double)std::numeric_limits<T>::min() && v < (double)std::numeric_limits<T>::max() + 1.0);
+	}
 
 	template<typename To>
 	inline To convert_to_float(T val) const {
@@ -100,11 +131,22 @@ private:
 
 	template<typename From>
 	inline T convert_from_float(From val) const {
-		return val * (((T)1) << EXPONENT);
+		ENN_FIXED_OVERFLOW_IF(out_of_range(ldexp((double)val, EXPONENT)));
+		const T r = val * (((T)1) << EXPONENT);
+		ENN_FIXED_UNDERFLOW_IF(val != 0 && r == 0);
+		return r;
 	}
 
-	#define ENN_DIV_HELPER(ENN_TYPE1, ENN_TMP) inline ENN_TYPE1 div(ENN_TYPE1 val) const { return (T)((((ENN_TMP)raw) << EXPONENT) / (ENN_TMP)val); }
-	#define ENN_MUL_HELPER(ENN_TYPE1, ENN_TMP) inline ENN_TYPE1 mul(ENN_TYPE1 val) const { return (T)(((ENN_TMP)raw * (ENN_TMP)val) >> EXPONENT); }
+	#define ENN_DIV_HELPER(ENN_TYPE1, ENN_TMP) inline ENN_TYPE1 div(ENN_TYPE1 val) const { \
+		const T r = (T)((((ENN_TMP)raw) << EXPONENT) / (ENN_TMP)val); \
+		ENN_FIXED_OVERFLOW_IF(val != 0 && out_of_range(ldexp((double)raw / (double)val, EXPONENT))); \
+		ENN_FIXED_UNDERFLOW_IF(raw != 0 && r == 0); \
+		return r; }
+	#define ENN_MUL_HELPER(ENN_TYPE1, ENN_TMP) inline ENN_TYPE1 mul(ENN_TYPE1 val) const { \
+		const T r = (T)(((ENN_TMP)raw * (ENN_TMP)val) >> EXPONENT); \
+		ENN_FIXED_OVERFLOW_IF(out_of_range(ldexp((double)raw * (double)val, -EXPONENT))); \
+		ENN_FIXED_UNDERFLOW_IF(raw != 0 && val != 0 && r == 0); \
+		return r; }
 
 	ENN_MUL_HELPER(int8_t, int16_t);
 	ENN_MUL_HELPER(int16_t, int32_t);
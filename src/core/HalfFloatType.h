@@ -0,0 +1,141 @@
+#if !defined(ENN_HALF_FLOAT_TYPE_H)
+#define ENN_HALF_FLOAT_TYPE_H
+
+#include <stdint.h>
+#include <string.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// 16 bit floating point formats:
+///		ENN_HALF_FLOAT16  - IEEE 754 binary16, 5 bit exponent, 10 bit mantissa, max 65504
+///		ENN_HALF_BFLOAT16 - the upper half of a float, 8 bit exponent, 7 bit mantissa
+///
+enum ENN_HALF {
+	ENN_HALF_FLOAT16,
+	ENN_HALF_BFLOAT16,
+};
+
+inline float float16_to_float(uint16_t h) {
+	uint32_t x = (uint32_t)(h & 0x7fff) << 13;
+	float f;
+	if ((h & 0x7c00) == 0x7c00) {
+		x |= 0x7f800000;
+	} else if (h & 0x7c00) {
+		x += 0x38000000;
+	} else {
+		f = (float)(h & 0x3ff) * 5.9604644775390625e-8f;
+		memcpy(&x, &f, sizeof(x));
+	}
+	x |= (uint32_t)(h & 0x8000) << 16;
+	memcpy(&f, &x, sizeof(f));
+	return f;
+}
+
+/// rounds to nearest even, overflows to infinity
+inline uint16_t float_to_float16(float f) {
+	uint32_t x;
+	memcpy(&x, &f, sizeof(x));
+	const uint16_t sign = (x >> 16) & 0x8000;
+	x &= 0x7fffffff;
+	if (x > 0x7f800000)
+		return sign | 0x7e00 | ((x >> 13) & 0x3ff);
+	if (x >= 0x477ff000)
+		return sign | 0x7c00;
+	if (x < 0x38800000) {
+		// subnormal, 0.5 + |f| rounds |f| to a multiple of 2^-24
+		float a;
+		memcpy(&a, &x, sizeof(a));
+		a += 0.5f;
+		memcpy(&x, &a, sizeof(x));
+		return sign | (uint16_t)(x - 0x3f000000);
+	}
+	x += 0xc8000fff + ((x >> 13) & 1);
+	return sign | (uint16_t)(x >> 13);
+}
+
+inline float bfloat16_to_float(uint16_t h) {
+	const uint32_t x = (uint32_t)h << 16;
+	float f;
+	memcpy(&f, &x, sizeof(f));
+	return f;
+}
+
+/// rounds to nearest even
+inline uint16_t float_to_bfloat16(float f) {
+	uint32_t x;
+	memcpy(&x, &f, sizeof(x));
+	if ((x & 0x7fffffff) > 0x7f800000)
+		return (uint16_t)((x >> 16) | 0x40);
+	return (uint16_t)((x + 0x7fff + ((x >> 16) & 1)) >> 16);
+}
+
+template<ENN_HALF FORMAT>
+inline float half_to_float(uint16_t h) {
+	return FORMAT == ENN_HALF_BFLOAT16 ? bfloat16_to_float(h) : float16_to_float(h);
+}
+
+template<ENN_HALF FORMAT>
+inline uint16_t float_to_half(float f) {
+	return FORMAT == ENN_HALF_BFLOAT16 ? float_to_bfloat16(f) : float_to_float16(f);
+}
+
+///
+/// 16 bit floating point storage type, e.g. tensor<float16> or weights of HalfWeightsDenseLayer.
+/// Arithmetic is done in float and rounded back to 16 bits. The kernels of dot_product, mat_mul
+/// and the convolutions accumulate in float and round once per output, see arch/pure/mvo_half.h.
+///
+template<ENN_HALF FORMAT>
+class HalfFloatType {
+	uint16_t raw;
+public:
+	HalfFloatType() { raw = 0; }
+	HalfFloatType(const HalfFloatType<FORMAT> &val) { raw = val.raw; }
+	HalfFloatType(float val) { raw = float_to_half<FORMAT>(val); }
+	HalfFloatType(double val) { raw = float_to_half<FORMAT>((float)val); }
+
+	#define ENN_CONSTRUCTOR_HELPER(TYPE) HalfFloatType(TYPE val) { raw = float_to_half<FORMAT>((float)val); }
+
+	ENN_CONSTRUCTOR_HELPER(int8_t)
+	ENN_CONSTRUCTOR_HELPER(int16_t)
+	ENN_CONSTRUCTOR_HELPER(int32_t)
+	ENN_CONSTRUCTOR_HELPER(int64_t)
+	ENN_CONSTRUCTOR_HELPER(uint8_t)
+	ENN_CONSTRUCTOR_HELPER(uint16_t)
+	ENN_CONSTRUCTOR_HELPER(uint32_t)
+	ENN_CONSTRUCTOR_HELPER(uint64_t)
+
+	#undef ENN_CONSTRUCTOR_HELPER
+
+	explicit inline operator float () const { return half_to_float<FORMAT>(raw); }
+	explicit inline operator double () const { return half_to_float<FORMAT>(raw); }
+
+	inline void operator +=(const HalfFloatType<FORMAT> &val) { *this = (float)*this + (float)val; }
+	inline void operator -=(const HalfFloatType<FORMAT> &val) { *this = (float)*this - (float)val; }
+	inline void operator *=(const HalfFloatType<FORMAT> &val) { *this = (float)*this * (float)val; }
+	inline void operator /=(const HalfFloatType<FORMAT> &val) { *this = (float)*this / (float)val; }
+
+	inline bool operator >(const HalfFloatType<FORMAT> &val) const { return (float)*this > (float)val; }
+	inline bool operator <(const HalfFloatType<FORMAT> &val) const { return (float)*this < (float)val; }
+	inline bool operator >=(const HalfFloatType<FORMAT> &val) const { return (float)*this >= (float)val; }
+	inline bool operator <=(const HalfFloatType<FORMAT> &val) const { return (float)*this <= (float)val; }
+
+	inline HalfFloatType<FORMAT> operator +(const HalfFloatType<FORMAT> &val) const { return (float)*this + (float)val; }
+	inline HalfFloatType<FORMAT> operator -(const HalfFloatType<FORMAT> &val) const { return (float)*this - (float)val; }
+	inline HalfFloatType<FORMAT> operator *(const HalfFloatType<FORMAT> &val) const { return (float)*this * (float)val; }
+	inline HalfFloatType<FORMAT> operator /(const HalfFloatType<FORMAT> &val) const { return (float)*this / (float)val; }
+	inline HalfFloatType<FORMAT> operator -() const { return from_raw(raw ^ 0x8000); }
+
+	/// raw 16 bit representation, used by the architecture specific kernels
+	typedef uint16_t raw_type;
+	static const ENN_HALF format = FORMAT;
+	inline uint16_t get_raw() const { return raw; }
+	static inline HalfFloatType<FORMAT> from_raw(uint16_t val) { HalfFloatType<FORMAT> tmp; tmp.raw = val; return tmp; }
+};
+
+typedef HalfFloatType<ENN_HALF_FLOAT16> float16;
+typedef HalfFloatType<ENN_HALF_BFLOAT16> bfloat16;
+
+};
+
+#endif
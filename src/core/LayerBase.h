@@ -10,6 +10,8 @@
 #endif
 
 #include <core/tensor.h>
+#include <core/matvecop.h>
+#include <core/FixedPointStats.h>
 
 namespace EasyNeuralNetworks {
 
@@ -25,6 +27,15 @@ public:
 	/// output - neuron delta response
 	virtual T backward(T delta) const = 0;
 
+	/// describes f(x) for the fused layer kernels, see mat_mul_fused.
+	/// returns false if f can't be fused, the layer then calls apply_forward_inplace/apply_backward_inplace.
+	/// NOTE: derived activations that change forward() must override it as well
+	virtual bool fused(fused_activation<T>& f) const { return false; }
+
+	/// false if f(x) of an output depends on the other outputs, e.g. softmax.
+	/// the quantized layers can apply element-wise activations only, see QuantizedLayerBase
+	virtual bool elementwise() const { return true; }
+
 	/// calculates f(x) for each output neuron
 	virtual void apply_forward_inplace(tensor<T, T_SIZE>& a) const {
 		auto I = a.data();
@@ -50,15 +61,109 @@ public:
 	}
 };
 
+///
+/// Implements the bulk functions with direct calls of DERIVED::forward() and DERIVED::backward()
+/// instead of a virtual call per element, so that the loops can be inlined and vectorized.
+///
+template <typename DERIVED, typename T, typename T_SIZE>
+class ActivationImpl : public ActivationBase<T, T_SIZE> {
+public:
+	virtual void apply_forward_inplace(tensor<T, T_SIZE>& a) const {
+		const DERIVED& self = static_cast<const DERIVED&>(*this);
+		T * I = a.data();
+		const T_SIZE num = a.size();
+		for (T_SIZE i = 0; i < num; i++)
+			I[i] = self.DERIVED::forward(I[i]);
+	}
+
+	virtual void apply_backward_inplace(tensor<T, T_SIZE>& deltas, const tensor<T, T_SIZE>& outputs) const {
+		assert(deltas.size() == outputs.size());
+		const DERIVED& self = static_cast<const DERIVED&>(*this);
+		T * D = deltas.data();
+		const T * O = outputs.data();
+		const T_SIZE num = outputs.size();
+		for (T_SIZE i = 0; i < num; i++)
+			D[i] = D[i] * self.DERIVED::backward(O[i]);
+	}
+};
+
+///
+/// Binds the activation of a layer at compile time, see the T_ACTIVATION_POLICY of the layers.
+/// With a concrete activation class, e.g. DenseLayer<float, true, uint16_t, ReLUActivation<float>>,
+/// its functions are called directly and can be inlined. ActivationBase keeps the virtual dispatch.
+///
+template <typename T_ACTIVATION>
+struct ActivationPolicy {
+	template <typename T, typename T_SIZE>
+	static inline void apply_forward_inplace(const ActivationBase<T, T_SIZE>& activation, tensor<T, T_SIZE>& a) {
+		static_cast<const T_ACTIVATION&>(activation).T_ACTIVATION::apply_forward_inplace(a);
+	}
+
+	template <typename T, typename T_SIZE>
+	static inline void apply_backward_inplace(const ActivationBase<T, T_SIZE>& activation, tensor<T, T_SIZE>& deltas, const tensor<T, T_SIZE>& outputs) {
+		static_cast<const T_ACTIVATION&>(activation).T_ACTIVATION::apply_backward_inplace(deltas, outputs);
+	}
+
+	template <typename T, typename T_SIZE>
+	static inline bool fused(const ActivationBase<T, T_SIZE>& activation, fused_activation<T>& f) {
+		return static_cast<const T_ACTIVATION&>(activation).T_ACTIVATION::fused(f);
+	}
+};
+
+template <typename T, typename T_SIZE>
+struct ActivationPolicy<ActivationBase<T, T_SIZE> > {
+	static inline void apply_forward_inplace(const ActivationBase<T, T_SIZE>& activation, tensor<T, T_SIZE>& a) {
+		activation.apply_forward_inplace(a);
+	}
+
+	static inline void apply_backward_inplace(const ActivationBase<T, T_SIZE>& activation, tensor<T, T_SIZE>& deltas, const tensor<T, T_SIZE>& outputs) {
+		activation.apply_backward_inplace(deltas, outputs);
+	}
+
+	static inline bool fused(const ActivationBase<T, T_SIZE>& activation, fused_activation<T>& f) {
+		return activation.fused(f);
+	}
+};
+
 #define ENN_T_INPUT_TYPEDEF(T_INPUT_NAME) typedef tensor<T, T_SIZE> T_INPUT_NAME;
 #define ENN_T_ACTIVATION_TYPEDEF(T_ACTIVATION_NAME) typedef ActivationBase<T, T_SIZE> T_ACTIVATION_NAME;
 #define ENN_T_LAYER_TYPEDEF(T_LAYER_NAME) typedef LayerBase<T, T_SIZE> T_LAYER_NAME;
+
+///
+/// The part of a layer which does not depend on its type, see MixedNeuralNetwork
+///
+class LayerInterface {
+public:
+	virtual void forward() = 0;
+
+#if defined(ENN_FIXED_POINT_STATS)
+	/// counters of the fixed point arithmetic of forward(), see FixedPointStats.h
+	inline fixed_point_stats& fixed_stats() { return _fixed_stats; }
+	inline const fixed_point_stats& fixed_stats() const { return _fixed_stats; }
+
+protected:
+	fixed_point_stats _fixed_stats;
+#endif
+};
+
+/// L->forward(), counting into L->fixed_stats() with ENN_FIXED_POINT_STATS
+inline void layer_forward(LayerInterface * L) {
+#if defined(ENN_FIXED_POINT_STATS)
+	fixed_point_stats * current = fixed_stats_current();
+	fixed_stats_current() = &L->fixed_stats();
+	L->forward();
+	fixed_stats_current() = current;
+#else
+	L->forward();
+#endif
+}
+
 ///
 /// A abstract base layer class
 /// stores pointers to layer inputs and outputs along with their sizes
 ///
 template <typename T, typename T_SIZE>
-class LayerBase {
+class LayerBase : public LayerInterface {
 protected:
 	ENN_T_LAYER_TYPEDEF(T_LAYER);
 	ENN_T_INPUT_TYPEDEF(T_INPUT);
@@ -137,6 +242,16 @@ public:
 	/// will update the weights based on gradients
 	///
 	virtual void update(const T_INPUT& gradients, T alpha) = 0;
+
+	///
+	/// allows update() to collect the updates of up to batch samples and apply them at once.
+	/// the gradients of the samples in a batch are then calculated with the same weights,
+	/// i.e. mini-batch instead of per sample updates. Layers that do not support it update immediately.
+	virtual void training_batch(T_SIZE batch) {}
+
+	///
+	/// applies the updates collected so far, if any
+	virtual void update_end() {}
 };
 
 };
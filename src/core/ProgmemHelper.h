@@ -2,7 +2,25 @@
 #define ENN_PROGMEM_HELPER_H
 
 #include <stdlib.h>
+#include <string.h>
+#include <functional>
+
+///
+/// Weights may be placed into flash with PROGMEM and read with memcpy_P. Native builds,
+/// e.g. the tests, have no pgmspace.h: flash is ordinary memory there.
+///
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#elif defined(ARDUINO)
 #include <pgmspace.h>
+#else
+#if !defined(PROGMEM)
+#define PROGMEM
+#endif
+#if !defined(memcpy_P)
+#define memcpy_P memcpy
+#endif
+#endif
 
 namespace EasyNeuralNetworks {
 
@@ -19,8 +37,9 @@ public:
 		_reader = reader;
 	}
 
-	virtual void read(T * dst, size_t items) const {
-		_reader(dst, _flash, sizeof(T) * items);
+	/// reads items starting at item offset, e.g. one row of a matrix at a time
+	virtual void read(T * dst, size_t items, size_t offset = 0) const {
+		_reader(dst, (const char *)_flash + sizeof(T) * offset, sizeof(T) * items);
 	}
 
 	T * read(size_t items) const {
@@ -45,10 +64,10 @@ public:
 		CastProgmemHelper(const void * flash, Reader_t reader = memcpy_P)
 			: ProgmemHelper<T>(flash, reader) {}
 
-	virtual void read(T * dst, size_t items) const {
+	virtual void read(T * dst, size_t items, size_t offset = 0) const {
 		T_SOURCE * tmp = (T_SOURCE*)malloc(sizeof(T_SOURCE) * items);
 		T_SOURCE *p = tmp;
-		this->_reader(dst, this->_flash, sizeof(T_SOURCE) * items);
+		this->_reader(tmp, (const char *)this->_flash + sizeof(T_SOURCE) * offset, sizeof(T_SOURCE) * items);
 		for (size_t i = 0; i < items; i++) {
 			*dst = *p;
 			++p;
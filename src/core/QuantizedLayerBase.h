@@ -0,0 +1,170 @@
+#if !defined(ENN_QUANTIZED_LAYER_BASE_H)
+#define ENN_QUANTIZED_LAYER_BASE_H
+
+#include <core/LayerBase.h>
+#include <core/matvecop.h>
+#include <activations/LUActivation.h>
+
+///
+/// Activations other than identity and (leaky) ReLU are applied through a table of 256 values,
+/// the pre-activation values are quantized to their calibrated range for it, see
+/// Calibrator::pre_activation_params. Layers imported without one use
+/// [-ENN_QUANT_TABLE_RANGE, ENN_QUANT_TABLE_RANGE]. Sigmoid and tanh are saturated beyond the range.
+///
+#if !defined(ENN_QUANT_TABLE_RANGE)
+#define ENN_QUANT_TABLE_RANGE 8.0f
+#endif
+
+namespace EasyNeuralNetworks {
+
+/// pre-activation parameters of the tables of layers imported without calibrated ones
+inline quant_params quant_table_params() {
+	return quant_params_from_range(-ENN_QUANT_TABLE_RANGE, ENN_QUANT_TABLE_RANGE);
+}
+
+///
+/// A base class of the int8 quantized layers, inference only.
+///
+/// The layers are imported from the float weights (same layout as the float layers) with
+/// the quantization parameters of their inputs and outputs (see quant_params), which come
+/// from the ranges of the float activations, e.g. quant_params_from_range:
+///		weights are quantized per output channel: Wq = round(W / Sw), Sw = max|W| / 127
+///		biases are int32: Bq = round(B / (Sx * Sw)) - Zx * SUM Wq
+///		the int32 sums are scaled by Sx * Sw / Sy and the activation is fused into it, see quant_output
+/// which takes 1/4 of the float weight memory.
+/// Activations that are tables take the parameters of the pre-activation values as well (pre_params),
+/// the sums are then scaled by Sx * Sw / Spre. Only element-wise activations can be fused, e.g. not softmax.
+///
+/// Quantized layers form a NeuralNetwork<int8_t>: the inputs are quantized with quantize_arr
+/// and the outputs dequantized with dequantize_arr. Max and average pooling, flatten, reshape
+/// and concat layers work on int8_t as they are, since they keep the quantization parameters.
+/// NOTE: ZeroPaddingLayer pads with 0, which is a real 0 only if the zero point is 0.
+///
+template <typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+class QuantizedLayerBase : public LayerBase<int8_t, T_SIZE> {
+protected:
+	typedef int8_t T;
+	ENN_T_INPUT_TYPEDEF(T_INPUT);
+	ENN_T_LAYER_TYPEDEF(T_LAYER);
+	typedef tensor<float, T_SIZE> T_FLOAT_INPUT;
+	typedef ActivationBase<float, T_SIZE> T_FLOAT_ACTIVATION;
+	typedef tensor<quant_channel, T_SIZE> T_CHANNELS;
+
+	quant_params _input_params;
+	quant_params _output_params;
+	T_CHANNELS _channels;
+	T_INPUT _table;
+	quant_output _output;
+public:
+	QuantizedLayerBase(T_INPUT& input, const quant_params& input_params, const quant_params& output_params)
+		: T_LAYER(input, identity()), _input_params(input_params), _output_params(output_params) {
+		_output.zero_point = output_params.zero_point;
+		_output.min = -128;
+		_output.max = 127;
+		_output.table = NULL;
+		_output.negative.multiplier = 0;
+		_output.negative.shift = 0;
+	}
+
+	inline const quant_params& input_params() const { return _input_params; }
+	inline const quant_params& output_params() const { return _output_params; }
+
+	/// per output channel biases and scales
+	inline const T_CHANNELS& channels() const { return _channels; }
+	/// requantization and activation
+	inline const quant_output& output() const { return _output; }
+
+	using T_LAYER::weights;
+
+	///
+	/// binds already quantized weights, e.g. stored in flash, instead of importing the float weights.
+	/// weights are one row per output channel, see weights() of an imported layer.
+	///
+	virtual void weights(T_INPUT& weights, T_CHANNELS& channels, const quant_output& output) {
+		assert(weights.size() == this->weights().size());
+		assert(channels.size() == _channels.size());
+		T_LAYER::weights(weights);
+		_channels = channels;
+		_output = output;
+	}
+
+	/// quantized layers are inference only
+	virtual void training_begin() {}
+	virtual void training_end() {}
+	virtual void backward(T_INPUT& deltas) {}
+	virtual void update(const T_INPUT& gradients, T alpha) {}
+
+protected:
+	static const ActivationBase<T, T_SIZE>& identity() {
+		static const LUActivation<T, T_SIZE> lu;
+		return lu;
+	}
+
+	///
+	/// quantizes K rows of n float weights, each followed by its bias if bias is true.
+	/// Weights become (n, K, 1)
+	///
+	void quantize_weights(const float * weights, size_t n, bool bias, size_t K, const T_FLOAT_ACTIVATION& activation, const quant_params& pre_params) {
+		const quant_params pre = output_stage(activation, pre_params);
+		const size_t row = bias ? n + 1 : n;
+
+		this->weights().resize(n, K, 1);
+		_channels.resize(K, 1, 1);
+		for (size_t k = 0; k < K; k++, weights += row) {
+			float absmax = 0;
+			for (size_t i = 0; i < n; i++)
+				absmax = fabsf(weights[i]) > absmax ? fabsf(weights[i]) : absmax;
+
+			quant_params w;
+			w.scale = absmax > 0 ? absmax / 127.0f : 1.0f;
+			w.zero_point = 0;
+			T * W = this->weights().data(k, 0);
+			int32_t sum = 0;
+			for (size_t i = 0; i < n; i++) {
+				W[i] = quantize(weights[i], w);
+				sum += W[i];
+			}
+
+			const double scale = (double)_input_params.scale * w.scale;
+			double b = bias ? weights[n] / scale : 0;
+			b = b < -1e9 ? -1e9 : b > 1e9 ? 1e9 : b;
+			_channels[k].bias = (int32_t)(b < 0 ? b - 0.5 : b + 0.5) - _input_params.zero_point * sum;
+			_channels[k].scale = quant_multiplier_from(scale / pre.scale);
+		}
+	}
+
+	///
+	/// sets up the output stage for the activation and returns the quantization
+	/// the sums are requantized to: identity and ReLU are clamps of the outputs,
+	/// leaky ReLU scales the values below the zero point by its slope before the clamp,
+	/// anything else is a table from the pre-activation values (quantized with pre) to the outputs
+	///
+	quant_params output_stage(const T_FLOAT_ACTIVATION& activation, const quant_params& pre) {
+		fused_activation<float> f;
+		assert(activation.elementwise());
+		_output.min = -128;
+		_output.max = 127;
+		_output.table = NULL;
+		_output.negative.multiplier = 0;
+		_output.negative.shift = 0;
+		if (activation.fused(f) && (f.op == ENN_FUSED_NONE || (f.op == ENN_FUSED_RELU && f.param >= 0))) {
+			_output.zero_point = _output_params.zero_point;
+			if (f.op == ENN_FUSED_RELU && f.param == 0)
+				_output.min = _output_params.zero_point;
+			else if (f.op == ENN_FUSED_RELU)
+				_output.negative = quant_multiplier_from(f.param);
+			return _output_params;
+		}
+
+		_table.resize(256, 1, 1);
+		for (int32_t q = -128; q < 128; q++)
+			_table[q + 128] = quantize(activation.forward(dequantize((T)q, pre)), _output_params);
+		_output.zero_point = pre.zero_point;
+		_output.table = _table.data();
+		return pre;
+	}
+};
+
+};
+
+#endif
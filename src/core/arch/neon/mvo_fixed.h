@@ -0,0 +1,133 @@
+#if !defined(ENN_NEON_MVO_FIXED_H)
+#define ENN_NEON_MVO_FIXED_H
+
+#include <stdint.h>
+#include <string.h>
+#include <arm_neon.h>
+#include "../../FixedPointType.h"
+
+///
+/// NEON kernels for FixedPointType<int16_t, EXPONENT>.
+/// Eight values are processed at once. Element-wise products are widened to 32 bit, shifted and
+/// narrowed back exactly like FixedPointType::operator *, and the sums wrap around
+/// the same way as int16_t does. Dot products accumulate the products in 32 bit (vmlal_s16),
+/// the raw kernels of arch/pure/mvo_fixed.h shift them once. The results are bit exact with the pure kernels.
+/// Operations other than sum, difference and product fall back to the pure kernels.
+///
+namespace EasyNeuralNetworks {
+namespace neon {
+
+template<int EXPONENT>
+struct fixed16_ops {
+	typedef FixedPointType<int16_t, EXPONENT> T;
+	typedef int16x8_t vi;
+	static const size_t width = 8;
+
+	static inline const int16_t * raw(const T * p) { return reinterpret_cast<const int16_t *>(p); }
+	static inline int16_t * raw(T * p) { return reinterpret_cast<int16_t *>(p); }
+
+	static inline vi mul(vi a, vi b) {
+		const int32x4_t shift = vdupq_n_s32(-EXPONENT);
+		int32x4_t lo = vmull_s16(vget_low_s16(a), vget_low_s16(b));
+		int32x4_t hi = vmull_s16(vget_high_s16(a), vget_high_s16(b));
+		return vcombine_s16(vmovn_s32(vshlq_s32(lo, shift)), vmovn_s32(vshlq_s32(hi, shift)));
+	}
+
+	static inline int16_t mul(int16_t a, int16_t b) {
+		return (int16_t)(((int32_t)a * (int32_t)b) >> EXPONENT);
+	}
+
+	template<ENN_ARR_OP OP>
+	static inline vi op(vi a, vi b) {
+		switch (OP) {
+			case ENN_ARR_SUM: return vaddq_s16(a, b);
+			case ENN_ARR_DIFF: return vsubq_s16(a, b);
+			default: return mul(a, b);
+		}
+	}
+
+	template<ENN_ARR_OP OP>
+	static inline int16_t op(int16_t a, int16_t b) {
+		switch (OP) {
+			case ENN_ARR_SUM: return a + b;
+			case ENN_ARR_DIFF: return a - b;
+			default: return mul(a, b);
+		}
+	}
+
+	/// DSTi (+)= Ai op Bi, or DSTi (+)= Ai op b if B is NULL
+	template<ENN_ARR_OP OP>
+	static inline void arr(bool add, int16_t * dst, const int16_t * a, const int16_t * B, int16_t b, size_t num) {
+		const vi bb = vdupq_n_s16(b);
+		size_t i = 0;
+		for (; i + width <= num; i += width) {
+			vi x = op<OP>(vld1q_s16(a + i), B ? vld1q_s16(B + i) : bb);
+			vst1q_s16(dst + i, add ? vaddq_s16(vld1q_s16(dst + i), x) : x);
+		}
+		for (; i < num; i++) {
+			int16_t x = op<OP>(a[i], B ? B[i] : b);
+			dst[i] = add ? (int16_t)(dst[i] + x) : x;
+		}
+	}
+
+	static inline bool arr(ENN_ARR_OP op, bool add, int16_t * dst, const int16_t * a, const int16_t * B, int16_t b, size_t num) {
+		switch (op) {
+			case ENN_ARR_SUM: arr<ENN_ARR_SUM>(add, dst, a, B, b, num); return true;
+			case ENN_ARR_DIFF: arr<ENN_ARR_DIFF>(add, dst, a, B, b, num); return true;
+			case ENN_ARR_MUL: arr<ENN_ARR_MUL>(add, dst, a, B, b, num); return true;
+			default: return false;
+		}
+	}
+};
+
+/// SUMi Ai * Bi in 32 bit, see kernel_fixed_dot
+inline int32_t fixed16_dot(const int16_t * a, const int16_t * b, size_t num) {
+	int32x4_t acc0 = vdupq_n_s32(0), acc1 = vdupq_n_s32(0);
+	size_t i = 0;
+	for (; i + 8 <= num; i += 8) {
+		const int16x8_t x = vld1q_s16(a + i), y = vld1q_s16(b + i);
+		acc0 = vmlal_s16(acc0, vget_low_s16(x), vget_low_s16(y));
+		acc1 = vmlal_s16(acc1, vget_high_s16(x), vget_high_s16(y));
+	}
+	int32_t acc = neon_qops::hsum(vaddq_s32(acc0, acc1));
+	for (; i < num; i++)
+		acc += (int32_t)a[i] * (int32_t)b[i];
+	return acc;
+}
+
+};
+
+template<int EXPONENT>
+inline void kernel_arr_binary(ENN_ARR_OP op, bool add, FixedPointType<int16_t, EXPONENT> * dst, const FixedPointType<int16_t, EXPONENT> * a, const FixedPointType<int16_t, EXPONENT> * b, size_t num) {
+	typedef neon::fixed16_ops<EXPONENT> ops;
+	if (!ops::arr(op, add, ops::raw(dst), ops::raw(a), ops::raw(b), 0, num))
+		kernel_arr_binary<FixedPointType<int16_t, EXPONENT> >(op, add, dst, a, b, num);
+}
+
+template<int EXPONENT>
+inline void kernel_arr_const(ENN_ARR_OP op, bool add, FixedPointType<int16_t, EXPONENT> * dst, const FixedPointType<int16_t, EXPONENT> * a, FixedPointType<int16_t, EXPONENT> c, size_t num) {
+	typedef neon::fixed16_ops<EXPONENT> ops;
+	if (!ops::arr(op, add, ops::raw(dst), ops::raw(a), NULL, c.get_raw(), num))
+		kernel_arr_const<FixedPointType<int16_t, EXPONENT> >(op, add, dst, a, c, num);
+}
+
+template<>
+inline int32_t kernel_fixed_dot<int16_t>(const int16_t * a, const int16_t * b, size_t num) {
+	return neon::fixed16_dot(a, b, num);
+}
+
+template<int EXPONENT>
+inline void kernel_mat_mul_transposed(FixedPointType<int16_t, EXPONENT> * dst, const FixedPointType<int16_t, EXPONENT> * vec, const FixedPointType<int16_t, EXPONENT> * mat, size_t N, size_t M, bool bias, bool add) {
+	typedef neon::fixed16_ops<EXPONENT> ops;
+	const size_t row = bias ? N + 1 : N;
+	int16_t * d = ops::raw(dst);
+	const int16_t * m = ops::raw(mat);
+	if (!add)
+		memset(d, 0, N * sizeof(int16_t));
+	for (size_t j = 0; j < M; j++, m += row)
+		ops::template arr<ENN_ARR_MUL>(true, d, m, NULL, vec[j].get_raw(), N);
+}
+
+};
+
+#endif
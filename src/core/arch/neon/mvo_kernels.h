@@ -0,0 +1,172 @@
+#if !defined(ENN_NEON_MVO_KERNELS_H)
+#define ENN_NEON_MVO_KERNELS_H
+
+#include "mvo_ops.h"
+
+///
+/// Binds the NEON kernels to the unit stride kernels of arch/pure for float (and int8_t for the quantized layers).
+///
+namespace EasyNeuralNetworks {
+namespace neon {
+
+namespace native {
+#include "../simd/mvo_array.h"
+#include "../simd/mvo_vector.h"
+#include "../simd/mvo_matrix.h"
+#include "../simd/mvo_conv.h"
+#include "../simd/mvo_math.h"
+#include "../simd/mvo_quant.h"
+#include "../simd/mvo_half.h"
+};
+
+inline const char * arch_name() { return neon_ops::name(); }
+
+#define ENN_NEON_KERNEL(NAME) neon::native::NAME<neon::neon_ops>
+
+};
+
+template<>
+inline void kernel_arr_binary<float>(ENN_ARR_OP op, bool add, float * dst, const float * a, const float * b, size_t num) {
+	ENN_NEON_KERNEL(arr_binary)(op, add, dst, a, b, num);
+}
+
+template<>
+inline void kernel_arr_const<float>(ENN_ARR_OP op, bool add, float * dst, const float * a, float c, size_t num) {
+	ENN_NEON_KERNEL(arr_const)(op, add, dst, a, c, num);
+}
+
+template<>
+inline float kernel_sum_arr<float>(const float * a, size_t num) {
+	return ENN_NEON_KERNEL(sum_arr)(a, num);
+}
+
+template<>
+inline float kernel_sqrsum_arr<float>(const float * a, size_t num) {
+	return ENN_NEON_KERNEL(sqrsum_arr)(a, num);
+}
+
+template<>
+inline void kernel_shifted_sums_arr<float>(float * Ex, float * Ex2, const float * a, float K, size_t num) {
+	ENN_NEON_KERNEL(shifted_sums_arr)(Ex, Ex2, a, K, num);
+}
+
+template<>
+inline float kernel_minmax_arr<float>(bool is_min, size_t * index, const float * a, size_t num) {
+	return ENN_NEON_KERNEL(minmax_arr)(is_min, index, a, num);
+}
+
+template<>
+inline float kernel_dot_product<float>(const float * a, const float * b, size_t num) {
+	return ENN_NEON_KERNEL(dot_product)(a, b, num);
+}
+
+template<>
+inline void kernel_mat_mul<float>(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, bool add) {
+	ENN_NEON_KERNEL(mat_mul)(dst, vec, mat, N, M, bias, add);
+}
+
+template<>
+inline void kernel_mat_mul_relu<float>(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, float negative_d) {
+	ENN_NEON_KERNEL(mat_mul_relu)(dst, vec, mat, N, M, bias, negative_d);
+}
+
+template<>
+inline void kernel_mat_mul_transposed<float>(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, bool add) {
+	ENN_NEON_KERNEL(mat_mul_transposed)(dst, vec, mat, N, M, bias, add);
+}
+
+template<>
+inline void kernel_mat_mul_batch<float>(float * dst, const float * vec, const float * mat, size_t N, size_t M, size_t B, bool bias, bool add) {
+	ENN_NEON_KERNEL(mat_mul_batch)(dst, vec, mat, N, M, B, bias, add);
+}
+
+template<>
+inline void kernel_mat_mul_transposed_batch<float>(float * dst, const float * vec, const float * mat, size_t N, size_t M, size_t B, bool bias, bool add) {
+	ENN_NEON_KERNEL(mat_mul_transposed_batch)(dst, vec, mat, N, M, B, bias, add);
+}
+
+template<>
+inline void kernel_outer_product_batch<float>(float * dst, const float * u, const float * v, size_t N, size_t M, size_t B, bool bias) {
+	ENN_NEON_KERNEL(outer_product_batch)(dst, u, v, N, M, B, bias);
+}
+
+template<>
+inline void kernel_mat_transpose<float>(float * dst, const float * src, size_t width, size_t height) {
+	ENN_NEON_KERNEL(mat_transpose)(dst, src, width, height);
+}
+
+template<>
+inline void kernel_convolve_1d<float>(float * dst, const float * vec, const float * kernel, size_t N, size_t M, size_t stride) {
+	ENN_NEON_KERNEL(convolve_1d)(dst, vec, kernel, N, M, stride);
+}
+
+template<>
+inline void kernel_convolve_2d<float>(float * dst, const float * mat, const float * kernel, size_t N, size_t M, size_t K, size_t L, size_t stride) {
+	ENN_NEON_KERNEL(convolve_2d)(dst, mat, kernel, N, M, K, L, stride);
+}
+
+template<>
+inline void kernel_convolve_2d_multi<float>(float * dst, const float * mat, const float * kernel, size_t row, size_t N, size_t M, size_t C, size_t K, size_t L, size_t F, size_t stride) {
+	ENN_NEON_KERNEL(convolve_2d_multi)(dst, mat, kernel, row, N, M, C, K, L, F, stride);
+}
+
+template<>
+inline void kernel_fft_butterfly<float>(float * ar, float * ai, float * br, float * bi, float wr, float wi, size_t num) {
+	ENN_NEON_KERNEL(fft_butterfly)(ar, ai, br, bi, wr, wi, num);
+}
+
+template<>
+inline void kernel_complex_madd<float>(float * dr, float * di, const float * ar, const float * ai, float cr, float ci, size_t num) {
+	ENN_NEON_KERNEL(complex_madd)(dr, di, ar, ai, cr, ci, num);
+}
+
+template<>
+inline void kernel_math_arr<float>(ENN_MATH_FUNC func, ENN_MATH_ACCURACY accuracy, float * dst, const float * a, size_t num) {
+	ENN_NEON_KERNEL(math_arr)(func, accuracy, dst, a, num);
+}
+
+template<>
+inline void kernel_math_grad_arr<float>(ENN_MATH_FUNC func, ENN_MATH_ACCURACY accuracy, float * dst, const float * a, size_t num) {
+	ENN_NEON_KERNEL(math_grad_arr)(func, accuracy, dst, a, num);
+}
+
+template<>
+inline void kernel_relu_arr<float>(float * dst, const float * a, float negative_d, size_t num) {
+	ENN_NEON_KERNEL(relu_arr)(dst, a, negative_d, num);
+}
+
+template<>
+inline void kernel_qmat_mul<int8_t>(int32_t * dst, const int8_t * vec, const int8_t * mat, size_t N, size_t M) {
+	neon::native::qmat_mul<neon::neon_qops>(dst, vec, mat, N, M);
+}
+
+template<>
+inline void kernel_wmat_mul_i8<float>(float * dst, const float * vec, const int8_t * mat, size_t N, size_t M) {
+	ENN_NEON_KERNEL(wmat_mul_i8)(dst, vec, mat, N, M);
+}
+
+template<>
+inline void kernel_wmat_mul_i4<float>(float * dst, const float * vec, const uint8_t * mat, size_t N, size_t M) {
+	ENN_NEON_KERNEL(wmat_mul_i4)(dst, vec, mat, N, M);
+}
+
+template<>
+inline void kernel_hmat_mul<float, float16>(float * dst, const float * vec, const float16 * mat, size_t N, size_t M, bool bias, bool add) {
+	ENN_NEON_KERNEL(hmat_mul_f16)(dst, vec, reinterpret_cast<const uint16_t *>(mat), N, M, bias, add);
+}
+
+template<>
+inline void kernel_hmat_mul<float, bfloat16>(float * dst, const float * vec, const bfloat16 * mat, size_t N, size_t M, bool bias, bool add) {
+	ENN_NEON_KERNEL(hmat_mul_bf16)(dst, vec, reinterpret_cast<const uint16_t *>(mat), N, M, bias, add);
+}
+
+#undef ENN_NEON_KERNEL
+
+};
+
+/// the instrumented build counts in the pure kernels, see FixedPointStats.h
+#if !defined(ENN_FIXED_POINT_STATS)
+#include "mvo_fixed.h"
+#endif
+
+#endif
@@ -0,0 +1,157 @@
+#if !defined(ENN_NEON_MVO_OPS_H)
+#define ENN_NEON_MVO_OPS_H
+
+#include <stdlib.h>
+#include <math.h>
+#include <limits>
+#include <assert.h>
+#include <arm_neon.h>
+#include "../simd/mvo_ops.h"
+
+namespace EasyNeuralNetworks {
+namespace neon {
+
+///
+/// NEON vector operation set, see arch/simd/mvo_ops.h
+/// AArch64 has division, fused multiply-add and horizontal reductions,
+/// 32 bit ARM falls back to lane by lane division and pairwise reductions.
+///
+struct neon_ops {
+	typedef float32x4_t vf;
+	static const size_t width = 4;
+	static inline const char * name() { return "neon"; }
+	static inline vf load(const float * p) { return vld1q_f32(p); }
+	static inline void store(float * p, vf a) { vst1q_f32(p, a); }
+	static inline int32x4_t load_i8x4(const void * p) {
+		int32_t a;
+		memcpy(&a, p, sizeof(a));
+		return vmovl_s16(vget_low_s16(vmovl_s8(vreinterpret_s8_s32(vdup_n_s32(a)))));
+	}
+	static inline vf load_i8(const int8_t * p) { return vcvtq_f32_s32(load_i8x4(p)); }
+	/// the bytes are sign extended, the nibbles are sign extended by shifting them to the top
+	static inline void load_i4(const uint8_t * p, vf& lo, vf& hi) {
+		const int32x4_t a = load_i8x4(p);
+		lo = vcvtq_f32_s32(vshrq_n_s32(vshlq_n_s32(a, 28), 28));
+		hi = vcvtq_f32_s32(vshrq_n_s32(a, 4));
+	}
+	/// 32 bit ARM without the half precision extension converts like x86_sse/sse41_ops::load_f16
+	static inline vf load_f16(const uint16_t * p) {
+#if defined(__aarch64__) || (defined(__ARM_NEON_FP) && (__ARM_NEON_FP & 2))
+		return vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(p)));
+#else
+		const uint32x4_t h = vmovl_u16(vld1_u16(p));
+		const uint32x4_t a = vandq_u32(h, vdupq_n_u32(0x7fff));
+		const vf f = vmulq_f32(vreinterpretq_f32_u32(vshlq_n_u32(a, 13)), vreinterpretq_f32_u32(vdupq_n_u32(0x77800000)));
+		const uint32x4_t inf = vandq_u32(vcgtq_u32(a, vdupq_n_u32(0x7bff)), vdupq_n_u32(0x7f800000));
+		const uint32x4_t sign = vshlq_n_u32(veorq_u32(h, a), 16);
+		return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(f), vorrq_u32(inf, sign)));
+#endif
+	}
+	static inline vf load_bf16(const uint16_t * p) { return vreinterpretq_f32_u32(vshll_n_u16(vld1_u16(p), 16)); }
+	static inline vf set1(float a) { return vdupq_n_f32(a); }
+	static inline vf zero() { return vdupq_n_f32(0); }
+	static inline vf add(vf a, vf b) { return vaddq_f32(a, b); }
+	static inline vf sub(vf a, vf b) { return vsubq_f32(a, b); }
+	static inline vf mul(vf a, vf b) { return vmulq_f32(a, b); }
+#if defined(__aarch64__)
+	static inline vf div(vf a, vf b) { return vdivq_f32(a, b); }
+#else
+	static inline vf div(vf a, vf b) {
+		float x[4], y[4];
+		vst1q_f32(x, a);
+		vst1q_f32(y, b);
+		for (int i = 0; i < 4; i++)
+			x[i] /= y[i];
+		return vld1q_f32(x);
+	}
+#endif
+#if defined(__ARM_FEATURE_FMA)
+	static inline vf madd(vf a, vf b, vf c) { return vfmaq_f32(c, a, b); }
+#else
+	static inline vf madd(vf a, vf b, vf c) { return vaddq_f32(vmulq_f32(a, b), c); }
+#endif
+#if defined(__ARM_FEATURE_NUMERIC_MAXMIN)
+	static inline vf max(vf a, vf b) { return vmaxnmq_f32(a, b); }
+	static inline vf min(vf a, vf b) { return vminnmq_f32(a, b); }
+#else
+	/// NOTE: without maxnm/minnm NaNs are propagated instead of being ignored
+	static inline vf max(vf a, vf b) { return vmaxq_f32(a, b); }
+	static inline vf min(vf a, vf b) { return vminq_f32(a, b); }
+#endif
+	/// vmaxq/vminq return NaN if either argument is NaN
+	static inline vf clamp(vf a, vf lo, vf hi) { return vminq_f32(vmaxq_f32(a, lo), hi); }
+#if defined(__aarch64__)
+	static inline float hsum(vf a) { return vaddvq_f32(a); }
+	static inline float hmax(vf a) { return vmaxnmvq_f32(a); }
+	static inline float hmin(vf a) { return vminnmvq_f32(a); }
+#else
+	static inline float hsum(vf a) {
+		float32x2_t b = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+		return vget_lane_f32(vpadd_f32(b, b), 0);
+	}
+	static inline float hmax(vf a) {
+		float32x2_t b = vpmax_f32(vget_low_f32(a), vget_high_f32(a));
+		return vget_lane_f32(vpmax_f32(b, b), 0);
+	}
+	static inline float hmin(vf a) {
+		float32x2_t b = vpmin_f32(vget_low_f32(a), vget_high_f32(a));
+		return vget_lane_f32(vpmin_f32(b, b), 0);
+	}
+#endif
+	static inline void transpose4(float * dst, size_t ld_dst, const float * src, size_t ld_src) {
+		float32x4x2_t t01 = vtrnq_f32(vld1q_f32(src), vld1q_f32(src + ld_src));
+		float32x4x2_t t23 = vtrnq_f32(vld1q_f32(src + 2 * ld_src), vld1q_f32(src + 3 * ld_src));
+		vst1q_f32(dst, vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])));
+		vst1q_f32(dst + ld_dst, vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])));
+		vst1q_f32(dst + 2 * ld_dst, vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+		vst1q_f32(dst + 3 * ld_dst, vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
+	}
+#if defined(__aarch64__)
+	static inline vf nearest(vf a) { return vrndnq_f32(a); }
+#else
+	/// rounds half away from zero
+	static inline vf nearest(vf a) {
+		vf half = vbslq_f32(vdupq_n_u32(0x80000000), a, vdupq_n_f32(0.5f));
+		return vcvtq_f32_s32(vcvtq_s32_f32(vaddq_f32(a, half)));
+	}
+#endif
+	static inline vf pow2(vf n) {
+		return vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23));
+	}
+};
+
+///
+/// NEON int8 operation set, see scalar_qops in arch/simd/mvo_ops.h.
+/// With the dot product extension (__ARM_FEATURE_DOTPROD) sdot sums four products into int32,
+/// otherwise the int8 products are widened to int16 (vmull_s8) and pairwise added into int32.
+///
+struct neon_qops {
+	typedef int32x4_t vi;
+	typedef int8x16_t vx;
+	typedef simd::scalar_qops tail;
+	static const size_t width = 16;
+	static inline vi zero() { return vdupq_n_s32(0); }
+	static inline vx prepare(const int8_t * p) { return vld1q_s8(p); }
+#if defined(__ARM_FEATURE_DOTPROD)
+	static inline vi madd(vx x, const int8_t * p, vi acc) { return vdotq_s32(acc, x, vld1q_s8(p)); }
+#else
+	static inline vi madd(vx x, const int8_t * p, vi acc) {
+		const int8x16_t w = vld1q_s8(p);
+		acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(x), vget_low_s8(w)));
+		return vpadalq_s16(acc, vmull_s8(vget_high_s8(x), vget_high_s8(w)));
+	}
+#endif
+#if defined(__aarch64__)
+	static inline int32_t hsum(vi a) { return vaddvq_s32(a); }
+#else
+	static inline int32_t hsum(vi a) {
+		int32x2_t b = vadd_s32(vget_low_s32(a), vget_high_s32(a));
+		return vget_lane_s32(vpadd_s32(b, b), 0);
+	}
+#endif
+};
+
+};
+};
+
+#endif
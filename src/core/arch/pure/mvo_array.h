@@ -2,13 +2,267 @@
 #define ENN_MVO_ARRAY_H
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <math.h>
 #include <limits>
+#include <assert.h>
 
 namespace EasyNeuralNetworks {
 
+///
+/// Element-wise operations supported by the unit stride kernels
+///
+enum ENN_ARR_OP {
+	ENN_ARR_SUM = 0,	// a + b
+	ENN_ARR_DIFF,			// a - b
+	ENN_ARR_MUL,			// a * b
+	ENN_ARR_DIV,			// a / b
+	ENN_ARR_SUMSQR,		// (a + b)^2
+	ENN_ARR_DIFFSQR,	// (a - b)^2
+	ENN_ARR_SQRSUM,		// a^2 + b^2
+	ENN_ARR_SQRDIFF,	// a^2 - b^2
+};
+
+///
+/// Unit stride kernels.
+/// Functions below are the generic implementations of the inner loops used by
+/// the array/vector/matrix/convolution functions whenever the data is contiguous.
+/// Architecture specific headers (e.g. arch/x86_sse) provide explicit specializations
+/// of these kernels for their native types, so that the public functions
+/// pick up the accelerated versions without any change in the calling code.
+/// Kernels for class types (e.g. FixedPointType) are provided as overloads in this
+/// namespace, hence the kernels are always called with deduced template arguments.
+///
+
+#define ENN_ARR_KERNEL_LOOP(EXPR) \
+	if (add) { \
+		while (num--) { \
+			*dst += EXPR; \
+			++a; \
+			++b; \
+			++dst; \
+		} \
+	} else { \
+		while (num--) { \
+			*dst = EXPR; \
+			++a; \
+			++b; \
+			++dst; \
+		} \
+	}
+
+/// DSTi = Ai op Bi, or DSTi += Ai op Bi if add is true
+template<typename T>
+inline void kernel_arr_binary(ENN_ARR_OP op, bool add, T * dst, const T * a, const T * b, size_t num) {
+	T tmp;
+	switch (op) {
+		case ENN_ARR_SUM: ENN_ARR_KERNEL_LOOP(*a + *b) break;
+		case ENN_ARR_DIFF: ENN_ARR_KERNEL_LOOP(*a - *b) break;
+		case ENN_ARR_MUL: ENN_ARR_KERNEL_LOOP(*a * *b) break;
+		case ENN_ARR_DIV: ENN_ARR_KERNEL_LOOP(*a / *b) break;
+		case ENN_ARR_SUMSQR: ENN_ARR_KERNEL_LOOP((tmp = *a + *b, tmp * tmp)) break;
+		case ENN_ARR_DIFFSQR: ENN_ARR_KERNEL_LOOP((tmp = *a - *b, tmp * tmp)) break;
+		case ENN_ARR_SQRSUM: ENN_ARR_KERNEL_LOOP(*a * *a + *b * *b) break;
+		case ENN_ARR_SQRDIFF: ENN_ARR_KERNEL_LOOP(*a * *a - *b * *b) break;
+	}
+}
+
+#undef ENN_ARR_KERNEL_LOOP
+
+#define ENN_ARR_KERNEL_LOOP(EXPR) \
+	if (add) { \
+		while (num--) { \
+			*dst += EXPR; \
+			++a; \
+			++dst; \
+		} \
+	} else { \
+		while (num--) { \
+			*dst = EXPR; \
+			++a; \
+			++dst; \
+		} \
+	}
+
+/// DSTi = Ai op c, or DSTi += Ai op c if add is true. dst may be equal to a.
+/// Only ENN_ARR_SUM, ENN_ARR_DIFF, ENN_ARR_MUL and ENN_ARR_DIV are supported.
+template<typename T>
+inline void kernel_arr_const(ENN_ARR_OP op, bool add, T * dst, const T * a, T c, size_t num) {
+	switch (op) {
+		case ENN_ARR_SUM: ENN_ARR_KERNEL_LOOP(*a + c) break;
+		case ENN_ARR_DIFF: ENN_ARR_KERNEL_LOOP(*a - c) break;
+		case ENN_ARR_MUL: ENN_ARR_KERNEL_LOOP(*a * c) break;
+		case ENN_ARR_DIV: ENN_ARR_KERNEL_LOOP(*a / c) break;
+		default: assert(false);
+	}
+}
+
+#undef ENN_ARR_KERNEL_LOOP
+
+///
+/// Reductions use four independent accumulators, so that the adds do not wait for each
+/// other, and pairwise summation of ENN_REDUCE_BLOCK sized blocks, so that the rounding
+/// error grows with log(num) rather than num for long vectors.
+///
+#if !defined(ENN_REDUCE_BLOCK)
+#define ENN_REDUCE_BLOCK 1024
+#endif
+
+/// SUMi Ai (or SUMi Ai^2 if SQR is true) of at most ENN_REDUCE_BLOCK values
+template<typename T, bool SQR>
+inline T kernel_block_sum_arr(const T * a, size_t num) {
+	T acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+	size_t i = 0;
+	for (; i + 4 <= num; i += 4) {
+		acc0 += SQR ? a[i] * a[i] : a[i];
+		acc1 += SQR ? a[i + 1] * a[i + 1] : a[i + 1];
+		acc2 += SQR ? a[i + 2] * a[i + 2] : a[i + 2];
+		acc3 += SQR ? a[i + 3] * a[i + 3] : a[i + 3];
+	}
+	for (; i < num; i++)
+		acc0 += SQR ? a[i] * a[i] : a[i];
+	return (acc0 + acc1) + (acc2 + acc3);
+}
+
+///
+/// Accumulator of the means, small integer types (e.g. quantized int8_t values) are
+/// widened so that the sums don't overflow
+///
+template<typename T> struct kernel_accumulator { typedef T type; };
+template<> struct kernel_accumulator<int8_t> { typedef int32_t type; };
+template<> struct kernel_accumulator<uint8_t> { typedef int32_t type; };
+template<> struct kernel_accumulator<int16_t> { typedef int32_t type; };
+template<> struct kernel_accumulator<uint16_t> { typedef int32_t type; };
+
+/// SUM / num, integers are rounded to the nearest
+template<typename T, typename T_ACC>
+inline T kernel_mean_div(T_ACC sum, size_t num) {
+	if (!std::numeric_limits<T_ACC>::is_integer)
+		return (T)(sum / (T_ACC)num);
+	const T_ACC half = (T_ACC)(num / 2);
+	return (T)((sum < 0 ? sum - half : sum + half) / (T_ACC)num);
+}
+
+/// SUMi Ai
+template<typename T>
+inline T kernel_sum_arr(const T * a, size_t num) {
+	if (num <= ENN_REDUCE_BLOCK)
+		return kernel_block_sum_arr<T, false>(a, num);
+	const size_t half = num / 2;
+	return kernel_sum_arr(a, half) + kernel_sum_arr(a + half, num - half);
+}
+
+/// SUMi Ai^2
+template<typename T>
+inline T kernel_sqrsum_arr(const T * a, size_t num) {
+	if (num <= ENN_REDUCE_BLOCK)
+		return kernel_block_sum_arr<T, true>(a, num);
+	const size_t half = num / 2;
+	return kernel_sqrsum_arr(a, half) + kernel_sqrsum_arr(a + half, num - half);
+}
+
+/// SUMi (Ai - K) and SUMi (Ai - K)^2 used for moments calculation
+template<typename T>
+inline void kernel_shifted_sums_arr(T * Ex, T * Ex2, const T * a, T K, size_t num) {
+	if (num > ENN_REDUCE_BLOCK) {
+		const size_t half = num / 2;
+		T Ex_hi, Ex2_hi;
+		kernel_shifted_sums_arr(Ex, Ex2, a, K, half);
+		kernel_shifted_sums_arr(&Ex_hi, &Ex2_hi, a + half, K, num - half);
+		*Ex += Ex_hi;
+		*Ex2 += Ex2_hi;
+		return;
+	}
+	T acc0 = 0, acc1 = 0, sqr0 = 0, sqr1 = 0;
+	T tmp0, tmp1;
+	size_t i = 0;
+	for (; i + 2 <= num; i += 2) {
+		tmp0 = a[i] - K;
+		tmp1 = a[i + 1] - K;
+		acc0 += tmp0;
+		acc1 += tmp1;
+		sqr0 += tmp0 * tmp0;
+		sqr1 += tmp1 * tmp1;
+	}
+	if (i < num) {
+		tmp0 = a[i] - K;
+		acc0 += tmp0;
+		sqr0 += tmp0 * tmp0;
+	}
+	*Ex = acc0 + acc1;
+	*Ex2 = sqr0 + sqr1;
+}
+
+/// max (min if MIN is true) of at most ENN_REDUCE_BLOCK values, NaNs are skipped
+template<typename T, bool MIN>
+inline T kernel_block_minmax_arr(const T * a, size_t num, T init) {
+	T acc0 = init, acc1 = init, acc2 = init, acc3 = init;
+	size_t i = 0;
+	for (; i + 4 <= num; i += 4) {
+		acc0 = (MIN ? a[i] < acc0 : a[i] > acc0) ? a[i] : acc0;
+		acc1 = (MIN ? a[i + 1] < acc1 : a[i + 1] > acc1) ? a[i + 1] : acc1;
+		acc2 = (MIN ? a[i + 2] < acc2 : a[i + 2] > acc2) ? a[i + 2] : acc2;
+		acc3 = (MIN ? a[i + 3] < acc3 : a[i + 3] > acc3) ? a[i + 3] : acc3;
+	}
+	for (; i < num; i++)
+		acc0 = (MIN ? a[i] < acc0 : a[i] > acc0) ? a[i] : acc0;
+	acc0 = (MIN ? acc1 < acc0 : acc1 > acc0) ? acc1 : acc0;
+	acc2 = (MIN ? acc3 < acc2 : acc3 > acc2) ? acc3 : acc2;
+	return (MIN ? acc2 < acc0 : acc2 > acc0) ? acc2 : acc0;
+}
+
+///
+/// max (or min if is_min is true) value and the index of the first occurence in a single pass.
+/// The extreme of every ENN_REDUCE_BLOCK values is found without branches and only the
+/// block holding the first occurence of the overall extreme, which is still in cache,
+/// is searched for the index.
+///
+///
+/// initial value of a min (is_min) or max search over a: +-infinity if T has it, otherwise
+/// the first value, since numeric_limits<T>::infinity() is 0 for int8_t, int16_t or FixedPointType
+///
+template<typename T>
+inline T kernel_minmax_init(bool is_min, const T * a, size_t num) {
+	if (std::numeric_limits<T>::has_infinity)
+		return is_min ? std::numeric_limits<T>::infinity() : -std::numeric_limits<T>::infinity();
+	return num > 0 ? a[0] : T();
+}
+
+template<typename T>
+inline T kernel_minmax_arr(bool is_min, size_t * index, const T * a, size_t num) {
+	const T init = kernel_minmax_init(is_min, a, num);
+	T acc = init;
+	size_t block = 0, i, end;
+	for (i = 0; i < num; i += ENN_REDUCE_BLOCK) {
+		const size_t n = num - i < ENN_REDUCE_BLOCK ? num - i : ENN_REDUCE_BLOCK;
+		const T tmp = is_min ? kernel_block_minmax_arr<T, true>(a + i, n, init) : kernel_block_minmax_arr<T, false>(a + i, n, init);
+		if (is_min ? tmp < acc : tmp > acc) {
+			acc = tmp;
+			block = i;
+		}
+	}
+	*index = 0;
+	end = num - block < ENN_REDUCE_BLOCK ? num : block + ENN_REDUCE_BLOCK;
+	for (i = block; i < end; i++) {
+		if (a[i] == acc) {
+			*index = i;
+			break;
+		}
+	}
+	return acc;
+}
+
+
+///
+/// Public array functions
+///
+
 template<typename T, typename T_SIZE>
 inline void diff_arr(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE stridea = 1, T_SIZE strideb = 1) {
+	if (stridea == 1 && strideb == 1) {
+		kernel_arr_binary(ENN_ARR_DIFF, false, dst, a, b, num);
+		return;
+	}
 	while (num--) {
 		*dst = *a - *b;
 		a += stridea;
@@ -19,6 +273,10 @@ inline void diff_arr(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE strid
 
 template<typename T, typename T_SIZE>
 inline void sum_arr(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE stridea = 1, T_SIZE strideb = 1) {
+	if (stridea == 1 && strideb == 1) {
+		kernel_arr_binary(ENN_ARR_SUM, false, dst, a, b, num);
+		return;
+	}
 	while (num--) {
 		*dst = *a + *b;
 		a += stridea;
@@ -29,6 +287,10 @@ inline void sum_arr(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE stride
 
 template<typename T, typename T_SIZE>
 inline void sum_arr(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride = 1) {
+	if (stride == 1) {
+		kernel_arr_const(ENN_ARR_SUM, false, dst, src, c, num);
+		return;
+	}
 	while (num--) {
 		*dst = *src + c;
 		src += stride;
@@ -38,6 +300,10 @@ inline void sum_arr(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride = 1)
 
 template<typename T, typename T_SIZE>
 inline void diff_arr(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride = 1) {
+	if (stride == 1) {
+		kernel_arr_const(ENN_ARR_DIFF, false, dst, src, c, num);
+		return;
+	}
 	while (num--) {
 		*dst = *src - c;
 		src += stride;
@@ -47,6 +313,10 @@ inline void diff_arr(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride = 1)
 
 template<typename T, typename T_SIZE>
 inline void mul_arr(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride = 1) {
+	if (stride == 1) {
+		kernel_arr_const(ENN_ARR_MUL, false, dst, src, c, num);
+		return;
+	}
 	while (num--) {
 		*dst = *src * c;
 		src += stride;
@@ -56,6 +326,10 @@ inline void mul_arr(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride = 1)
 
 template<typename T, typename T_SIZE>
 inline void div_arr(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride = 1) {
+	if (stride == 1) {
+		kernel_arr_const(ENN_ARR_DIV, false, dst, src, c, num);
+		return;
+	}
 	while (num--) {
 		*dst = *src / c;
 		src += stride;
@@ -65,6 +339,10 @@ inline void div_arr(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride = 1)
 
 template<typename T, typename T_SIZE>
 inline void sum_arr_add(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride = 1) {
+	if (stride == 1) {
+		kernel_arr_const(ENN_ARR_SUM, true, dst, src, c, num);
+		return;
+	}
 	while (num--) {
 		*dst += *src + c;
 		src += stride;
@@ -74,6 +352,10 @@ inline void sum_arr_add(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride =
 
 template<typename T, typename T_SIZE>
 inline void diff_arr_add(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride = 1) {
+	if (stride == 1) {
+		kernel_arr_const(ENN_ARR_DIFF, true, dst, src, c, num);
+		return;
+	}
 	while (num--) {
 		*dst += *src - c;
 		src += stride;
@@ -83,6 +365,10 @@ inline void diff_arr_add(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride
 
 template<typename T, typename T_SIZE>
 inline void mul_arr_add(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride = 1) {
+	if (stride == 1) {
+		kernel_arr_const(ENN_ARR_MUL, true, dst, src, c, num);
+		return;
+	}
 	while (num--) {
 		*dst += *src * c;
 		src += stride;
@@ -92,6 +378,10 @@ inline void mul_arr_add(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride =
 
 template<typename T, typename T_SIZE>
 inline void div_arr_add(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride = 1) {
+	if (stride == 1) {
+		kernel_arr_const(ENN_ARR_DIV, true, dst, src, c, num);
+		return;
+	}
 	while (num--) {
 		*dst += *src / c;
 		src += stride;
@@ -101,41 +391,33 @@ inline void div_arr_add(T * dst, const T * src, T c, T_SIZE num, T_SIZE stride =
 
 template<typename T, typename T_SIZE>
 inline void sum_arr(T * dst, T c, T_SIZE num) {
-	while (num--) {
-		*dst += c;
-		++dst;
-	}
+	kernel_arr_const(ENN_ARR_SUM, false, dst, dst, c, num);
 }
 
 template<typename T, typename T_SIZE>
 inline void diff_arr(T * dst, T c, T_SIZE num) {
-	while (num--) {
-		*dst -= c;
-		++dst;
-	}
+	kernel_arr_const(ENN_ARR_DIFF, false, dst, dst, c, num);
 }
 
 template<typename T, typename T_SIZE>
 inline void mul_arr(T * dst, T c, T_SIZE num) {
-	while (num--) {
-		*dst *= c;
-		++dst;
-	}
+	kernel_arr_const(ENN_ARR_MUL, false, dst, dst, c, num);
 }
 
 template<typename T, typename T_SIZE>
 inline void div_arr(T * dst, T c, T_SIZE num) {
-	while (num--) {
-		*dst /= c;
-		++dst;
-	}
+	kernel_arr_const(ENN_ARR_DIV, false, dst, dst, c, num);
 }
 
 template<typename T, typename T_SIZE>
 inline void diffsqr_arr(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE stridea = 1, T_SIZE strideb = 1) {
+	if (stridea == 1 && strideb == 1) {
+		kernel_arr_binary(ENN_ARR_DIFFSQR, false, dst, a, b, num);
+		return;
+	}
 	T tmp;
 	while (num--) {
-		tmp = *a - *b
+		tmp = *a - *b;
 		*dst = tmp * tmp;
 		a += stridea;
 		++dst;
@@ -145,9 +427,13 @@ inline void diffsqr_arr(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE st
 
 template<typename T, typename T_SIZE>
 inline void sumsqr_arr(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE stridea = 1, T_SIZE strideb = 1) {
+	if (stridea == 1 && strideb == 1) {
+		kernel_arr_binary(ENN_ARR_SUMSQR, false, dst, a, b, num);
+		return;
+	}
 	T tmp;
 	while (num--) {
-		tmp = *a + *b
+		tmp = *a + *b;
 		*dst = tmp * tmp;
 		a += stridea;
 		++dst;
@@ -157,8 +443,12 @@ inline void sumsqr_arr(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE str
 
 template<typename T, typename T_SIZE>
 inline void sqrdiff_arr(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE stridea = 1, T_SIZE strideb = 1) {
+	if (stridea == 1 && strideb == 1) {
+		kernel_arr_binary(ENN_ARR_SQRDIFF, false, dst, a, b, num);
+		return;
+	}
 	while (num--) {
-		*dst = *a **a - *b **b;
+		*dst = *a * *a - *b * *b;
 		a += stridea;
 		++dst;
 		b += strideb;
@@ -167,6 +457,10 @@ inline void sqrdiff_arr(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE st
 
 template<typename T, typename T_SIZE>
 inline void sqrsum_arr(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE stridea = 1, T_SIZE strideb = 1) {
+	if (stridea == 1 && strideb == 1) {
+		kernel_arr_binary(ENN_ARR_SQRSUM, false, dst, a, b, num);
+		return;
+	}
 	while (num--) {
 		*dst = *a * *a + *b * *b;
 		a += stridea;
@@ -177,6 +471,8 @@ inline void sqrsum_arr(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE str
 
 template<typename T, typename T_SIZE>
 inline T sum_arr(const T * a, T_SIZE num, T_SIZE stride = 1) {
+	if (stride == 1)
+		return kernel_sum_arr(a, num);
 	T acc = 0;
 	while (num--) {
 		acc += *a;
@@ -187,6 +483,8 @@ inline T sum_arr(const T * a, T_SIZE num, T_SIZE stride = 1) {
 
 template<typename T, typename T_SIZE>
 inline T sqrsum_arr(const T * a, T_SIZE num, T_SIZE stride = 1) {
+	if (stride == 1)
+		return kernel_sqrsum_arr(a, num);
 	T acc = 0;
 	while (num--) {
 		acc += *a * *a;
@@ -197,7 +495,14 @@ inline T sqrsum_arr(const T * a, T_SIZE num, T_SIZE stride = 1) {
 
 template<typename T, typename T_SIZE>
 inline T min_arr(T_SIZE * index, const T * a, T_SIZE num, T_SIZE stride = 1) {
-	T acc = std::numeric_limits<T>::infinity();
+	if (stride == 1) {
+		size_t idx;
+		T acc = kernel_minmax_arr(true, &idx, a, num);
+		if (index != NULL)
+			*index = idx;
+		return acc;
+	}
+	T acc = kernel_minmax_init(true, a, num);
 	T_SIZE idx = 0;
 	for (T_SIZE i = 0; i < num; i++) {
 		auto tmp = *a;
@@ -214,7 +519,14 @@ inline T min_arr(T_SIZE * index, const T * a, T_SIZE num, T_SIZE stride = 1) {
 
 template<typename T, typename T_SIZE>
 inline T max_arr(T_SIZE * index, const T * a, T_SIZE num, T_SIZE stride = 1) {
-	T acc = -std::numeric_limits<T>::infinity();
+	if (stride == 1) {
+		size_t idx;
+		T acc = kernel_minmax_arr(false, &idx, a, num);
+		if (index != NULL)
+			*index = idx;
+		return acc;
+	}
+	T acc = kernel_minmax_init(false, a, num);
 	T_SIZE idx = 0;
 	for (T_SIZE i = 0; i < num; i++) {
 		auto tmp = *a;
@@ -231,7 +543,12 @@ inline T max_arr(T_SIZE * index, const T * a, T_SIZE num, T_SIZE stride = 1) {
 
 template<typename T, typename T_SIZE>
 inline T mean_arr(const T * a, T_SIZE num, T_SIZE stride = 1) {
-	return sum_arr(a, num, stride) / (T)num;
+	if (!std::numeric_limits<T>::is_integer)
+		return sum_arr(a, num, stride) / (T)num;
+	typename kernel_accumulator<T>::type acc = 0;
+	for (T_SIZE i = 0; i < num; i++, a += stride)
+		acc += *a;
+	return kernel_mean_div<T>(acc, num);
 }
 
 template<typename T, typename T_SIZE>
@@ -245,11 +562,15 @@ inline void moments_arr(T * mean, T * stddev, const T * a, T_SIZE num, T_SIZE st
 	T Ex2 = 0.0;
 	T tmp;
 
-	while (num--) {
-		tmp = *a - K;
-		Ex += tmp;
-		Ex2 += tmp * tmp;
-		a += stride;
+	if (stride == 1) {
+		kernel_shifted_sums_arr(&Ex, &Ex2, a, K, num);
+	} else {
+		while (num--) {
+			tmp = *a - K;
+			Ex += tmp;
+			Ex2 += tmp * tmp;
+			a += stride;
+		}
 	}
 	*mean = K + Ex / n;
 	*stddev = (Ex2 - (Ex * Ex) / n) / n;
@@ -0,0 +1,267 @@
+#if !defined(ENN_MVO_BFP_H)
+#define ENN_MVO_BFP_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <limits>
+
+namespace EasyNeuralNetworks {
+
+///
+/// Block floating point, see the block floating point layers (e.g. BlockFloatDenseLayer).
+///
+/// A block of values shares one exponent: Xi = Mi * 2^E, the mantissas Mi are int8_t or int16_t
+/// in [-max, max] and E is an int8_t. Unlike FixedPointType the exponent is not fixed at compile
+/// time: every layer picks the exponent of each output block from the largest value in it
+/// (see kernel_bfp_normalize), so that each block uses the full width of the mantissas wherever
+/// the values of the network are. Everything but the conversions from and to float is integer
+/// arithmetic, for targets without an FPU.
+///
+/// Products of two blocks are summed in a wide integer (see bfp_wide), the sums of the blocks of
+/// a row are aligned to the largest of their exponents, keeping as many low bits as int64 can hold
+/// without overflow (see bfp_guard), and added in int64.
+/// A block of zeros has the exponent ENN_BFP_ZERO_EXPONENT, so that it does not take part in the alignment.
+///
+
+#define ENN_BFP_ZERO_EXPONENT (-128)
+#define ENN_BFP_MAX_EXPONENT 127
+
+/// accumulator of the products of a block
+template<typename T> struct bfp_wide { typedef int64_t type; };
+template<> struct bfp_wide<int8_t> { typedef int32_t type; };
+
+/// number of magnitude bits of the mantissas, 7 or 15
+template<typename T>
+inline int bfp_bits() { return std::numeric_limits<T>::digits; }
+
+inline int bfp_bit_length(uint64_t a) {
+	int n = 0;
+	while (a) {
+		a >>= 1;
+		n++;
+	}
+	return n;
+}
+
+/// round(a * 2^shift), rounds half up. a * 2^shift must fit in int64
+inline int64_t bfp_shift(int64_t a, int shift) {
+	if (shift >= 0)
+		return a * ((int64_t)1 << shift);
+	if (shift < -62)
+		return 0;
+	return (a + ((int64_t)1 << (-shift - 1))) >> -shift;
+}
+
+/// bits left in int64 by a sum of num products of two mantissas
+template<typename T>
+inline int bfp_guard(size_t num) {
+	const int guard = 62 - 2 * bfp_bits<T>() - bfp_bit_length(num);
+	return guard > 0 ? guard : 0;
+}
+
+/// exponent of a block whose largest magnitude is absmax
+inline int bfp_exponent(float absmax, int bits) {
+	if (!(absmax > 0))
+		return ENN_BFP_ZERO_EXPONENT;
+	int e = 0;
+	frexpf(absmax, &e);
+	e -= bits;
+	return e < ENN_BFP_ZERO_EXPONENT ? ENN_BFP_ZERO_EXPONENT : e > ENN_BFP_MAX_EXPONENT ? ENN_BFP_MAX_EXPONENT : e;
+}
+
+///
+/// Unit stride kernels, see mvo_array.h
+///
+
+/// DSTi * 2^DST_EXP = SRCi rounded to a shared exponent, returns DST_EXP
+template<typename T>
+inline int8_t kernel_bfp_from_float(T * dst, const float * src, size_t num) {
+	const float max = std::numeric_limits<T>::max();
+	float absmax = 0;
+	for (size_t i = 0; i < num; i++)
+		absmax = fabsf(src[i]) > absmax ? fabsf(src[i]) : absmax;
+	const int e = bfp_exponent(absmax, bfp_bits<T>());
+	for (size_t i = 0; i < num; i++) {
+		float m = ldexpf(src[i], -e);
+		m = m < -max ? -max : m > max ? max : m;
+		dst[i] = (T)(int32_t)(m < 0 ? m - 0.5f : m + 0.5f);
+	}
+	return (int8_t)e;
+}
+
+/// DSTi = SRCi * 2^SRC_EXP
+template<typename T>
+inline void kernel_bfp_to_float(float * dst, const T * src, int src_exp, size_t num) {
+	for (size_t i = 0; i < num; i++)
+		dst[i] = ldexpf((float)src[i], src_exp);
+}
+
+/// SUMi Ai * Bi in the wide type. int8_t mantissas use the vectorized int8 dot products of the quantized layers
+template<typename T>
+inline typename bfp_wide<T>::type kernel_bfp_dot(const T * a, const T * b, size_t num) {
+	typedef typename bfp_wide<T>::type W;
+	if (sizeof(T) == 1) {
+		int32_t acc;
+		kernel_qmat_mul(&acc, a, b, num, 1);
+		return acc;
+	}
+	W acc = 0;
+	for (size_t i = 0; i < num; i++)
+		acc += (W)a[i] * (W)b[i];
+	return acc;
+}
+
+///
+/// ACCj * 2^ACC_EXPj = SUMi VECi * MATij + BIASj {if bias is not NULL}, i < N, j < M
+/// where VECi = vec[i] * 2^vec_exp[i / B], MATij = mat[i + j * N] * 2^mat_exp[i / B + j * NB], NB = (N + B - 1) / B
+/// and BIASj = bias[j] * 2^bias_exp[j], i.e. the rows of the matrix are split in the same blocks as the vector.
+///
+template<typename T>
+inline void kernel_bfp_mat_mul(int64_t * acc, int * acc_exp, const T * vec, const int8_t * vec_exp, const T * mat, const int8_t * mat_exp,
+		const T * bias, const int8_t * bias_exp, size_t N, size_t M, size_t B) {
+	const size_t NB = (N + B - 1) / B;
+	const int guard = bfp_guard<T>(N + 1);
+
+	for (size_t j = 0; j < M; j++, mat += N, mat_exp += NB) {
+		int e = 2 * ENN_BFP_ZERO_EXPONENT;
+		for (size_t k = 0; k < NB; k++)
+			e = vec_exp[k] + mat_exp[k] > e ? vec_exp[k] + mat_exp[k] : e;
+		if (bias)
+			e = bias_exp[j] > e ? bias_exp[j] : e;
+		e -= guard;
+
+		int64_t a = 0;
+		for (size_t k = 0; k < NB; k++) {
+			const size_t len = N - k * B < B ? N - k * B : B;
+			a += bfp_shift(kernel_bfp_dot(vec + k * B, mat + k * B, len), vec_exp[k] + mat_exp[k] - e);
+		}
+		if (bias)
+			a += bfp_shift(bias[j], bias_exp[j] - e);
+		acc[j] = a;
+		acc_exp[j] = e;
+	}
+}
+
+///
+/// ACC(a + b * NKS) * 2^ACC_EXP = SUMc SUMj SUMi MAT(c, a * stride + i, b * stride + j) * KERNEL(c, i, j) + BIAS {if bias is not NULL},
+/// a single output channel of a convolution of NxM x C channels with a kernel of KxL x C, returns ACC_EXP.
+/// Each channel c of the input and of the kernel has its own exponent, mat_exp[c] and kernel_exp[c].
+///
+template<typename T>
+inline int kernel_bfp_convolve_2d(int64_t * acc, const T * mat, const int8_t * mat_exp, const T * kernel, const int8_t * kernel_exp,
+		const T * bias, int bias_exp, size_t N, size_t M, size_t C, size_t K, size_t L, size_t stride) {
+	const size_t MLS = (M - L) / stride + 1;
+	const size_t NKS = (N - K) / stride + 1;
+	const size_t channel = N * M;
+
+	int e = 2 * ENN_BFP_ZERO_EXPONENT;
+	for (size_t c = 0; c < C; c++)
+		e = mat_exp[c] + kernel_exp[c] > e ? mat_exp[c] + kernel_exp[c] : e;
+	if (bias)
+		e = bias_exp > e ? bias_exp : e;
+	e -= bfp_guard<T>(C * K * L + 1);
+
+	for (size_t b = 0; b < MLS; b++) {
+		for (size_t a = 0; a < NKS; a++, ++acc) {
+			const T * p = mat + b * stride * N + a * stride;
+			const T * k = kernel;
+			int64_t s = bias ? bfp_shift(*bias, bias_exp - e) : 0;
+			for (size_t c = 0; c < C; c++, p += channel) {
+				typename bfp_wide<T>::type d = 0;
+				for (size_t j = 0; j < L; j++, k += K)
+					d += kernel_bfp_dot(p + j * N, k, K);
+				s += bfp_shift(d, mat_exp[c] + kernel_exp[c] - e);
+			}
+			*acc = s;
+		}
+	}
+	return e;
+}
+
+///
+/// DSTi * 2^DST_EXP = ACCi * 2^ACC_EXP(i * exp_stride) rounded to a shared exponent, returns DST_EXP.
+/// DST_EXP is chosen so that the largest value uses all the bits of the mantissa, the mantissas saturate
+/// only if it is above ENN_BFP_MAX_EXPONENT. Negative values become 0 if relu is true.
+///
+template<typename T>
+inline int8_t kernel_bfp_normalize(T * dst, const int64_t * acc, const int * acc_exp, size_t exp_stride, size_t num, bool relu) {
+	const int bits = bfp_bits<T>();
+	const int64_t max = std::numeric_limits<T>::max();
+	int top = 2 * ENN_BFP_ZERO_EXPONENT - 64;
+	for (size_t i = 0; i < num; i++) {
+		const int64_t a = relu && acc[i] < 0 ? 0 : acc[i];
+		if (a) {
+			const int t = bfp_bit_length((uint64_t)(a < 0 ? -a : a)) + acc_exp[i * exp_stride];
+			top = t > top ? t : top;
+		}
+	}
+	int e = top - bits;
+	e = e < ENN_BFP_ZERO_EXPONENT ? ENN_BFP_ZERO_EXPONENT : e > ENN_BFP_MAX_EXPONENT ? ENN_BFP_MAX_EXPONENT : e;
+
+	for (size_t i = 0; i < num; i++) {
+		const int64_t a = relu && acc[i] < 0 ? 0 : acc[i];
+		const int shift = acc_exp[i * exp_stride] - e;
+		int64_t m;
+		if (shift > 0 && bfp_bit_length((uint64_t)(a < 0 ? -a : a)) + shift > bits)
+			m = a < 0 ? -max : max;
+		else
+			m = bfp_shift(a, shift);
+		dst[i] = (T)(m < -max ? -max : m > max ? max : m);
+	}
+	return (int8_t)e;
+}
+
+///
+/// Public functions
+///
+
+/// DSTi * 2^DST_EXP(i / block) = SRCi, one exponent per block of block values
+template<typename T, typename T_SIZE>
+void to_bfp_arr(T * dst, int8_t * dst_exp, const float * src, T_SIZE num, T_SIZE block) {
+	for (T_SIZE i = 0; i < num; i += block, dst_exp++)
+		*dst_exp = kernel_bfp_from_float(dst + i, src + i, num - i < block ? num - i : block);
+}
+
+/// DSTi = SRCi * 2^SRC_EXP(i / block)
+template<typename T, typename T_SIZE>
+void from_bfp_arr(float * dst, const T * src, const int8_t * src_exp, T_SIZE num, T_SIZE block) {
+	for (T_SIZE i = 0; i < num; i += block, src_exp++)
+		kernel_bfp_to_float(dst + i, src + i, *src_exp, num - i < block ? num - i : block);
+}
+
+///
+/// The forward pass of a block floating point dense layer, see kernel_bfp_mat_mul:
+/// DSTj * 2^DST_EXP(j / out_block) = relu(SUMi VECi * MATij + BIASj), i < N, j < M.
+/// The vector and the rows of the matrix have blocks of in_block values, the outputs blocks of out_block values.
+/// ACC and ACC_EXP hold the M sums before they are normalized.
+///
+template<typename T, typename T_SIZE>
+void bfp_mat_mul(T * dst, int8_t * dst_exp, int64_t * acc, int * acc_exp, const T * vec, const int8_t * vec_exp, const T * mat, const int8_t * mat_exp,
+		const T * bias, const int8_t * bias_exp, T_SIZE N, T_SIZE M, T_SIZE in_block, T_SIZE out_block, bool relu) {
+	kernel_bfp_mat_mul(acc, acc_exp, vec, vec_exp, mat, mat_exp, bias, bias_exp, N, M, in_block);
+	for (T_SIZE j = 0; j < M; j += out_block, dst_exp++)
+		*dst_exp = kernel_bfp_normalize(dst + j, acc + j, acc_exp + j, 1, M - j < out_block ? M - j : out_block, relu);
+}
+
+///
+/// The forward pass of a block floating point convolution of NxM x C channels with F kernels of KxL x C,
+/// stored as F rows of K * L * C values with C exponents each (one per channel of the kernel).
+/// The input has one exponent per channel, so does the output: DST is P x F, where P is the number of outputs per kernel,
+/// and DST_EXP has F exponents. ACC holds the P sums of a channel before they are normalized.
+///
+template<typename T, typename T_SIZE>
+void bfp_convolve_2d(T * dst, int8_t * dst_exp, int64_t * acc, const T * mat, const int8_t * mat_exp, const T * kernels, const int8_t * kernel_exp,
+		const T * bias, const int8_t * bias_exp, T_SIZE N, T_SIZE M, T_SIZE C, T_SIZE K, T_SIZE L, T_SIZE F, T_SIZE stride, bool relu) {
+	const size_t P = ((M - L) / stride + 1) * ((N - K) / stride + 1);
+	const size_t row = (size_t)K * L * C;
+	for (T_SIZE f = 0; f < F; f++) {
+		const int e = kernel_bfp_convolve_2d(acc, mat, mat_exp, kernels + f * row, kernel_exp + f * C,
+			bias ? bias + f : (const T *)NULL, bias ? bias_exp[f] : 0, N, M, C, K, L, stride);
+		dst_exp[f] = kernel_bfp_normalize(dst + f * P, acc, &e, 0, P, relu);
+	}
+}
+
+};
+
+#endif
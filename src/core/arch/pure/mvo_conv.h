@@ -4,35 +4,145 @@
 #include <stdlib.h>
 #include <math.h>
 #include <limits>
+#include <type_traits>
 
 namespace EasyNeuralNetworks {
 
+///
+/// Unit stride kernels. See mvo_array.h
+///
+
+/// DSTj += SUMi VEC[i + j * stride] * KERNEL[i], vector is N, kernel is M
+template<typename T>
+inline void kernel_convolve_1d(T * dst, const T * vec, const T * kernel, size_t N, size_t M, size_t stride) {
+	const size_t dst_size = (N - M) / stride + 1;
+
+	for (size_t i = 0; i < dst_size; i++) {
+		*dst += kernel_dot_product(vec, kernel, M);
+		vec += stride;
+		++dst;
+	}
+}
+
+/// DSTab += SUMij MAT[i + a * stride + (j + b * stride) * N] * KERNEL[i + j * K], matrix is NxM, kernel is KxL
+template<typename T>
+inline void kernel_convolve_2d(T * dst, const T * mat, const T * kernel, size_t N, size_t M, size_t K, size_t L, size_t stride) {
+	const size_t MLS = (M - L) / stride + 1;
+	const size_t NKS = (N - K) / stride + 1;
+	const T * p;
+
+	for (size_t b = 0; b < MLS; b++) {
+		p = mat + (b * stride) * N;
+		for (size_t a = 0; a < NKS; a++) {
+			T acc = 0;
+			const T * row = p;
+			const T * k = kernel;
+			for (size_t j = 0; j < L; j++) {
+				acc += kernel_dot_product(row, k, K);
+				row += N;
+				k += K;
+			}
+			*dst += acc;
+			p += stride;
+			++dst;
+		}
+	}
+}
+
+/// convolution of NF <= 4 kernels at once, see kernel_convolve_2d_multi
+template<typename T, size_t NF>
+inline void kernel_convolve_2d_block(T * dst, const T * mat, const T * kernel, size_t row, size_t N, size_t M, size_t C, size_t K, size_t L, size_t stride) {
+	const size_t MLS = (M - L) / stride + 1;
+	const size_t NKS = (N - K) / stride + 1;
+	const size_t size = NKS * MLS;
+	const size_t channel = N * M;
+
+	for (size_t b = 0; b < MLS; b++) {
+		for (size_t a = 0; a < NKS; a++) {
+			T acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+			const T * p = mat + b * stride * N + a * stride;
+			const T * k = kernel;
+			for (size_t c = 0; c < C; c++, p += channel) {
+				const T * r = p;
+				for (size_t j = 0; j < L; j++, r += N, k += K) {
+					for (size_t i = 0; i < K; i++) {
+						const T x = r[i];
+						acc0 += x * k[i];
+						if (NF > 1) acc1 += x * k[row + i];
+						if (NF > 2) acc2 += x * k[2 * row + i];
+						if (NF > 3) acc3 += x * k[3 * row + i];
+					}
+				}
+			}
+			dst[0] = acc0;
+			if (NF > 1) dst[size] = acc1;
+			if (NF > 2) dst[2 * size] = acc2;
+			if (NF > 3) dst[3 * size] = acc3;
+			++dst;
+		}
+	}
+}
+
+///
+/// DSTf,ab = SUMcij MAT[i + a * stride + (j + b * stride) * N + c * N * M] * KERNEL[i + j * K + c * K * L + f * row]
+/// matrix is NxM x C channels, F kernels of KxL x C, destination is NKS x MLS x F.
+/// Blocks of 4 kernels are computed in a single pass over the input, keeping the partial sums in registers.
+///
+template<typename T>
+inline void kernel_convolve_2d_multi(T * dst, const T * mat, const T * kernel, size_t row, size_t N, size_t M, size_t C, size_t K, size_t L, size_t F, size_t stride) {
+	const size_t size = ((N - K) / stride + 1) * ((M - L) / stride + 1);
+	size_t f = 0;
+
+	for (; f + 4 <= F; f += 4)
+		kernel_convolve_2d_block<T, 4>(dst + f * size, mat, kernel + f * row, row, N, M, C, K, L, stride);
+	if (f + 2 <= F) {
+		kernel_convolve_2d_block<T, 2>(dst + f * size, mat, kernel + f * row, row, N, M, C, K, L, stride);
+		f += 2;
+	}
+	if (f < F)
+		kernel_convolve_2d_block<T, 1>(dst + f * size, mat, kernel + f * row, row, N, M, C, K, L, stride);
+}
+
+/// FFT butterfly on complex arrays stored as real and imaginary parts:
+/// Ti = Bi * (wr + j * wi), Bi = Ai - Ti, Ai = Ai + Ti
+template<typename T>
+inline void kernel_fft_butterfly(T * ar, T * ai, T * br, T * bi, T wr, T wi, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		const T tr = br[i] * wr - bi[i] * wi;
+		const T ti = br[i] * wi + bi[i] * wr;
+		br[i] = ar[i] - tr;
+		bi[i] = ai[i] - ti;
+		ar[i] += tr;
+		ai[i] += ti;
+	}
+}
+
+/// DSTi += Ai * (cr + j * ci), complex arrays stored as real and imaginary parts
+template<typename T>
+inline void kernel_complex_madd(T * dr, T * di, const T * ar, const T * ai, T cr, T ci, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		dr[i] += ar[i] * cr - ai[i] * ci;
+		di[i] += ar[i] * ci + ai[i] * cr;
+	}
+}
+
+///
+/// Public convolution functions
+///
+
 
 template<typename T, typename T_SIZE, bool TRANSPOSED>
 void convolve_1d_add(T * dst, const T * vec, const T * kernel, T_SIZE N, T_SIZE M, T_SIZE stride) {
 	// vector is N
 	// kernel is M
-	// FIXME use fast algorithm for forward calculation
-	T_SIZE j, i;
+	// see convolve_2d_multi, im2row_1d and convolve_fft for the fast algorithms used by ConvLayer1D
 	if (!TRANSPOSED) {
 		// DSTj = SUMi VEC[i + j * stride] * KERNEL[i]
-		const T_SIZE dst_size = (N - M) / stride + 1;
-
-		for (i = 0; i < dst_size; i++) {
-			*dst += dot_product<T, T_SIZE>(vec, kernel, M);
-			vec += stride;
-			++dst;
-		}
+		kernel_convolve_1d(dst, vec, kernel, N, M, stride);
 	} else {
 		// DSTj = SUMi VEC[i - K + 1 + j * stride] * KERNEL[K-i-1]
-		for (i = 0; i < N; i++) {
-			T * d = dst + i * stride;
-			const T * w = kernel;
-			for (j = 0; j < M; j++) {
-				*d += *w * *vec;
-				++d;
-				++w;
-			}
+		for (T_SIZE i = 0; i < N; i++) {
+			kernel_arr_const(ENN_ARR_MUL, true, dst + i * stride, kernel, *vec, M);
 			++vec;
 		}
 	}
@@ -44,25 +154,412 @@ void convolve_2d_add(T * dst, const T * mat, const T * kernel, T_SIZE N, T_SIZE
 	// kernel is KxL
 	//
 	// DSTab = SUMij MAT[i+j*N + a + b*N] * KERNEL[i + j*K] + KERNEL[K*L]{if BIAS};   a < N - K, b < M - L
-	// FIXME use fast algorithm for forward calculation
+	// see convolve_2d_multi, im2row_2d, convolve_3x3_winograd and convolve_fft for the fast algorithms used by ConvLayer2D
 	if (!TRANSPOSED) {
-		T_SIZE a, b, j;
-		const T * p;
-		const T * k;
-		T acc;
-		const T_SIZE MLS = (M - L) / stride + 1;
-		const T_SIZE NKS = (N - K) / stride + 1;
-
-		for (b = 0; b < MLS; b++) {
-			p = mat + (b * stride) * N;
-			for (a = 0; a < NKS; a++) {
-				*dst += dot_product_2d<T, T_SIZE>(p, kernel, N, M, K, L);
-				p += N;
-				++dst;
+		kernel_convolve_2d(dst, mat, kernel, N, M, K, L, stride);
+	} else {
+
+	}
+}
+
+///
+/// DST (NKS, MLS, F) = convolution of the NxM x C input with F kernels of KxL x C without bias,
+/// kernel f starts at kernel[f * row] (see ConvLayer1D/2D, 1D is the case of M = L = 1).
+/// Unlike convolve_2d_add for each kernel and channel, the input is scanned once per block of kernels
+/// and each output is written once, with no scratch memory.
+///
+template<typename T, typename T_SIZE>
+void convolve_2d_multi(T * dst, const T * mat, const T * kernel, T_SIZE row, T_SIZE N, T_SIZE M, T_SIZE C, T_SIZE K, T_SIZE L, T_SIZE F, T_SIZE stride) {
+	kernel_convolve_2d_multi(dst, mat, kernel, row, N, M, C, K, L, F, stride);
+}
+
+///
+/// Lowering of convolutions to matrix multiplication (im2col, stored with patches as rows).
+/// Row p of the destination holds the input patch of output p (kernel width first,
+/// then kernel height, then channels, i.e. the same order as the conv layer weights),
+/// followed by a one if bias is true. The convolution of all the kernels then becomes
+///		mat_mul_batch<T, false, T_SIZE, false>(dst, weights, patches, K * L * C + bias, P, kernels)
+/// where P is the number of outputs per kernel.
+///
+
+/// vector is N x C channels, kernel is M, destination is ((N - M) / stride + 1) x (M * C + bias)
+template<typename T, typename T_SIZE>
+void im2row_1d(T * dst, const T * vec, T_SIZE N, T_SIZE C, T_SIZE M, T_SIZE stride, bool bias) {
+	const size_t dst_size = (N - M) / stride + 1;
+
+	for (size_t a = 0; a < dst_size; a++) {
+		const T * p = vec + a * stride;
+		for (size_t c = 0; c < C; c++, p += N)
+			for (size_t i = 0; i < M; i++)
+				*dst++ = p[i];
+		if (bias)
+			*dst++ = 1;
+	}
+}
+
+/// matrix is NxM x C channels, kernel is KxL,
+/// destination is ((N - K) / stride + 1) * ((M - L) / stride + 1) x (K * L * C + bias)
+template<typename T, typename T_SIZE>
+void im2row_2d(T * dst, const T * mat, T_SIZE N, T_SIZE M, T_SIZE C, T_SIZE K, T_SIZE L, T_SIZE stride, bool bias) {
+	const size_t MLS = (M - L) / stride + 1;
+	const size_t NKS = (N - K) / stride + 1;
+	const size_t channel = (size_t)N * M;
+
+	for (size_t b = 0; b < MLS; b++) {
+		for (size_t a = 0; a < NKS; a++) {
+			const T * p = mat + (b * stride) * N + a * stride;
+			for (size_t c = 0; c < C; c++, p += channel) {
+				const T * row = p;
+				for (size_t j = 0; j < L; j++, row += N)
+					for (size_t i = 0; i < K; i++)
+						*dst++ = row[i];
 			}
+			if (bias)
+				*dst++ = 1;
 		}
-	} else {
+	}
+}
 
+///
+/// Winograd F(2x2, 3x3) convolution for 3x3 kernels with unit stride.
+/// Each 2x2 block of outputs is computed from a 4x4 input tile as
+///		Y = At * [SUMc (G * Gc * Gt) .* (Bt * Dc * B)] * A
+/// i.e. 16 multiplications per channel instead of 36 for the direct convolution.
+/// The sum over channels for each of the 16 tile elements is a matrix multiplication
+/// (kernels x channels) * (channels x tiles), done with mat_mul_batch.
+///
+/// Transformed kernels U are (C, K, 16): U[c + k * C + e * K * C], e < 16
+/// Transformed input V is (C, tiles, 16): V[c + t * C + e * tiles * C]
+/// Products P are (tiles, K, 16): P[t + k * tiles + e * K * tiles]
+/// where tiles = ((N - 1) / 2) * ((M - 1) / 2) for NxM input
+///
+
+/// transforms K kernels of C channels, kernel k starts at weights[k * row] (see ConvLayer2D)
+template<typename T, typename T_SIZE>
+void winograd_3x3_kernels(T * U, const T * weights, T_SIZE C, T_SIZE K, T_SIZE row) {
+	const size_t KC = (size_t)K * C;
+	const T half = 0.5f;
+	T t[4][3];
+
+	for (size_t k = 0; k < K; k++) {
+		for (size_t c = 0; c < C; c++) {
+			const T * g = weights + k * row + c * 9;
+			// G * g
+			for (size_t x = 0; x < 3; x++) {
+				t[0][x] = g[x];
+				t[1][x] = (g[x] + g[x + 3] + g[x + 6]) * half;
+				t[2][x] = (g[x] - g[x + 3] + g[x + 6]) * half;
+				t[3][x] = g[x + 6];
+			}
+			// (G * g) * Gt
+			T * u = U + c + k * C;
+			for (size_t y = 0; y < 4; y++) {
+				u[(y * 4 + 0) * KC] = t[y][0];
+				u[(y * 4 + 1) * KC] = (t[y][0] + t[y][1] + t[y][2]) * half;
+				u[(y * 4 + 2) * KC] = (t[y][0] - t[y][1] + t[y][2]) * half;
+				u[(y * 4 + 3) * KC] = t[y][2];
+			}
+		}
+	}
+}
+
+/// transforms 4x4 input tiles with a step of 2 of the NxM x C input, zero padded at the edges
+template<typename T, typename T_SIZE>
+void winograd_3x3_input(T * V, const T * mat, T_SIZE N, T_SIZE M, T_SIZE C) {
+	const size_t TX = (N - 1) / 2;
+	const size_t TY = (M - 1) / 2;
+	const size_t TC = TX * TY * C;
+	T d[4][4], t[4][4];
+
+	// channels are the innermost loop, so that the transformed tiles are written sequentially
+	for (size_t ty = 0; ty < TY; ty++) {
+		for (size_t tx = 0; tx < TX; tx++) {
+			const T * p = mat + (ty * 2) * N + tx * 2;
+			const size_t w = N - tx * 2 < 4 ? N - tx * 2 : 4;
+			const size_t h = M - ty * 2 < 4 ? M - ty * 2 : 4;
+			T * v = V + (ty * TX + tx) * C;
+			for (size_t c = 0; c < C; c++, p += (size_t)N * M) {
+				for (size_t y = 0; y < 4; y++)
+					for (size_t x = 0; x < 4; x++)
+						d[y][x] = (y < h && x < w) ? p[y * N + x] : T(0);
+				// Bt * d
+				for (size_t x = 0; x < 4; x++) {
+					t[0][x] = d[0][x] - d[2][x];
+					t[1][x] = d[1][x] + d[2][x];
+					t[2][x] = d[2][x] - d[1][x];
+					t[3][x] = d[1][x] - d[3][x];
+				}
+				// (Bt * d) * B
+				for (size_t y = 0; y < 4; y++) {
+					v[c + (y * 4 + 0) * TC] = t[y][0] - t[y][2];
+					v[c + (y * 4 + 1) * TC] = t[y][1] + t[y][2];
+					v[c + (y * 4 + 2) * TC] = t[y][2] - t[y][1];
+					v[c + (y * 4 + 3) * TC] = t[y][1] - t[y][3];
+				}
+			}
+		}
+	}
+}
+
+/// inverse transform of the products into the (N - 2)x(M - 2) x K output
+template<typename T, typename T_SIZE>
+void winograd_3x3_output(T * dst, const T * P, T_SIZE N, T_SIZE M, T_SIZE K) {
+	const size_t TX = (N - 1) / 2;
+	const size_t TY = (M - 1) / 2;
+	const size_t OW = N - 2;
+	const size_t OH = M - 2;
+	const size_t TK = TX * TY * K;
+	T m[4][4], t[2][4];
+
+	for (size_t k = 0; k < K; k++) {
+		T * out = dst + k * OW * OH;
+		for (size_t ty = 0; ty < TY; ty++) {
+			for (size_t tx = 0; tx < TX; tx++) {
+				const T * p = P + (ty * TX + tx) + k * TX * TY;
+				for (size_t e = 0; e < 16; e++)
+					m[e / 4][e % 4] = p[e * TK];
+				// At * m
+				for (size_t x = 0; x < 4; x++) {
+					t[0][x] = m[0][x] + m[1][x] + m[2][x];
+					t[1][x] = m[1][x] - m[2][x] - m[3][x];
+				}
+				// (At * m) * A
+				for (size_t y = 0; y < 2 && ty * 2 + y < OH; y++) {
+					T * o = out + (ty * 2 + y) * OW + tx * 2;
+					o[0] = t[y][0] + t[y][1] + t[y][2];
+					if (tx * 2 + 1 < OW)
+						o[1] = t[y][1] - t[y][2] - t[y][3];
+				}
+			}
+		}
+	}
+}
+
+/// DST (N - 2, M - 2, K) = convolution of the NxM x C input with K transformed kernels U
+/// V and P are scratch buffers of 16 * tiles * C and 16 * tiles * K
+template<typename T, typename T_SIZE>
+void convolve_3x3_winograd(T * dst, const T * mat, const T * U, T * V, T * P, T_SIZE N, T_SIZE M, T_SIZE C, T_SIZE K) {
+	const size_t tiles = (size_t)((N - 1) / 2) * ((M - 1) / 2);
+
+	winograd_3x3_input<T, T_SIZE>(V, mat, N, M, C);
+	for (size_t e = 0; e < 16; e++)
+		mat_mul_batch<T, false, size_t, false>(P + e * tiles * K, U + e * (size_t)K * C, V + e * tiles * C, C, tiles, K);
+	winograd_3x3_output<T, T_SIZE>(dst, P, N, M, K);
+}
+
+///
+/// FFT convolution with overlap-save blocks, for long 1D kernels and large 2D kernels.
+/// The correlation of an input block with a kernel is IFFT(FFT(block) * conj(FFT(kernel))),
+/// of which the outputs not affected by the circular wrap around are kept: an Lx x Ly block
+/// yields (Lx - KW + 1) x (Ly - KH + 1) outputs. 1D is the case of Ly = 1.
+///
+/// Complex values are stored as separate real and imaginary planes and all the blocks of all
+/// the channels are transformed at once: element i of every signal is a contiguous row of the
+/// batch width, so each butterfly and each spectral product is a unit stride kernel call.
+///
+/// Kernel spectra W are (F * C, 1, 2 * Lx * Ly): W[f * C + c + i * F * C], imaginary plane after
+/// the real plane, i = x + y * Lx
+/// Input spectra X are (blocks * C, 1, 2 * Lx * Ly): X[b + c * blocks + i * C * blocks]
+/// Output spectra Y are (blocks * F, 1, 2 * Lx * Ly): Y[b + f * blocks + i * F * blocks]
+///
+
+/// twiddle factors of an FFT of size n, usable for any power of two size up to n.
+/// tw is n values: n / 2 real parts followed by n / 2 imaginary parts
+template<typename T>
+void fft_twiddles(T * tw, size_t n) {
+	for (size_t k = 0; k < n / 2; k++) {
+		tw[k] = cos(-2 * M_PI * k / n);
+		tw[n / 2 + k] = sin(-2 * M_PI * k / n);
+	}
+}
+
+///
+/// In place radix-2 FFT of width signals of n complex values, element i of signal b is
+/// re[b + i * width], im[b + i * width]. tn is the size of the twiddle table.
+/// The inverse transform is not scaled.
+///
+template<typename T>
+void fft_batch(T * re, T * im, const T * tw, size_t tn, size_t n, size_t width, bool inverse) {
+	size_t i, j, k, len;
+
+	// bit reversal permutation
+	for (i = 1, j = 0; i < n; i++) {
+		size_t bit = n >> 1;
+		for (; j & bit; bit >>= 1)
+			j ^= bit;
+		j ^= bit;
+		if (i < j) {
+			for (k = 0; k < width; k++) {
+				T t = re[i * width + k]; re[i * width + k] = re[j * width + k]; re[j * width + k] = t;
+				t = im[i * width + k]; im[i * width + k] = im[j * width + k]; im[j * width + k] = t;
+			}
+		}
+	}
+
+	for (len = 2; len <= n; len <<= 1) {
+		const size_t half = len / 2;
+		const size_t step = tn / len;
+		for (k = 0; k < half; k++) {
+			const T wr = tw[k * step];
+			const T wi = inverse ? -tw[tn / 2 + k * step] : tw[tn / 2 + k * step];
+			for (i = k; i < n; i += len)
+				kernel_fft_butterfly(re + i * width, im + i * width, re + (i + half) * width, im + (i + half) * width, wr, wi, width);
+		}
+	}
+}
+
+/// in place FFT of width Lx x Ly signals, element (x, y) of signal b is re[b + (x + y * Lx) * width]
+template<typename T>
+void fft_2d_batch(T * re, T * im, const T * tw, size_t tn, size_t Lx, size_t Ly, size_t width, bool inverse) {
+	if (Lx > 1) {
+		for (size_t y = 0; y < Ly; y++)
+			fft_batch(re + y * Lx * width, im + y * Lx * width, tw, tn, Lx, width, inverse);
+	}
+	if (Ly > 1)
+		fft_batch(re, im, tw, tn, Ly, Lx * width, inverse);
+}
+
+/// smallest power of two not less than n
+inline size_t fft_size(size_t n) {
+	size_t L = 1;
+	while (L < n)
+		L <<= 1;
+	return L;
+}
+
+/// number of Lx x Ly overlap-save blocks for NxM input and KWxKH kernels
+inline size_t fft_conv_blocks(size_t Lx, size_t Ly, size_t N, size_t M, size_t KW, size_t KH) {
+	const size_t SX = Lx - KW + 1;
+	const size_t SY = Ly - KH + 1;
+	return ((N - KW + SX) / SX) * ((M - KH + SY) / SY);
+}
+
+///
+/// Cost of a kernel call relative to a multiply-add, used by fft_conv_plan to account for
+/// narrow batches (e.g. long 1D inputs with a single block per channel).
+///
+#if !defined(ENN_CONV_FFT_CALL_COST)
+#define ENN_CONV_FFT_CALL_COST 8
+#endif
+
+///
+/// Chooses the block size for an NxM x C input and F kernels of KWxKH with unit stride.
+/// Returns true if the FFT convolution is estimated to be faster than the direct one.
+///
+inline bool fft_conv_plan(size_t * Lx, size_t * Ly, size_t N, size_t M, size_t C, size_t F, size_t KW, size_t KH) {
+	const double direct = (double)(N - KW + 1) * (M - KH + 1) * KW * KH * C * F;
+	double best = -1;
+
+	for (size_t lx = fft_size(KW); lx <= fft_size(N); lx <<= 1) {
+		for (size_t ly = fft_size(KH); ly <= fft_size(M); ly <<= 1) {
+			if (lx * ly == 1)
+				continue;
+			const double n = lx * ly;
+			const double blocks = fft_conv_blocks(lx, ly, N, M, KW, KH);
+			double lg = 0;
+			for (size_t i = lx * ly; i > 1; i >>= 1)
+				lg += 1;
+			// butterflies of 3 multiply-adds per element plus a call each,
+			// 4 multiply-adds per complex product plus a call for every frequency, channel and kernel
+			const double calls = (n / 2) * lg * (ly > 1 && lx > 1 ? 2 : 1) + n * C * F;
+			const double cost = blocks * n * ((C + F) * (1.5 * lg + 1) + 4 * C * F) + calls * ENN_CONV_FFT_CALL_COST;
+			if (best < 0 || cost < best) {
+				best = cost;
+				*Lx = lx;
+				*Ly = ly;
+			}
+		}
+	}
+	return best >= 0 && best < direct;
+}
+
+/// spectra of F kernels of C channels of KWxKH for Lx x Ly blocks, conjugated and scaled
+/// by 1 / (Lx * Ly). Kernel f starts at weights[f * row] (see ConvLayer1D/2D)
+template<typename T, typename T_SIZE>
+void fft_conv_kernels(T * W, const T * weights, const T * tw, size_t tn, T_SIZE C, T_SIZE F, T_SIZE KW, T_SIZE KH, T_SIZE row, size_t Lx, size_t Ly) {
+	const size_t n = Lx * Ly;
+	const size_t width = (size_t)F * C;
+	T * re = W;
+	T * im = W + n * width;
+	const T scale = 1.0 / n;
+	size_t i, f, c, x, y;
+
+	for (i = 0; i < 2 * n * width; i++)
+		W[i] = 0;
+	for (f = 0; f < F; f++)
+		for (c = 0; c < C; c++)
+			for (y = 0; y < KH; y++)
+				for (x = 0; x < KW; x++)
+					re[f * C + c + (x + y * Lx) * width] = weights[f * row + c * KW * KH + x + y * KW];
+
+	fft_2d_batch(re, im, tw, tn, Lx, Ly, width, false);
+	for (i = 0; i < n * width; i++) {
+		re[i] *= scale;
+		im[i] *= -scale;
+	}
+}
+
+///
+/// DST (N - KW + 1, M - KH + 1, F) = correlation of the NxM x C input with F kernels of KWxKH
+/// with unit stride, using the kernel spectra W of fft_conv_kernels.
+/// X and Y are scratch buffers of 2 * Lx * Ly * blocks * C and 2 * Lx * Ly * blocks * F,
+/// see fft_conv_blocks.
+///
+template<typename T, typename T_SIZE>
+void convolve_fft(T * dst, const T * mat, const T * W, const T * tw, size_t tn, T * X, T * Y, T_SIZE N, T_SIZE M, T_SIZE C, T_SIZE F, T_SIZE KW, T_SIZE KH, size_t Lx, size_t Ly) {
+	const size_t OW = N - KW + 1;
+	const size_t OH = M - KH + 1;
+	const size_t SX = Lx - KW + 1;
+	const size_t SY = Ly - KH + 1;
+	const size_t BX = (OW + SX - 1) / SX;
+	const size_t B = fft_conv_blocks(Lx, Ly, N, M, KW, KH);
+	const size_t n = Lx * Ly;
+	const size_t xw = B * C;
+	const size_t yw = B * F;
+	T * xr = X;
+	T * xi = X + n * xw;
+	T * yr = Y;
+	T * yi = Y + n * yw;
+	size_t b, c, f, i, x, y;
+
+	// input blocks, zero padded beyond the input
+	for (i = 0; i < 2 * n * xw; i++)
+		X[i] = 0;
+	for (b = 0; b < B; b++) {
+		const size_t bx = (b % BX) * SX;
+		const size_t by = (b / BX) * SY;
+		const size_t w = N - bx < Lx ? N - bx : Lx;
+		const size_t h = M - by < Ly ? M - by : Ly;
+		for (c = 0; c < C; c++) {
+			const T * p = mat + c * (size_t)N * M + by * N + bx;
+			for (y = 0; y < h; y++)
+				for (x = 0; x < w; x++)
+					xr[b + c * B + (x + y * Lx) * xw] = p[x + y * N];
+		}
+	}
+	fft_2d_batch(xr, xi, tw, tn, Lx, Ly, xw, false);
+
+	// spectra of the outputs, summed over the channels
+	for (i = 0; i < 2 * n * yw; i++)
+		Y[i] = 0;
+	for (i = 0; i < n; i++) {
+		const T * wr = W + i * F * C;
+		const T * wi = W + (n + i) * F * C;
+		for (f = 0; f < F; f++)
+			for (c = 0; c < C; c++)
+				kernel_complex_madd(yr + i * yw + f * B, yi + i * yw + f * B, xr + i * xw + c * B, xi + i * xw + c * B, wr[f * C + c], wi[f * C + c], B);
+	}
+	fft_2d_batch(yr, yi, tw, tn, Lx, Ly, yw, true);
+
+	for (b = 0; b < B; b++) {
+		const size_t bx = (b % BX) * SX;
+		const size_t by = (b / BX) * SY;
+		for (f = 0; f < F; f++) {
+			T * o = dst + f * OW * OH + by * OW + bx;
+			for (y = 0; y < SY && by + y < OH; y++)
+				for (x = 0; x < SX && bx + x < OW; x++)
+					o[x + y * OW] = yr[b + f * B + (x + y * Lx) * yw];
+		}
 	}
 }
 
@@ -0,0 +1,205 @@
+#if !defined(ENN_MVO_CONVERT_H)
+#define ENN_MVO_CONVERT_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <limits>
+#include "../../FixedPointType.h"
+
+namespace EasyNeuralNetworks {
+
+///
+/// Conversions between the formats of a mixed precision network, see ConversionLayer and MixedDenseLayer.
+///
+/// float to FixedPointType rounds to nearest and saturates (unlike FixedPointType::operator =,
+/// which truncates and wraps around), FixedPointType<A, EA> to FixedPointType<B, EB> shifts
+/// the raw value by EA - EB, rounds and saturates. int8 quantized values (see quant_params)
+/// are converted through their real value.
+///
+/// kernel_mixed_mat_mul fuses the conversion into the epilogue of a dense layer: the wide sum of
+/// the raw FixedPointType products is rescaled once to the output format instead of being narrowed
+/// to the input format first, which saves a pass over the outputs and a rounding.
+///
+
+/// A / 2^shift rounded half up and saturated to R, a negative shift multiplies by 2^-shift
+template<typename R>
+inline R fixed_rescale(int64_t a, int shift) {
+	const int64_t lo = (int64_t)std::numeric_limits<R>::min();
+	const int64_t hi = (int64_t)std::numeric_limits<R>::max();
+	int64_t r = a;
+	if (shift >= 63) {
+		r = 0;
+	} else if (shift > 0) {
+		r = (a + ((int64_t)1 << (shift - 1))) >> shift;
+	} else if (shift < 0) {
+		if (a > (shift <= -63 ? 0 : hi >> -shift))
+			r = hi + 1;
+		else if (a < (shift <= -63 ? 0 : lo >> -shift))
+			r = lo - 1;
+		else
+			r = a * ((int64_t)1 << -shift);
+	}
+	if (r < lo || r > hi) {
+		ENN_FIXED_SATURATION_IF(true);
+		return (R)(r < lo ? lo : hi);
+	}
+	ENN_FIXED_UNDERFLOW_IF(a != 0 && r == 0);
+	return (R)r;
+}
+
+/// round(A * 2^EXPONENT) saturated to T, NaN is 0
+template<typename T, int EXPONENT>
+inline T fixed_from_float(double a) {
+	const double v = ldexp(a, EXPONENT);
+	const double lo = (double)std::numeric_limits<T>::min();
+	const double hi = (double)std::numeric_limits<T>::max();
+	if (!(v == v))
+		return 0;
+	if (v <= lo || v >= hi) {
+		ENN_FIXED_SATURATION_IF(v < lo || v > hi);
+		return v <= lo ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+	}
+	const T r = (T)(v < 0 ? v - 0.5 : v + 0.5);
+	ENN_FIXED_UNDERFLOW_IF(a != 0 && r == 0);
+	return r;
+}
+
+/// DST = A in the format of DST
+template<typename D, typename S>
+inline void convert_value(D& dst, const S& a) {
+	dst = (D)a;
+}
+
+template<typename T, int EXPONENT>
+inline void convert_value(FixedPointType<T, EXPONENT>& dst, const float& a) {
+	dst = FixedPointType<T, EXPONENT>::from_raw(fixed_from_float<T, EXPONENT>(a));
+}
+
+template<typename T, int EXPONENT>
+inline void convert_value(FixedPointType<T, EXPONENT>& dst, const double& a) {
+	dst = FixedPointType<T, EXPONENT>::from_raw(fixed_from_float<T, EXPONENT>(a));
+}
+
+template<typename T, int EXPONENT>
+inline void convert_value(float& dst, const FixedPointType<T, EXPONENT>& a) {
+	dst = (float)ldexp((double)a.get_raw(), -EXPONENT);
+}
+
+template<typename T, int EXPONENT>
+inline void convert_value(double& dst, const FixedPointType<T, EXPONENT>& a) {
+	dst = ldexp((double)a.get_raw(), -EXPONENT);
+}
+
+template<typename D, int D_EXPONENT, typename S, int S_EXPONENT>
+inline void convert_value(FixedPointType<D, D_EXPONENT>& dst, const FixedPointType<S, S_EXPONENT>& a) {
+	dst = FixedPointType<D, D_EXPONENT>::from_raw(fixed_rescale<D>(a.get_raw(), S_EXPONENT - D_EXPONENT));
+}
+
+/// DST = ACC / 2^exponent in the format of DST, the epilogue of kernel_mixed_mat_mul
+template<typename T, int EXPONENT>
+inline void fixed_store(FixedPointType<T, EXPONENT>& dst, int64_t acc, int exponent) {
+	dst = FixedPointType<T, EXPONENT>::from_raw(fixed_rescale<T>(acc, exponent - EXPONENT));
+}
+
+inline void fixed_store(float& dst, int64_t acc, int exponent) {
+	dst = (float)ldexp((double)acc, -exponent);
+}
+
+inline void fixed_store(double& dst, int64_t acc, int exponent) {
+	dst = ldexp((double)acc, -exponent);
+}
+
+///
+/// Unit stride kernels. See mvo_array.h
+///
+
+/// DSTj = SUMi VECi * MATij + MAT(N+1)j {if bias} in the format of DST,
+/// the wide sum of the raw products (exponent 2 * EXPONENT) is rescaled once, see fixed_store
+template<typename D, typename T, int EXPONENT>
+inline void kernel_mixed_mat_mul(D * dst, const FixedPointType<T, EXPONENT> * vec, const FixedPointType<T, EXPONENT> * mat, size_t N, size_t M, bool bias) {
+	typedef typename fixed_wide<T>::type W;
+	const size_t row = bias ? N + 1 : N;
+	const T * v = fixed_raw(vec);
+	const T * m = fixed_raw(mat);
+
+	for (size_t j = 0; j < M; j++, m += row) {
+		W acc = kernel_fixed_dot(v, m, N);
+		if (bias)
+			acc += fixed_widen(m[N], EXPONENT);
+		fixed_store(dst[j], (int64_t)acc, 2 * EXPONENT);
+	}
+}
+
+/// float inputs and weights, ENN_FUSED_TILE outputs at a time are computed in float and converted to DST
+template<typename D>
+inline void kernel_mixed_mat_mul(D * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias) {
+	const size_t row = bias ? N + 1 : N;
+	float acc[ENN_FUSED_TILE];
+
+	for (size_t j = 0; j < M; j += ENN_FUSED_TILE) {
+		const size_t num = M - j < ENN_FUSED_TILE ? M - j : ENN_FUSED_TILE;
+		kernel_mat_mul(acc, vec, mat + j * row, N, num, bias, false);
+		for (size_t k = 0; k < num; k++)
+			convert_value(dst[j + k], acc[k]);
+	}
+}
+
+///
+/// Public functions
+///
+
+/// DSTi = SRCi in the format of DST
+template<typename D, typename S, typename T_SIZE>
+void convert_arr(D * dst, const S * src, T_SIZE num) {
+	for (T_SIZE i = 0; i < num; i++)
+		convert_value(dst[i], src[i]);
+}
+
+///
+/// DSTi = SRCi in the format of DST, int8 values on either side are quantized with params (see quant_params),
+/// without params they convert as integers
+///
+template<typename D, typename S, typename T_SIZE>
+void convert_arr(D * dst, const S * src, const quant_params * params, T_SIZE num) {
+	convert_arr(dst, src, num);
+}
+
+template<typename D, typename T_SIZE>
+void convert_arr(D * dst, const int8_t * src, const quant_params * params, T_SIZE num) {
+	if (params == NULL) {
+		convert_arr(dst, src, num);
+		return;
+	}
+	for (T_SIZE i = 0; i < num; i++)
+		convert_value(dst[i], dequantize(src[i], *params));
+}
+
+template<typename S, typename T_SIZE>
+void convert_arr(int8_t * dst, const S * src, const quant_params * params, T_SIZE num) {
+	if (params == NULL) {
+		convert_arr(dst, src, num);
+		return;
+	}
+	float a;
+	for (T_SIZE i = 0; i < num; i++) {
+		convert_value(a, src[i]);
+		dst[i] = quantize(a, *params);
+	}
+}
+
+/// int8 to int8 is a copy, quantized values keep their parameters
+template<typename T_SIZE>
+void convert_arr(int8_t * dst, const int8_t * src, const quant_params * params, T_SIZE num) {
+	convert_arr(dst, src, num);
+}
+
+/// DSTj = SUMi VECi * MATij + MAT(N+1)j {if BIAS=true} in the format of DST, see kernel_mixed_mat_mul
+template<typename D, typename T, bool BIAS, typename T_SIZE>
+void mixed_mat_mul(D * dst, const T * vec, const T * mat, T_SIZE N, T_SIZE M) {
+	kernel_mixed_mat_mul(dst, vec, mat, N, M, BIAS);
+}
+
+};
+
+#endif
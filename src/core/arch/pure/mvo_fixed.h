@@ -0,0 +1,197 @@
+#if !defined(ENN_MVO_FIXED_H)
+#define ENN_MVO_FIXED_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits>
+#include "../../FixedPointType.h"
+
+namespace EasyNeuralNetworks {
+
+///
+/// Deferred-shift accumulation for FixedPointType.
+///
+/// FixedPointType::operator * shifts every product by EXPONENT, so a sum of n products
+/// does n shifts and truncates each of them (an error of up to n units of the last place,
+/// biased towards -infinity), and the sum wraps around on overflow. The reductions below
+/// (dot_product, mat_mul, mat_mul_batch and the forward convolutions) accumulate the raw
+/// products in a wider integer (see fixed_wide), then round, shift and saturate once per
+/// output: the error is at most half a unit of the last place and the results clamp to the
+/// range of the type instead of wrapping around.
+///
+/// The wide sum itself must not overflow, i.e. SUMi |Ai * Bi| < 2^31 for 8 and 16 bit types
+/// (e.g. 2^15 products of values using 8 of the 16 bits), the same bound as the int32
+/// accumulators of SMLAD or pmaddwd.
+/// Element-wise operations and the training kernels (mat_mul_transposed, outer products)
+/// keep the semantics of FixedPointType.
+///
+
+/// accumulator of the raw products
+template<typename T> struct fixed_wide { typedef T type; };
+template<> struct fixed_wide<int8_t> { typedef int32_t type; };
+template<> struct fixed_wide<int16_t> { typedef int32_t type; };
+template<> struct fixed_wide<int32_t> { typedef int64_t type; };
+template<> struct fixed_wide<uint8_t> { typedef uint32_t type; };
+template<> struct fixed_wide<uint16_t> { typedef uint32_t type; };
+template<> struct fixed_wide<uint32_t> { typedef uint64_t type; };
+
+/// a << shift in the wide type, e.g. a bias added to the sum of the products
+template<typename T>
+inline typename fixed_wide<T>::type fixed_widen(T a, int shift) {
+	typedef typename fixed_wide<T>::type W;
+	return (W)a * ((W)1 << shift);
+}
+
+/// round(acc / 2^shift), saturated to the range of T
+template<typename T>
+inline T fixed_narrow(typename fixed_wide<T>::type acc, int shift) {
+	typedef typename fixed_wide<T>::type W;
+	W r = acc;
+	if (shift > 0)
+		r = (acc + ((W)1 << (shift - 1))) >> shift;
+	if (r < (W)std::numeric_limits<T>::min()) {
+		ENN_FIXED_SATURATION_IF(true);
+		return std::numeric_limits<T>::min();
+	}
+	if (r > (W)std::numeric_limits<T>::max()) {
+		ENN_FIXED_SATURATION_IF(true);
+		return std::numeric_limits<T>::max();
+	}
+	ENN_FIXED_UNDERFLOW_IF(acc != 0 && r == 0);
+	return (T)r;
+}
+
+///
+/// largest EXPONENT of FixedPointType<T, EXPONENT> holding values up to absmax
+/// with headroom bits to spare, in [0, digits of T], see Calibrator
+///
+template<typename T>
+inline int fixed_exponent_from_range(float absmax, int headroom = 0) {
+	const int digits = std::numeric_limits<T>::digits;
+	int e = 0;
+	if (absmax > 0)
+		frexp(absmax, &e);
+	e = digits - headroom - e;
+	return e < 0 ? 0 : e > digits ? digits : e;
+}
+
+///
+/// Unit stride kernels on the raw values. See mvo_array.h
+///
+
+/// SUMi Ai * Bi in the wide type
+template<typename T>
+inline typename fixed_wide<T>::type kernel_fixed_dot(const T * a, const T * b, size_t num) {
+	typedef typename fixed_wide<T>::type W;
+	W acc = 0;
+#if defined(ENN_FIXED_POINT_STATS)
+	double exact = 0;
+	for (size_t i = 0; i < num; i++)
+		exact += (double)a[i] * (double)b[i];
+	ENN_FIXED_OVERFLOW_IF(exact < (double)std::numeric_limits<W>::min() || exact > (double)std::numeric_limits<W>::max());
+#endif
+	while (num--) {
+		acc += (W)*a * (W)*b;
+		++a;
+		++b;
+	}
+	return acc;
+}
+
+/// DSTj = narrow(SUMi VECi * MATij + (MAT(N+1)j {if bias} + DSTj {if add}) << shift), see kernel_mat_mul
+template<typename T>
+inline void kernel_fixed_mat_mul(T * dst, const T * vec, const T * mat, size_t N, size_t M, bool bias, bool add, int shift) {
+	typedef typename fixed_wide<T>::type W;
+	const size_t row = bias ? N + 1 : N;
+
+	for (size_t j = 0; j < M; j++, mat += row) {
+		W acc = kernel_fixed_dot(vec, mat, N);
+		if (bias)
+			acc += fixed_widen(mat[N], shift);
+		if (add)
+			acc += fixed_widen(dst[j], shift);
+		dst[j] = fixed_narrow<T>(acc, shift);
+	}
+}
+
+///
+/// FixedPointType overloads of the kernels in mvo_vector.h, mvo_matrix.h and mvo_conv.h
+///
+
+template<typename T, int EXPONENT>
+inline const T * fixed_raw(const FixedPointType<T, EXPONENT> * p) { return reinterpret_cast<const T *>(p); }
+
+template<typename T, int EXPONENT>
+inline T * fixed_raw(FixedPointType<T, EXPONENT> * p) { return reinterpret_cast<T *>(p); }
+
+template<typename T, int EXPONENT>
+inline FixedPointType<T, EXPONENT> kernel_dot_product(const FixedPointType<T, EXPONENT> * a, const FixedPointType<T, EXPONENT> * b, size_t num) {
+	return FixedPointType<T, EXPONENT>::from_raw(fixed_narrow<T>(kernel_fixed_dot(fixed_raw(a), fixed_raw(b), num), EXPONENT));
+}
+
+template<typename T, int EXPONENT>
+inline void kernel_mat_mul(FixedPointType<T, EXPONENT> * dst, const FixedPointType<T, EXPONENT> * vec, const FixedPointType<T, EXPONENT> * mat, size_t N, size_t M, bool bias, bool add) {
+	kernel_fixed_mat_mul(fixed_raw(dst), fixed_raw(vec), fixed_raw(mat), N, M, bias, add, EXPONENT);
+}
+
+template<typename T, int EXPONENT>
+inline void kernel_mat_mul_batch(FixedPointType<T, EXPONENT> * dst, const FixedPointType<T, EXPONENT> * vec, const FixedPointType<T, EXPONENT> * mat, size_t N, size_t M, size_t B, bool bias, bool add) {
+	for (size_t b = 0; b < B; b++)
+		kernel_fixed_mat_mul(fixed_raw(dst + b * M), fixed_raw(vec + b * N), fixed_raw(mat), N, M, bias, add, EXPONENT);
+}
+
+template<typename T, int EXPONENT>
+inline void kernel_convolve_1d(FixedPointType<T, EXPONENT> * dst, const FixedPointType<T, EXPONENT> * vec, const FixedPointType<T, EXPONENT> * kernel, size_t N, size_t M, size_t stride) {
+	const size_t dst_size = (N - M) / stride + 1;
+	T * d = fixed_raw(dst);
+	const T * v = fixed_raw(vec);
+
+	for (size_t i = 0; i < dst_size; i++, v += stride)
+		d[i] = fixed_narrow<T>(fixed_widen(d[i], EXPONENT) + kernel_fixed_dot(v, fixed_raw(kernel), M), EXPONENT);
+}
+
+template<typename T, int EXPONENT>
+inline void kernel_convolve_2d(FixedPointType<T, EXPONENT> * dst, const FixedPointType<T, EXPONENT> * mat, const FixedPointType<T, EXPONENT> * kernel, size_t N, size_t M, size_t K, size_t L, size_t stride) {
+	typedef typename fixed_wide<T>::type W;
+	const size_t MLS = (M - L) / stride + 1;
+	const size_t NKS = (N - K) / stride + 1;
+	T * d = fixed_raw(dst);
+
+	for (size_t b = 0; b < MLS; b++) {
+		const T * p = fixed_raw(mat) + (b * stride) * N;
+		for (size_t a = 0; a < NKS; a++, p += stride, ++d) {
+			W acc = fixed_widen(*d, EXPONENT);
+			for (size_t j = 0; j < L; j++)
+				acc += kernel_fixed_dot(p + j * N, fixed_raw(kernel) + j * K, K);
+			*d = fixed_narrow<T>(acc, EXPONENT);
+		}
+	}
+}
+
+template<typename T, int EXPONENT>
+inline void kernel_convolve_2d_multi(FixedPointType<T, EXPONENT> * dst, const FixedPointType<T, EXPONENT> * mat, const FixedPointType<T, EXPONENT> * kernel, size_t row, size_t N, size_t M, size_t C, size_t K, size_t L, size_t F, size_t stride) {
+	typedef typename fixed_wide<T>::type W;
+	const size_t MLS = (M - L) / stride + 1;
+	const size_t NKS = (N - K) / stride + 1;
+	const size_t channel = N * M;
+	T * d = fixed_raw(dst);
+
+	for (size_t f = 0; f < F; f++) {
+		const T * k0 = fixed_raw(kernel) + f * row;
+		for (size_t b = 0; b < MLS; b++) {
+			for (size_t a = 0; a < NKS; a++, ++d) {
+				const T * p = fixed_raw(mat) + b * stride * N + a * stride;
+				const T * k = k0;
+				W acc = 0;
+				for (size_t c = 0; c < C; c++, p += channel)
+					for (size_t j = 0; j < L; j++, k += K)
+						acc += kernel_fixed_dot(p + j * N, k, K);
+				*d = fixed_narrow<T>(acc, EXPONENT);
+			}
+		}
+	}
+}
+
+};
+
+#endif
@@ -0,0 +1,126 @@
+#if !defined(ENN_MVO_FUSED_H)
+#define ENN_MVO_FUSED_H
+
+#include <stdlib.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// Element-wise activations that the fused kernels can apply, see ActivationBase::fused()
+///
+enum ENN_FUSED_OP {
+	ENN_FUSED_NONE = 0,	// identity
+	ENN_FUSED_RELU,			// x > 0 ? x : param * x
+	ENN_FUSED_MATH,			// func(x) with accuracy, see ENN_MATH_FUNC
+};
+
+template<typename T>
+struct fused_activation {
+	ENN_FUSED_OP op;
+	ENN_MATH_FUNC func;
+	ENN_MATH_ACCURACY accuracy;
+	T param;
+};
+
+///
+/// The fused kernels compute ENN_FUSED_TILE outputs at a time and apply the activation
+/// (or its derivative) to them right away, while they are still in L1,
+/// instead of making separate passes over the whole output.
+/// The forward ReLU is applied in the store of each output instead, where the
+/// arch provides kernel_mat_mul_relu (x86_sse and NEON for float). The vectorized
+/// math functions need a whole vector of outputs, so they stay with the tiles.
+///
+#if !defined(ENN_FUSED_TILE)
+#define ENN_FUSED_TILE 64
+#endif
+
+/// DSTi = f(DSTi)
+template<typename T>
+inline void kernel_fused_forward(const fused_activation<T>& f, T * dst, size_t num) {
+	switch (f.op) {
+		case ENN_FUSED_NONE: break;
+		case ENN_FUSED_RELU: kernel_relu_arr(dst, dst, f.param, num); break;
+		case ENN_FUSED_MATH: kernel_math_arr(f.func, f.accuracy, dst, dst, num); break;
+	}
+}
+
+/// DELTASi *= f'(x), expressed by the outputs OUTPUTSi = f(x)
+template<typename T>
+inline void kernel_fused_backward(const fused_activation<T>& f, T * deltas, const T * outputs, size_t num) {
+	switch (f.op) {
+		case ENN_FUSED_NONE: break;
+		case ENN_FUSED_RELU:
+			for (size_t i = 0; i < num; i++)
+				deltas[i] = deltas[i] * (outputs[i] < 0 ? f.param : (T)1);
+			break;
+		case ENN_FUSED_MATH: kernel_math_grad_arr(f.func, f.accuracy, deltas, outputs, num); break;
+	}
+}
+
+/// DSTj = x > 0 ? x : NEGATIVE_D * x, x = SUMi VECi * MATij + MAT(N+1)j {if bias}, see kernel_mat_mul
+template<typename T>
+inline void kernel_mat_mul_relu(T * dst, const T * vec, const T * mat, size_t N, size_t M, bool bias, T negative_d) {
+	const size_t row = bias ? N + 1 : N;
+	for (size_t j = 0; j < M; j += ENN_FUSED_TILE) {
+		const size_t num = M - j < ENN_FUSED_TILE ? M - j : ENN_FUSED_TILE;
+		kernel_mat_mul(dst + j, vec, mat + j * row, N, num, bias, false);
+		kernel_relu_arr(dst + j, dst + j, negative_d, num);
+	}
+}
+
+/// DSTj = f(SUMi VECi * MATij + MAT(N+1)j {if bias}), see kernel_mat_mul
+template<typename T>
+inline void kernel_mat_mul_fused(T * dst, const T * vec, const T * mat, size_t N, size_t M, bool bias, const fused_activation<T>& f) {
+	const size_t row = bias ? N + 1 : N;
+	if (f.op == ENN_FUSED_NONE) {
+		kernel_mat_mul(dst, vec, mat, N, M, bias, false);
+		return;
+	}
+	if (f.op == ENN_FUSED_RELU) {
+		kernel_mat_mul_relu(dst, vec, mat, N, M, bias, f.param);
+		return;
+	}
+	for (size_t j = 0; j < M; j += ENN_FUSED_TILE) {
+		const size_t num = M - j < ENN_FUSED_TILE ? M - j : ENN_FUSED_TILE;
+		kernel_mat_mul(dst + j, vec, mat + j * row, N, num, bias, false);
+		kernel_fused_forward(f, dst + j, num);
+	}
+}
+
+///
+/// DELTASj *= f'(OUTPUTSj), then DSTi = SUMj DELTASj * MATij, see kernel_mat_mul_transposed.
+/// The scaled deltas are written back, since the weight update needs them as well.
+///
+template<typename T>
+inline void kernel_mat_mul_transposed_fused(T * dst, T * deltas, const T * outputs, const T * mat, size_t N, size_t M, bool bias, const fused_activation<T>& f) {
+	const size_t row = bias ? N + 1 : N;
+	if (M == 0) {
+		for (size_t i = 0; i < N; i++)
+			dst[i] = 0;
+	}
+	for (size_t j = 0; j < M; j += ENN_FUSED_TILE) {
+		const size_t num = M - j < ENN_FUSED_TILE ? M - j : ENN_FUSED_TILE;
+		kernel_fused_backward(f, deltas + j, outputs + j, num);
+		kernel_mat_mul_transposed(dst, deltas + j, mat + j * row, N, num, bias, j > 0);
+	}
+}
+
+///
+/// Public functions
+///
+
+/// DSTj = f(SUMi VECi * MATij + MAT(N+1)j {if BIAS=true}), the forward pass of a dense layer
+template<typename T, bool BIAS, typename T_SIZE>
+void mat_mul_fused(T * dst, const T * vec, const T * mat, T_SIZE N, T_SIZE M, const fused_activation<T>& f) {
+	kernel_mat_mul_fused(dst, vec, mat, N, M, BIAS, f);
+}
+
+/// DELTASj *= f'(OUTPUTSj), DSTi = SUMj DELTASj * MATij, the backward pass of a dense layer
+template<typename T, bool BIAS, typename T_SIZE>
+void mat_mul_transposed_fused(T * dst, T * deltas, const T * outputs, const T * mat, T_SIZE N, T_SIZE M, const fused_activation<T>& f) {
+	kernel_mat_mul_transposed_fused(dst, deltas, outputs, mat, N, M, BIAS, f);
+}
+
+};
+
+#endif
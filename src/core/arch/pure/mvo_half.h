@@ -0,0 +1,169 @@
+#if !defined(ENN_MVO_HALF_H)
+#define ENN_MVO_HALF_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "../../HalfFloatType.h"
+
+namespace EasyNeuralNetworks {
+
+///
+/// 16 bit floating point storage, see HalfFloatType.
+///
+/// Half precision weights with float inputs and outputs (hmat_mul, HalfWeightsDenseLayer and
+/// HalfWeightsLSTMLayer) halve the memory and the bandwidth of the weights of large layers:
+/// the weights are converted to float in the inner loop and the sums are accumulated in float.
+/// Tensors of half precision values (e.g. tensor<float16>) use the overloads below,
+/// which accumulate dot products in float and round to 16 bits once per output.
+///
+
+///
+/// Unit stride kernels. See mvo_array.h
+///
+
+/// DSTj = SUMi VECi * Hij + H(N+1)j {if bias}, half precision weights with the layout of kernel_mat_mul
+/// if add is true the result is added to DSTj
+template<typename T, typename H>
+inline void kernel_hmat_mul(T * dst, const T * vec, const H * mat, size_t N, size_t M, bool bias, bool add) {
+	const size_t row = bias ? N + 1 : N;
+	for (size_t j = 0; j < M; j++, mat += row) {
+		T acc = 0;
+		for (size_t i = 0; i < N; i++)
+			acc += vec[i] * (T)mat[i];
+		if (bias)
+			acc += (T)mat[N];
+		dst[j] = add ? dst[j] + acc : acc;
+	}
+}
+
+/// DSTj = f(SUMi VECi * Hij + H(N+1)j {if bias}), ENN_FUSED_TILE outputs at a time
+template<typename T, typename H>
+inline void kernel_hmat_mul_fused(T * dst, const T * vec, const H * mat, size_t N, size_t M, bool bias, const fused_activation<T>& f) {
+	const size_t row = bias ? N + 1 : N;
+	for (size_t j = 0; j < M; j += ENN_FUSED_TILE) {
+		const size_t num = M - j < ENN_FUSED_TILE ? M - j : ENN_FUSED_TILE;
+		kernel_hmat_mul(dst + j, vec, mat + j * row, N, num, bias, false);
+		kernel_fused_forward(f, dst + j, num);
+	}
+}
+
+/// SUMi Ai * Bi accumulated in float
+template<ENN_HALF FORMAT>
+inline float kernel_hdot(const HalfFloatType<FORMAT> * a, const HalfFloatType<FORMAT> * b, size_t num) {
+	float acc = 0;
+	for (size_t i = 0; i < num; i++)
+		acc += (float)a[i] * (float)b[i];
+	return acc;
+}
+
+///
+/// HalfFloatType overloads of the kernels in mvo_vector.h, mvo_matrix.h and mvo_conv.h
+///
+
+template<ENN_HALF FORMAT>
+inline HalfFloatType<FORMAT> kernel_dot_product(const HalfFloatType<FORMAT> * a, const HalfFloatType<FORMAT> * b, size_t num) {
+	return kernel_hdot(a, b, num);
+}
+
+template<ENN_HALF FORMAT>
+inline void kernel_mat_mul(HalfFloatType<FORMAT> * dst, const HalfFloatType<FORMAT> * vec, const HalfFloatType<FORMAT> * mat, size_t N, size_t M, bool bias, bool add) {
+	const size_t row = bias ? N + 1 : N;
+	for (size_t j = 0; j < M; j++, mat += row) {
+		float acc = kernel_hdot(vec, mat, N);
+		if (bias)
+			acc += (float)mat[N];
+		if (add)
+			acc += (float)dst[j];
+		dst[j] = acc;
+	}
+}
+
+template<ENN_HALF FORMAT>
+inline void kernel_mat_mul_batch(HalfFloatType<FORMAT> * dst, const HalfFloatType<FORMAT> * vec, const HalfFloatType<FORMAT> * mat, size_t N, size_t M, size_t B, bool bias, bool add) {
+	for (size_t b = 0; b < B; b++)
+		kernel_mat_mul(dst + b * M, vec + b * N, mat, N, M, bias, add);
+}
+
+template<ENN_HALF FORMAT>
+inline void kernel_convolve_1d(HalfFloatType<FORMAT> * dst, const HalfFloatType<FORMAT> * vec, const HalfFloatType<FORMAT> * kernel, size_t N, size_t M, size_t stride) {
+	const size_t dst_size = (N - M) / stride + 1;
+	for (size_t i = 0; i < dst_size; i++, vec += stride)
+		dst[i] = (float)dst[i] + kernel_hdot(vec, kernel, M);
+}
+
+template<ENN_HALF FORMAT>
+inline void kernel_convolve_2d(HalfFloatType<FORMAT> * dst, const HalfFloatType<FORMAT> * mat, const HalfFloatType<FORMAT> * kernel, size_t N, size_t M, size_t K, size_t L, size_t stride) {
+	const size_t MLS = (M - L) / stride + 1;
+	const size_t NKS = (N - K) / stride + 1;
+
+	for (size_t b = 0; b < MLS; b++) {
+		const HalfFloatType<FORMAT> * p = mat + (b * stride) * N;
+		for (size_t a = 0; a < NKS; a++, p += stride, ++dst) {
+			float acc = (float)*dst;
+			for (size_t j = 0; j < L; j++)
+				acc += kernel_hdot(p + j * N, kernel + j * K, K);
+			*dst = acc;
+		}
+	}
+}
+
+template<ENN_HALF FORMAT>
+inline void kernel_convolve_2d_multi(HalfFloatType<FORMAT> * dst, const HalfFloatType<FORMAT> * mat, const HalfFloatType<FORMAT> * kernel, size_t row, size_t N, size_t M, size_t C, size_t K, size_t L, size_t F, size_t stride) {
+	const size_t MLS = (M - L) / stride + 1;
+	const size_t NKS = (N - K) / stride + 1;
+	const size_t channel = N * M;
+
+	for (size_t f = 0; f < F; f++) {
+		for (size_t b = 0; b < MLS; b++) {
+			for (size_t a = 0; a < NKS; a++, ++dst) {
+				const HalfFloatType<FORMAT> * p = mat + b * stride * N + a * stride;
+				const HalfFloatType<FORMAT> * k = kernel + f * row;
+				float acc = 0;
+				for (size_t c = 0; c < C; c++, p += channel)
+					for (size_t j = 0; j < L; j++, k += K)
+						acc += kernel_hdot(p + j * N, k, K);
+				*dst = acc;
+			}
+		}
+	}
+}
+
+///
+/// Public functions
+///
+
+/// DSTi = SRCi rounded to half precision
+template<typename H, typename T_SIZE>
+void to_half_arr(H * dst, const float * src, T_SIZE num) {
+	for (T_SIZE i = 0; i < num; i++)
+		dst[i] = src[i];
+}
+
+/// DSTi = SRCi
+template<typename H, typename T_SIZE>
+void from_half_arr(float * dst, const H * src, T_SIZE num) {
+	for (T_SIZE i = 0; i < num; i++)
+		dst[i] = (float)src[i];
+}
+
+/// DSTj = SUMi VECi * MATij + MAT(N+1)j {if BIAS=true}, half precision weights with the layout of mat_mul
+template<typename T, typename H, bool BIAS, typename T_SIZE>
+void hmat_mul(T * dst, const T * vec, const H * mat, T_SIZE N, T_SIZE M) {
+	kernel_hmat_mul(dst, vec, mat, N, M, BIAS, false);
+}
+
+/// DSTj += SUMi VECi * MATij + MAT(N+1)j {if BIAS=true}
+template<typename T, typename H, bool BIAS, typename T_SIZE>
+void hmat_mul_add(T * dst, const T * vec, const H * mat, T_SIZE N, T_SIZE M) {
+	kernel_hmat_mul(dst, vec, mat, N, M, BIAS, true);
+}
+
+/// DSTj = f(SUMi VECi * MATij + MAT(N+1)j {if BIAS=true}), the forward pass of a dense layer with half precision weights
+template<typename T, typename H, bool BIAS, typename T_SIZE>
+void hmat_mul_fused(T * dst, const T * vec, const H * mat, T_SIZE N, T_SIZE M, const fused_activation<T>& f) {
+	kernel_hmat_mul_fused(dst, vec, mat, N, M, BIAS, f);
+}
+
+};
+
+#endif
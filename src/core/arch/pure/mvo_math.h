@@ -0,0 +1,249 @@
+#if !defined(ENN_MVO_MATH_H)
+#define ENN_MVO_MATH_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// Element-wise transcendental functions used by the activations
+///
+enum ENN_MATH_FUNC {
+	ENN_MATH_EXP = 0,		// e^x
+	ENN_MATH_TANH,			// tanh(x)
+	ENN_MATH_SIGMOID,		// 1 / (1 + e^-x)
+	ENN_MATH_SOFTPLUS,	// log(1 + e^x)
+};
+
+///
+/// Accuracy tiers of the transcendental functions.
+/// ENN_MATH_FAST and ENN_MATH_PRECISE are evaluated in single precision with a range
+/// reduction and a polynomial:
+///		ENN_MATH_FAST			- relative error of e^x below 2e-4, absolute error of tanh,
+///												sigmoid and softplus below 5e-4
+///		ENN_MATH_PRECISE	- errors below 5e-7, i.e. a few float ulps
+///		ENN_MATH_EXACT		- libm in double precision, same as the scalar forward()
+/// e^x saturates below ENN_MATH_EXP_MIN and above ENN_MATH_EXP_MAX, instead of
+/// flushing to zero or overflowing to infinity. NaNs are propagated.
+///
+enum ENN_MATH_ACCURACY {
+	ENN_MATH_FAST = 0,
+	ENN_MATH_PRECISE,
+	ENN_MATH_EXACT,
+};
+
+///
+/// Tier of the activations and bulk functions constructed without one. ENN_MATH_EXACT keeps
+/// apply_forward_inplace in agreement with the scalar forward(), define ENN_MATH_ACCURACY_DEFAULT
+/// to ENN_MATH_PRECISE or ENN_MATH_FAST to opt in to the vectorized approximations.
+///
+#if !defined(ENN_MATH_ACCURACY_DEFAULT)
+#define ENN_MATH_ACCURACY_DEFAULT ENN_MATH_EXACT
+#endif
+
+#define ENN_MATH_EXP_MIN -87.0f
+#define ENN_MATH_EXP_MAX 88.0f
+#define ENN_MATH_LOG2E 1.44269504f
+// ln(2) split in two, so that n * ENN_MATH_LN2_HI is exact for the n in range
+#define ENN_MATH_LN2_HI 0.693359375f
+#define ENN_MATH_LN2_LO -2.12194440e-4f
+
+///
+/// e^r = 1 + r + r^2 * P(r), |r| <= ln(2) / 2, minimax coefficients of P
+///
+#define ENN_MATH_EXP_C2 0.49999994f
+#define ENN_MATH_EXP_C3 0.166665211f
+#define ENN_MATH_EXP_C4 0.041668389f
+#define ENN_MATH_EXP_C5 0.00836871006f
+#define ENN_MATH_EXP_C6 0.00138146116f
+#define ENN_MATH_EXP_FAST_C2 0.503941119f
+#define ENN_MATH_EXP_FAST_C3 0.166628197f
+
+///
+/// log(1 + t) = 2 * atanh(u) = 2 * u * Q(u^2), u = t / (2 + t), 0 <= t <= 1, minimax coefficients of Q
+///
+#define ENN_MATH_LOG1P_C0 0.999999225f
+#define ENN_MATH_LOG1P_C1 0.333423197f
+#define ENN_MATH_LOG1P_C2 0.19717063f
+#define ENN_MATH_LOG1P_C3 0.175122023f
+#define ENN_MATH_LOG1P_FAST_C0 0.999122202f
+#define ENN_MATH_LOG1P_FAST_C1 0.363780826f
+
+///
+/// Scalar approximations, the SIMD versions in arch/simd/mvo_math.h follow the same steps
+///
+
+/// 2^n for integral n in [-126, 127], built from the exponent bits
+inline float math_pow2(int32_t n) {
+	const uint32_t bits = (uint32_t)(n + 127) << 23;
+	float p;
+	memcpy(&p, &bits, sizeof(p));
+	return p;
+}
+
+/// e^x = 2^n * e^r, n = round(x / ln(2)), NaN is returned as is
+template<bool PRECISE>
+inline float math_exp(float x) {
+	if (x != x)
+		return x;
+	x = x < ENN_MATH_EXP_MIN ? ENN_MATH_EXP_MIN : x;
+	x = x > ENN_MATH_EXP_MAX ? ENN_MATH_EXP_MAX : x;
+	const float t = x * ENN_MATH_LOG2E;
+	const int32_t i = (int32_t)(t < 0 ? t - 0.5f : t + 0.5f);
+	const float n = (float)i;
+	float r = x - n * ENN_MATH_LN2_HI;
+	r = r - n * ENN_MATH_LN2_LO;
+	float p;
+	if (PRECISE)
+		p = (((ENN_MATH_EXP_C6 * r + ENN_MATH_EXP_C5) * r + ENN_MATH_EXP_C4) * r + ENN_MATH_EXP_C3) * r + ENN_MATH_EXP_C2;
+	else
+		p = ENN_MATH_EXP_FAST_C3 * r + ENN_MATH_EXP_FAST_C2;
+	return (r * r * p + r + 1.0f) * math_pow2(i);
+}
+
+/// log(1 + t), 0 <= t <= 1
+template<bool PRECISE>
+inline float math_log1p(float t) {
+	const float u = t / (2.0f + t);
+	const float w = u * u;
+	float q;
+	if (PRECISE)
+		q = ((ENN_MATH_LOG1P_C3 * w + ENN_MATH_LOG1P_C2) * w + ENN_MATH_LOG1P_C1) * w + ENN_MATH_LOG1P_C0;
+	else
+		q = ENN_MATH_LOG1P_FAST_C1 * w + ENN_MATH_LOG1P_FAST_C0;
+	return 2.0f * u * q;
+}
+
+template<ENN_MATH_FUNC F, bool PRECISE>
+inline float math_func(float x) {
+	switch (F) {
+		case ENN_MATH_EXP: return math_exp<PRECISE>(x);
+		case ENN_MATH_TANH: return 1.0f - 2.0f / (math_exp<PRECISE>(2.0f * x) + 1.0f);
+		case ENN_MATH_SIGMOID: return 1.0f / (1.0f + math_exp<PRECISE>(-x));
+		// log(1 + e^x) = max(x, 0) + log(1 + e^-|x|)
+		case ENN_MATH_SOFTPLUS: return (x > 0 ? x : 0.0f) + math_log1p<PRECISE>(math_exp<PRECISE>(x > 0 ? -x : x));
+	}
+	return x;
+}
+
+template<ENN_MATH_FUNC F>
+inline double math_func_exact(double x) {
+	switch (F) {
+		case ENN_MATH_EXP: return exp(x);
+		case ENN_MATH_TANH: return tanh(x);
+		case ENN_MATH_SIGMOID: return 1.0 / (1.0 + exp(-x));
+		case ENN_MATH_SOFTPLUS: return (x > 0 ? x : 0.0) + log1p(exp(-fabs(x)));
+	}
+	return x;
+}
+
+/// DSTi = F(Ai) for any type convertible to float, see ENN_MATH_ACCURACY
+template<typename T, ENN_MATH_FUNC F>
+inline void math_func_arr(ENN_MATH_ACCURACY accuracy, T * dst, const T * a, size_t num) {
+	switch (accuracy) {
+		case ENN_MATH_FAST:
+			for (size_t i = 0; i < num; i++)
+				dst[i] = (T)math_func<F, false>((float)a[i]);
+			break;
+		case ENN_MATH_PRECISE:
+			for (size_t i = 0; i < num; i++)
+				dst[i] = (T)math_func<F, true>((float)a[i]);
+			break;
+		default:
+			for (size_t i = 0; i < num; i++)
+				dst[i] = (T)math_func_exact<F>((double)a[i]);
+	}
+}
+
+///
+/// Unit stride kernels, see mvo_array.h
+///
+
+/// DSTi = func(Ai)
+template<typename T>
+inline void kernel_math_arr(ENN_MATH_FUNC func, ENN_MATH_ACCURACY accuracy, T * dst, const T * a, size_t num) {
+	switch (func) {
+		case ENN_MATH_EXP: math_func_arr<T, ENN_MATH_EXP>(accuracy, dst, a, num); break;
+		case ENN_MATH_TANH: math_func_arr<T, ENN_MATH_TANH>(accuracy, dst, a, num); break;
+		case ENN_MATH_SIGMOID: math_func_arr<T, ENN_MATH_SIGMOID>(accuracy, dst, a, num); break;
+		case ENN_MATH_SOFTPLUS: math_func_arr<T, ENN_MATH_SOFTPLUS>(accuracy, dst, a, num); break;
+	}
+}
+
+///
+/// DSTi = DSTi * func'(x), where func'(x) is expressed by the output Ai = func(x):
+///		e^x: Ai, tanh: 1 - Ai^2, sigmoid: Ai * (1 - Ai), softplus: 1 - e^-Ai
+///
+template<typename T>
+inline void kernel_math_grad_arr(ENN_MATH_FUNC func, ENN_MATH_ACCURACY accuracy, T * dst, const T * a, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		const T y = a[i];
+		switch (func) {
+			case ENN_MATH_EXP: dst[i] = dst[i] * y; break;
+			case ENN_MATH_TANH: dst[i] = dst[i] * ((T)1 - y * y); break;
+			case ENN_MATH_SIGMOID: dst[i] = dst[i] * (y * ((T)1 - y)); break;
+			case ENN_MATH_SOFTPLUS:
+				dst[i] = dst[i] * (T)(accuracy == ENN_MATH_EXACT ? 1.0 - exp(-(double)y) :
+						accuracy == ENN_MATH_PRECISE ? 1.0f - math_exp<true>(-(float)y) : 1.0f - math_exp<false>(-(float)y));
+				break;
+		}
+	}
+}
+
+/// DSTi = Ai > 0 ? Ai : negative_d * Ai
+/// the product is only taken for Ai <= 0, so FixedPointType counts no underflows of the positive values
+/// (ENN_FIXED_POINT_STATS), float has branch free versions in the arch kernels
+template<typename T>
+inline void kernel_relu_arr(T * dst, const T * a, T negative_d, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		const T val = a[i];
+		dst[i] = val > 0 ? val : negative_d * val;
+	}
+}
+
+///
+/// Public functions
+///
+
+/// DSTi = e^SRCi
+template<typename T, typename T_SIZE>
+inline void exp_arr(T * dst, const T * src, T_SIZE num, ENN_MATH_ACCURACY accuracy = ENN_MATH_ACCURACY_DEFAULT) {
+	kernel_math_arr(ENN_MATH_EXP, accuracy, dst, src, num);
+}
+
+/// DSTi = tanh(SRCi)
+template<typename T, typename T_SIZE>
+inline void tanh_arr(T * dst, const T * src, T_SIZE num, ENN_MATH_ACCURACY accuracy = ENN_MATH_ACCURACY_DEFAULT) {
+	kernel_math_arr(ENN_MATH_TANH, accuracy, dst, src, num);
+}
+
+/// DSTi = 1 / (1 + e^-SRCi)
+template<typename T, typename T_SIZE>
+inline void sigmoid_arr(T * dst, const T * src, T_SIZE num, ENN_MATH_ACCURACY accuracy = ENN_MATH_ACCURACY_DEFAULT) {
+	kernel_math_arr(ENN_MATH_SIGMOID, accuracy, dst, src, num);
+}
+
+/// DSTi = log(1 + e^SRCi)
+template<typename T, typename T_SIZE>
+inline void softplus_arr(T * dst, const T * src, T_SIZE num, ENN_MATH_ACCURACY accuracy = ENN_MATH_ACCURACY_DEFAULT) {
+	kernel_math_arr(ENN_MATH_SOFTPLUS, accuracy, dst, src, num);
+}
+
+/// DSTi = max(SRCi, 0) + negative_d * min(SRCi, 0)
+template<typename T, typename T_SIZE>
+inline void relu_arr(T * dst, const T * src, T negative_d, T_SIZE num) {
+	kernel_relu_arr(dst, src, negative_d, num);
+}
+
+/// DELTASi *= func'(x), expressed by the outputs OUTPUTSi = func(x), see kernel_math_grad_arr
+template<typename T, typename T_SIZE>
+inline void math_grad_arr(ENN_MATH_FUNC func, T * deltas, const T * outputs, T_SIZE num, ENN_MATH_ACCURACY accuracy = ENN_MATH_ACCURACY_DEFAULT) {
+	kernel_math_grad_arr(func, accuracy, deltas, outputs, num);
+}
+
+};
+
+#endif
@@ -7,12 +7,301 @@
 
 namespace EasyNeuralNetworks {
 
+///
+/// Unit stride kernels. See mvo_array.h
+///
+
+/// DSTj = SUMi VECi * MATij + MAT(N+1)j {if bias=true}, MATij = mat[i + j * (N + bias)]
+/// if add is true the result is added to DSTj
+template<typename T>
+inline void kernel_mat_mul(T * dst, const T * vec, const T * mat, size_t N, size_t M, bool bias, bool add) {
+	T acc;
+	size_t i, j;
+	const T * v;
+
+	for (j = 0; j < M; j++) {
+		acc = 0;
+		for (i = 0, v = vec; i < N; i++) {
+			acc += *v * *mat;
+			++v;
+			++mat;
+		}
+		if (bias) {
+			acc += *mat;
+			++mat;
+		}
+		if (add)
+			*dst += acc;
+		else
+			*dst = acc;
+		++dst;
+	}
+}
+
+/// DSTi = SUMj VECj * MATij, MATij = mat[i + j * (N + bias)]
+/// if add is true the result is added to DSTi
+/// The matrix is streamed row by row, four rows per pass over the destination,
+/// instead of being walked along its columns.
+template<typename T>
+inline void kernel_mat_mul_transposed(T * dst, const T * vec, const T * mat, size_t N, size_t M, bool bias, bool add) {
+	const size_t row = bias ? N + 1 : N;
+	size_t i, j;
+
+	if (!add) {
+		for (i = 0; i < N; i++)
+			dst[i] = 0;
+	}
+
+	for (j = 0; j + 4 <= M; j += 4) {
+		const T * m0 = mat + j * row;
+		const T * m1 = m0 + row;
+		const T * m2 = m1 + row;
+		const T * m3 = m2 + row;
+		const T v0 = vec[j], v1 = vec[j + 1], v2 = vec[j + 2], v3 = vec[j + 3];
+		for (i = 0; i < N; i++) {
+			T acc = dst[i];
+			acc += v0 * m0[i];
+			acc += v1 * m1[i];
+			acc += v2 * m2[i];
+			acc += v3 * m3[i];
+			dst[i] = acc;
+		}
+	}
+
+	for (; j < M; j++) {
+		const T * m0 = mat + j * row;
+		const T v0 = vec[j];
+		for (i = 0; i < N; i++)
+			dst[i] += v0 * m0[i];
+	}
+}
+
+/// DST = SRC transposed, DSTyx = dst[y + x * height], SRCxy = src[x + y * width]
+/// The matrix is processed in ENN_TRANSPOSE_BLOCK x ENN_TRANSPOSE_BLOCK blocks to stay in cache.
+#if !defined(ENN_TRANSPOSE_BLOCK)
+#define ENN_TRANSPOSE_BLOCK 32
+#endif
+
+template<typename T>
+inline void kernel_mat_transpose(T * dst, const T * src, size_t width, size_t height) {
+	for (size_t y0 = 0; y0 < height; y0 += ENN_TRANSPOSE_BLOCK) {
+		const size_t y1 = y0 + ENN_TRANSPOSE_BLOCK < height ? y0 + ENN_TRANSPOSE_BLOCK : height;
+		for (size_t x0 = 0; x0 < width; x0 += ENN_TRANSPOSE_BLOCK) {
+			const size_t x1 = x0 + ENN_TRANSPOSE_BLOCK < width ? x0 + ENN_TRANSPOSE_BLOCK : width;
+			for (size_t y = y0; y < y1; y++)
+				for (size_t x = x0; x < x1; x++)
+					dst[y + x * height] = src[x + y * width];
+		}
+	}
+}
+
+///
+/// Blocked matrix-matrix multiplication used for batches of vectors.
+///
+/// C = A * B' where Ark = a[r * a_r + k * a_k], C is rows x cols (ldc) and
+/// B'kc = b[k * b_k + c * b_c], so that both the (N + bias, M) weight layout and its
+/// transpose, as well as transposed batches of vectors, can be used without copying.
+/// If ones is true A is extended with a column of ones, i.e. the row K of B' (the
+/// interleaved bias column) is added natively.
+///
+/// The loops are blocked for cache (ENN_GEMM_MC x ENN_GEMM_KC panels of A,
+/// ENN_GEMM_KC x ENN_GEMM_NC panels of B), panels are packed so that the micro-kernel
+/// reads both of them sequentially, and the micro-kernel KERNEL computes
+/// a KERNEL::mr x KERNEL::nr block of C in registers.
+///
+#if !defined(ENN_GEMM_MC)
+#define ENN_GEMM_MC 64
+#endif
+
+#if !defined(ENN_GEMM_KC)
+#define ENN_GEMM_KC 256
+#endif
+
+#if !defined(ENN_GEMM_NC)
+#define ENN_GEMM_NC 512
+#endif
+
+inline size_t gemm_min(size_t a, size_t b) { return a < b ? a : b; }
+
+///
+/// packing panels of gemm_blocked, kept between the calls and grown only when a larger problem
+/// needs them, so at most (ENN_GEMM_MC + ENN_GEMM_NC) * ENN_GEMM_KC values per type.
+/// NOTE: not thread safe.
+///
+template<typename T>
+inline T * gemm_scratch(size_t size) {
+	static T * buffer = 0;
+	static size_t capacity = 0;
+	if (size > capacity) {
+		delete[] buffer;
+		buffer = new T[size];
+		capacity = size;
+	}
+	return buffer;
+}
+
+/// generic register-tiled micro-kernel: C (+)= SUMk Ak * Bk over packed panels,
+/// A is packed as kc x MR, B as kc x NR
+template<typename T, size_t MR, size_t NR>
+struct gemm_kernel {
+	static const size_t mr = MR;
+	static const size_t nr = NR;
+
+	static void run(size_t kc, const T * a, const T * b, T * c, size_t ldc, bool add) {
+		T acc[MR][NR];
+		size_t i, j;
+		for (i = 0; i < MR; i++)
+			for (j = 0; j < NR; j++)
+				acc[i][j] = 0;
+		while (kc--) {
+			for (i = 0; i < MR; i++)
+				for (j = 0; j < NR; j++)
+					acc[i][j] += a[i] * b[j];
+			a += MR;
+			b += NR;
+		}
+		for (i = 0; i < MR; i++, c += ldc)
+			for (j = 0; j < NR; j++)
+				if (add)
+					c[j] += acc[i][j];
+				else
+					c[j] = acc[i][j];
+	}
+};
+
+/// packs mc rows of A starting at k0 into panels of MR rows, padded with zeroes
+template<typename T, size_t MR>
+inline void gemm_pack_a(T * dst, const T * a, size_t a_r, size_t a_k, size_t mc, size_t k0, size_t kc, size_t K) {
+	for (size_t p = 0; p < mc; p += MR) {
+		for (size_t k = k0; k < k0 + kc; k++) {
+			for (size_t r = 0; r < MR; r++)
+				*dst++ = p + r >= mc ? T(0) : k < K ? a[(p + r) * a_r + k * a_k] : T(1);
+		}
+	}
+}
+
+/// packs nc columns of B' starting at k0 into panels of NR columns, padded with zeroes
+template<typename T, size_t NR>
+inline void gemm_pack_b(T * dst, const T * b, size_t b_k, size_t b_c, size_t nc, size_t k0, size_t kc) {
+	for (size_t p = 0; p < nc; p += NR) {
+		for (size_t k = k0; k < k0 + kc; k++) {
+			const T * src = b + k * b_k + p * b_c;
+			for (size_t c = 0; c < NR; c++, src += b_c)
+				*dst++ = p + c >= nc ? T(0) : *src;
+		}
+	}
+}
+
+template<typename T, typename KERNEL>
+void gemm_blocked(T * c, const T * a, const T * b, size_t rows, size_t cols, size_t K, size_t a_r, size_t a_k, size_t ldc, size_t b_k, size_t b_c, bool ones, bool add) {
+	const size_t MR = KERNEL::mr;
+	const size_t NR = KERNEL::nr;
+	const size_t KT = ones ? K + 1 : K;
+	// block sizes rounded to the micro-kernel, but not larger than the problem
+	const size_t MC = gemm_min((rows + MR - 1) / MR * MR, (ENN_GEMM_MC + MR - 1) / MR * MR);
+	const size_t NC = gemm_min((cols + NR - 1) / NR * NR, (ENN_GEMM_NC + NR - 1) / NR * NR);
+	const size_t KC = gemm_min(KT, (size_t)ENN_GEMM_KC);
+	T * pa = gemm_scratch<T>(MC * KC + KC * NC);
+	T * pb = pa + MC * KC;
+	T tile[MR * NR];
+
+	if (KT == 0) {
+		for (size_t i = 0; !add && i < rows; i++)
+			for (size_t j = 0; j < cols; j++)
+				c[i * ldc + j] = 0;
+	}
+
+	for (size_t jc = 0; jc < cols; jc += NC) {
+		const size_t nc = gemm_min(NC, cols - jc);
+		for (size_t pc = 0; pc < KT; pc += KC) {
+			const size_t kc = gemm_min(KC, KT - pc);
+			const bool acc = add || pc > 0;
+			gemm_pack_b<T, NR>(pb, b + jc * b_c, b_k, b_c, nc, pc, kc);
+			for (size_t ic = 0; ic < rows; ic += MC) {
+				const size_t mc = gemm_min(MC, rows - ic);
+				gemm_pack_a<T, MR>(pa, a + ic * a_r, a_r, a_k, mc, pc, kc, K);
+				for (size_t jr = 0; jr < nc; jr += NR) {
+					for (size_t ir = 0; ir < mc; ir += MR) {
+						T * dst = c + (ic + ir) * ldc + jc + jr;
+						if (ir + MR <= mc && jr + NR <= nc) {
+							KERNEL::run(kc, pa + ir * kc, pb + jr * kc, dst, ldc, acc);
+							continue;
+						}
+						// partial block at the edges
+						KERNEL::run(kc, pa + ir * kc, pb + jr * kc, tile, NR, false);
+						for (size_t i = 0; i < MR && ir + i < mc; i++)
+							for (size_t j = 0; j < NR && jr + j < nc; j++)
+								if (acc)
+									dst[i * ldc + j] += tile[i * NR + j];
+								else
+									dst[i * ldc + j] = tile[i * NR + j];
+					}
+				}
+			}
+		}
+	}
+}
+
+/// adds the sums of B vectors of N to the bias column of the N x (M + 1) matrix
+template<typename T>
+inline void outer_product_batch_bias(T * dst, const T * u, size_t N, size_t M, size_t B) {
+	for (size_t i = 0; i < N; i++) {
+		T acc = 0;
+		for (size_t b = 0; b < B; b++)
+			acc += u[b * N + i];
+		dst[i * (M + 1) + M] += acc;
+	}
+}
+
+/// DSTbj = SUMi VECbi * MATij + MAT(N+1)j {if bias=true}, b < B, for B vectors of N
+/// stored one after another, DST is B vectors of M.
+/// if add is true the result is added to DSTbj
+template<typename T>
+inline void kernel_mat_mul_batch(T * dst, const T * vec, const T * mat, size_t N, size_t M, size_t B, bool bias, bool add) {
+	gemm_blocked<T, gemm_kernel<T, 4, 4> >(dst, vec, mat, B, M, N, N, 1, M, 1, bias ? N + 1 : N, bias, add);
+}
+
+/// DSTbi = SUMj VECbj * MATij, b < B, for B vectors of M, DST is B vectors of N
+/// if add is true the result is added to DSTbi
+template<typename T>
+inline void kernel_mat_mul_transposed_batch(T * dst, const T * vec, const T * mat, size_t N, size_t M, size_t B, bool bias, bool add) {
+	gemm_blocked<T, gemm_kernel<T, 4, 4> >(dst, vec, mat, B, N, M, M, 1, N, bias ? N + 1 : N, 1, false, add);
+}
+
+/// DSTij += SUMb Ubi * Vbj, DST(Mj)i += SUMb Ubi {if bias=true}, DSTij = dst[j + i * (M + bias)],
+/// for B vectors U of N and B vectors V of M stored one after another, i.e. B rank-1 updates at once
+template<typename T>
+inline void kernel_outer_product_batch(T * dst, const T * u, const T * v, size_t N, size_t M, size_t B, bool bias) {
+	gemm_blocked<T, gemm_kernel<T, 4, 4> >(dst, u, v, N, M, B, 1, N, bias ? M + 1 : M, M, 1, false, true);
+	if (bias)
+		outer_product_batch_bias(dst, u, N, M, B);
+}
+
+///
+/// Public matrix functions
+///
+
 template<typename T, typename T_SIZE>
 T min_mat(T_SIZE * index_x, T_SIZE * index_y, const T * a, T_SIZE in_width, T_SIZE width, T_SIZE height, T_SIZE stride = 1) {
-	T acc = std::numeric_limits<T>::infinity();
+	T acc = kernel_minmax_init(true, a, width * height);
 	T_SIZE x = 0, y = 0;
+	if (stride == 1) {
+		for (T_SIZE i = 0; i < height; i++) {
+			size_t idx;
+			T tmp = kernel_minmax_arr(true, &idx, a, width);
+			if (tmp < acc) {
+				acc = tmp;
+				x = idx;
+				y = i;
+			}
+			a += in_width;
+		}
+		*index_x = x;
+		*index_y = y;
+		return acc;
+	}
 	for (T_SIZE i = 0; i < height; i++) {
-		T * p = *a;
+		const T * p = a;
 		for (T_SIZE j = 0; j < width; j++) {
 			auto tmp = *p;
 			if (tmp < acc) {
@@ -31,10 +320,25 @@ T min_mat(T_SIZE * index_x, T_SIZE * index_y, const T * a, T_SIZE in_width, T_SI
 
 template<typename T, typename T_SIZE>
 T max_mat(T_SIZE * index_x, T_SIZE * index_y, const T * a, T_SIZE in_width, T_SIZE width, T_SIZE height, T_SIZE stride = 1) {
-	T acc = -std::numeric_limits<T>::infinity();
+	T acc = kernel_minmax_init(false, a, width * height);
 	T_SIZE x = 0, y = 0;
+	if (stride == 1) {
+		for (T_SIZE i = 0; i < height; i++) {
+			size_t idx;
+			T tmp = kernel_minmax_arr(false, &idx, a, width);
+			if (tmp > acc) {
+				acc = tmp;
+				x = idx;
+				y = i;
+			}
+			a += in_width;
+		}
+		*index_x = x;
+		*index_y = y;
+		return acc;
+	}
 	for (T_SIZE i = 0; i < height; i++) {
-		T * p = *a;
+		const T * p = a;
 		for (T_SIZE j = 0; j < width; j++) {
 			auto tmp = *p;
 			if (tmp > acc) {
@@ -53,16 +357,21 @@ T max_mat(T_SIZE * index_x, T_SIZE * index_y, const T * a, T_SIZE in_width, T_SI
 
 template<typename T, typename T_SIZE>
 T mean_mat(const T * a, T_SIZE in_width, T_SIZE width, T_SIZE height, T_SIZE stride = 1) {
-	T acc = 0;
+	typename kernel_accumulator<T>::type acc = 0;
 	for (T_SIZE i = 0; i < height; i++) {
-		T * p = *a;
+		if (stride == 1 && !std::numeric_limits<T>::is_integer) {
+			acc += kernel_sum_arr(a, width);
+			a += in_width;
+			continue;
+		}
+		const T * p = a;
 		for (T_SIZE j = 0; j < width; j++) {
 			acc += *p;
 			p += stride;
 		}
 		a += in_width;
 	}
-	return acc / (T)(width * height);
+	return kernel_mean_div<T>(acc, (size_t)width * height);
 }
 
 template<typename T, bool BIAS, typename T_SIZE, bool TRANSPOSED>
@@ -71,44 +380,12 @@ void mat_mul(T * dst, const T * vec, const T * mat, T_SIZE N, T_SIZE M) {
 	// matrix is NxM
 	// destination is M
 	// MATij = mat[i + j * (N + BIAS)]
-	T acc;
-	T_SIZE i, j;
-	const T * v;
-
 	if (!TRANSPOSED) {
 		// DSTj = SUMi VECi * MATij + MAT(N+1)j {if BIAS=true}
-		for (j = 0; j < M; j++) {
-			acc = 0;
-			for (i = 0, v = vec; i < N; i++) {
-				acc += *v * *mat;
-				++v;
-				++mat;
-			}
-			if (BIAS) {
-				acc += *mat;
-				++mat;
-			}
-			*dst = acc;
-			++dst;
-		}
+		kernel_mat_mul(dst, vec, mat, N, M, BIAS, false);
 	} else {
 		// DSTj = SUMi VECi * MATji
-		const T * m;
-
-		for (j = 0; j < N; j++) {
-			acc = 0;
-			m = mat + j;
-			for (i = 0, v = vec; i < M; i++) {
-				acc += *v * *m;
-				++v;
-				if (BIAS)
-					m += N + 1;
-				else
-					m += N;
-			}
-			*dst = acc;
-			++dst;
-		}
+		kernel_mat_mul_transposed(dst, vec, mat, N, M, BIAS, false);
 	}
 }
 
@@ -118,58 +395,60 @@ void mat_mul_add(T * dst, const T * vec, const T * mat, T_SIZE N, T_SIZE M) {
 	// matrix is NxM
 	// destination is M
 	// MATij = mat[i + j * (N + BIAS)]
-	T acc;
-	T_SIZE i, j;
-	const T * v;
-
 	if (!TRANSPOSED) {
-		// DSTj = SUMi VECi * MATij + MAT(N+1)j {if BIAS=true}
-		for (j = 0; j < M; j++) {
-			acc = 0;
-			for (i = 0, v = vec; i < N; i++) {
-				acc += *v * *mat;
-				++v;
-				++mat;
-			}
-			if (BIAS) {
-				acc += *mat;
-				++mat;
-			}
-			*dst += acc;
-			++dst;
-		}
+		// DSTj += SUMi VECi * MATij + MAT(N+1)j {if BIAS=true}
+		kernel_mat_mul(dst, vec, mat, N, M, BIAS, true);
 	} else {
-		// DSTj = SUMi VECi * MATji
-		const T * m;
-
-		for (j = 0; j < N; j++) {
-			acc = 0;
-			m = mat + j;
-			for (i = 0, v = vec; i < M; i++) {
-				acc += *v * *m;
-				++v;
-				if (BIAS)
-					m += N + 1;
-				else
-					m += N;
-			}
-			*dst += acc;
-			++dst;
-		}
+		// DSTj += SUMi VECi * MATji
+		kernel_mat_mul_transposed(dst, vec, mat, N, M, BIAS, true);
+	}
+}
+
+///
+/// Same as mat_mul, but for B vectors at once, e.g. a batch of samples.
+/// Vectors are stored one after another (B x N, or B x M if TRANSPOSED),
+/// as are the results (B x M, or B x N if TRANSPOSED).
+/// The weight matrix is read once per block of vectors instead of once per vector.
+///
+template<typename T, bool BIAS, typename T_SIZE, bool TRANSPOSED>
+void mat_mul_batch(T * dst, const T * vec, const T * mat, T_SIZE N, T_SIZE M, T_SIZE B) {
+	if (B == 1) {
+		mat_mul<T, BIAS, T_SIZE, TRANSPOSED>(dst, vec, mat, N, M);
+	} else if (!TRANSPOSED) {
+		kernel_mat_mul_batch(dst, vec, mat, N, M, B, BIAS, false);
+	} else {
+		kernel_mat_mul_transposed_batch(dst, vec, mat, N, M, B, BIAS, false);
+	}
+}
+
+template<typename T, bool BIAS, typename T_SIZE, bool TRANSPOSED>
+void mat_mul_batch_add(T * dst, const T * vec, const T * mat, T_SIZE N, T_SIZE M, T_SIZE B) {
+	if (B == 1) {
+		mat_mul_add<T, BIAS, T_SIZE, TRANSPOSED>(dst, vec, mat, N, M);
+	} else if (!TRANSPOSED) {
+		kernel_mat_mul_batch(dst, vec, mat, N, M, B, BIAS, true);
+	} else {
+		kernel_mat_mul_transposed_batch(dst, vec, mat, N, M, B, BIAS, true);
 	}
 }
 
+///
+/// Same as outer_product_add, but for B pairs of vectors at once (B x N and B x M, stored one
+/// after another), i.e. a rank-B update of the weights. DST is read and written once instead
+/// of B times.
+///
+template<typename T, bool BIAS, typename T_SIZE>
+void outer_product_batch_add(T * dst, const T * u, const T * v, T_SIZE N, T_SIZE M, T_SIZE B) {
+	if (B == 1)
+		outer_product_add_const<T, BIAS, T_SIZE>(dst, u, v, N, M, T(1));
+	else
+		kernel_outer_product_batch(dst, u, v, N, M, B, BIAS);
+}
+
+/// DST (height x width) = SRC (width x height) transposed
 template<typename T, typename T_SIZE>
 void mat_transpose(T * dst, const T * src, T_SIZE width, T_SIZE height) {
-	T_SIZE x = 0, y = 0;
-	for (T_SIZE i = 0; i < height; i++) {
-		T * p = dst + height;
-		for (T_SIZE j = 0; j < width; j++) {
-			*p += *src;
-			++src;
-			p += width;
-		}
-	}
+	kernel_mat_transpose(dst, src, width, height);
 }
 
 };
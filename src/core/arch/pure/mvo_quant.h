@@ -0,0 +1,320 @@
+#if !defined(ENN_MVO_QUANT_H)
+#define ENN_MVO_QUANT_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// int8 quantization, see the quantized layers (e.g. QuantizedDenseLayer).
+///
+/// A real value x is represented by q = round(x / scale) + zero_point, q in [-128, 127].
+/// Weights are quantized symmetrically (zero_point = 0) with a scale per output channel,
+/// activations with a scale and a zero point per tensor. Products of int8 values are
+/// accumulated in int32 and the sums are scaled back to int8 with integer arithmetic only
+/// (see requantize), hence the results are bit exact on every architecture.
+///
+
+/// real = scale * (q - zero_point)
+struct quant_params {
+	float scale;
+	int32_t zero_point;
+};
+
+/// real multiplier = multiplier * 2^(shift - 31), multiplier in [2^30, 2^31)
+struct quant_multiplier {
+	int32_t multiplier;
+	int32_t shift;
+};
+
+/// per output channel constants of the quantized layers
+struct quant_channel {
+	int32_t bias;			// quantized bias - input zero point * SUM of the quantized weights of the channel
+	quant_multiplier scale;	// input scale * weight scale / output scale
+};
+
+///
+/// Output stage of the quantized layers, the activation is fused into the requantization:
+///		q = min(max(requantize(acc + bias) + zero_point, min), max)
+/// followed by q = table[q + 128] if there is a table (256 values).
+/// If negative.multiplier is not 0, values below the zero point are scaled by it before the clamp.
+/// E.g. ReLU is a clamp at the zero point, leaky ReLU a clamp with its slope as the negative
+/// multiplier, sigmoid or tanh are tables.
+///
+struct quant_output {
+	int32_t zero_point;
+	int32_t min;
+	int32_t max;
+	const int8_t * table;
+	quant_multiplier negative;
+};
+
+/// outputs of the quantized layers are computed ENN_QUANT_TILE at a time into an int32 buffer on the stack
+#if !defined(ENN_QUANT_TILE)
+#define ENN_QUANT_TILE 64
+#endif
+
+/// parameters covering [min, max], the range is extended to include 0, so that 0 is exact
+inline quant_params quant_params_from_range(float min, float max) {
+	quant_params p;
+	min = min < 0 ? min : 0;
+	max = max > 0 ? max : 0;
+	p.scale = max > min ? (max - min) / 255.0f : 1.0f;
+	const float zero = -128.0f - min / p.scale;
+	p.zero_point = (int32_t)(zero < 0 ? zero - 0.5f : zero + 0.5f);
+	p.zero_point = p.zero_point < -128 ? -128 : p.zero_point > 127 ? 127 : p.zero_point;
+	return p;
+}
+
+/// q = round(x / scale) + zero_point, saturated
+inline int8_t quantize(float x, const quant_params& p) {
+	float q = x / p.scale + p.zero_point;
+	q = q < -128.0f ? -128.0f : q > 127.0f ? 127.0f : q;
+	return (int8_t)(int32_t)(q < 0 ? q - 0.5f : q + 0.5f);
+}
+
+inline float dequantize(int8_t q, const quant_params& p) {
+	return p.scale * (float)(q - p.zero_point);
+}
+
+/// m = multiplier * 2^(shift - 31), m > 0
+inline quant_multiplier quant_multiplier_from(double m) {
+	quant_multiplier r;
+	int e = 0;
+	const double f = frexp(m, &e);
+	int64_t q = (int64_t)(f * 2147483648.0 + 0.5);
+	if (q == ((int64_t)1 << 31)) {
+		q >>= 1;
+		e++;
+	}
+	r.multiplier = (int32_t)q;
+	r.shift = e;
+	return r;
+}
+
+/// round(x * m), rounds half up
+inline int32_t requantize(int32_t x, quant_multiplier m) {
+	const int s = 31 - m.shift;
+	const int64_t p = (int64_t)x * m.multiplier;
+	if (s <= 0)
+		return (int32_t)(p * ((int64_t)1 << -s));
+	if (s > 62)
+		return 0;
+	return (int32_t)((p + ((int64_t)1 << (s - 1))) >> s);
+}
+
+/// output stage of a single value, see quant_output
+inline int8_t requantize(int32_t acc, const quant_channel& channel, const quant_output& out) {
+	int32_t q = requantize(acc + channel.bias, channel.scale);
+	if (q < 0 && out.negative.multiplier)
+		q = requantize(q, out.negative);
+	q += out.zero_point;
+	q = q < out.min ? out.min : q > out.max ? out.max : q;
+	return out.table ? out.table[q + 128] : (int8_t)q;
+}
+
+///
+/// Unit stride kernels, see mvo_array.h.
+/// Architecture specific headers provide explicit specializations of kernel_qmat_mul for int8_t.
+///
+
+/// DSTj = SUMi VECi * MATij, i < N, j < M. Rows of the matrix are N values (there is no bias column)
+template<typename T>
+inline void kernel_qmat_mul(int32_t * dst, const T * vec, const T * mat, size_t N, size_t M) {
+	for (size_t j = 0; j < M; j++, mat += N) {
+		int32_t acc = 0;
+		for (size_t i = 0; i < N; i++)
+			acc += (int32_t)vec[i] * (int32_t)mat[i];
+		dst[j] = acc;
+	}
+}
+
+/// DST(j * dst_stride) = output(ACCj, CHANNELSj), see quant_output
+template<typename T>
+inline void kernel_requantize(T * dst, size_t dst_stride, const int32_t * acc, const quant_channel * channels, const quant_output& out, size_t num) {
+	for (size_t j = 0; j < num; j++, dst += dst_stride)
+		*dst = requantize(acc[j], channels[j], out);
+}
+
+/// DST(j * dst_stride) = output(SUMi VECi * MATij, CHANNELSj), the int32 sums are computed ENN_QUANT_TILE at a time
+template<typename T>
+inline void kernel_qmat_mul_requantize(T * dst, size_t dst_stride, const T * vec, const T * mat, const quant_channel * channels, size_t N, size_t M, const quant_output& out) {
+	int32_t acc[ENN_QUANT_TILE];
+	for (size_t j = 0; j < M; j += ENN_QUANT_TILE) {
+		const size_t num = M - j < ENN_QUANT_TILE ? M - j : ENN_QUANT_TILE;
+		kernel_qmat_mul(acc, vec, mat + j * N, N, num);
+		kernel_requantize(dst + j * dst_stride, dst_stride, acc, channels + j, out, num);
+	}
+}
+
+///
+/// Weight-only quantization, see QuantizedWeightsDenseLayer.
+///
+/// The weights are stored as int8 or int4 values with a float scale per row, the activations stay float:
+///		DSTj = SCALEj * SUMi VECi * Qij + BIASj
+/// the values are converted to float in the inner loop, the scale is applied once per row.
+/// int4 rows are packed two values per byte: byte k of a row holds value k in the low nibble and
+/// value k + (N + 1) / 2 in the high nibble, so that both halves are consecutive values.
+///
+enum ENN_WQUANT {
+	ENN_WQUANT_INT8 = 8,
+	ENN_WQUANT_INT4 = 4,
+};
+
+/// bytes of a row of N quantized weights
+inline size_t wquant_row_bytes(ENN_WQUANT bits, size_t N) {
+	return bits == ENN_WQUANT_INT4 ? (N + 1) / 2 : N;
+}
+
+/// largest quantized value, the values are symmetric in [-max, max]
+inline int32_t wquant_max(ENN_WQUANT bits) {
+	return bits == ENN_WQUANT_INT4 ? 7 : 127;
+}
+
+/// DSTj = SUMi VECi * Qij, i < N, j < M. Rows of the matrix are N int8 values
+template<typename T>
+inline void kernel_wmat_mul_i8(T * dst, const T * vec, const int8_t * mat, size_t N, size_t M) {
+	for (size_t j = 0; j < M; j++, mat += N) {
+		T acc = 0;
+		for (size_t i = 0; i < N; i++)
+			acc += vec[i] * (T)mat[i];
+		dst[j] = acc;
+	}
+}
+
+/// DSTj = SUMi VECi * Qij, i < N, j < M. Rows of the matrix are (N + 1) / 2 bytes of packed int4 values
+template<typename T>
+inline void kernel_wmat_mul_i4(T * dst, const T * vec, const uint8_t * mat, size_t N, size_t M) {
+	const size_t half = (N + 1) / 2;
+	for (size_t j = 0; j < M; j++, mat += half) {
+		T acc = 0;
+		for (size_t k = 0; k < N - half; k++) {
+			acc += vec[k] * (T)((int8_t)(mat[k] << 4) >> 4);
+			acc += vec[k + half] * (T)((int8_t)mat[k] >> 4);
+		}
+		if (N & 1)
+			acc += vec[half - 1] * (T)((int8_t)(mat[half - 1] << 4) >> 4);
+		dst[j] = acc;
+	}
+}
+
+/// DSTj = f(SCALEj * SUMi VECi * Qij + BIASj {if bias}), ENN_FUSED_TILE outputs at a time
+template<typename T>
+inline void kernel_wmat_mul_fused(T * dst, const T * vec, const void * mat, ENN_WQUANT bits, const T * scales, const T * bias, size_t N, size_t M, const fused_activation<T>& f) {
+	const size_t row = wquant_row_bytes(bits, N);
+	for (size_t j = 0; j < M; j += ENN_FUSED_TILE) {
+		const size_t num = M - j < ENN_FUSED_TILE ? M - j : ENN_FUSED_TILE;
+		const uint8_t * m = (const uint8_t *)mat + j * row;
+		if (bits == ENN_WQUANT_INT4)
+			kernel_wmat_mul_i4(dst + j, vec, m, N, num);
+		else
+			kernel_wmat_mul_i8(dst + j, vec, (const int8_t *)m, N, num);
+		for (size_t k = 0; k < num; k++)
+			dst[j + k] = bias ? dst[j + k] * scales[j + k] + bias[j + k] : dst[j + k] * scales[j + k];
+		kernel_fused_forward(f, dst + j, num);
+	}
+}
+
+///
+/// Public functions
+///
+
+/// DSTi = quantize(SRCi)
+template<typename T_SIZE>
+void quantize_arr(int8_t * dst, const float * src, const quant_params& p, T_SIZE num) {
+	for (T_SIZE i = 0; i < num; i++)
+		dst[i] = quantize(src[i], p);
+}
+
+/// DSTi = dequantize(SRCi)
+template<typename T_SIZE>
+void dequantize_arr(float * dst, const int8_t * src, const quant_params& p, T_SIZE num) {
+	for (T_SIZE i = 0; i < num; i++)
+		dst[i] = dequantize(src[i], p);
+}
+
+///
+/// quantizes M rows of N float weights to BITS, MAT(row + j * ld_mat) is the first weight of row j,
+/// DST holds wquant_row_bytes(BITS, N) bytes per row and SCALESj = max|MATij| / wquant_max(BITS)
+///
+template<typename T_SIZE>
+void wquantize_mat(void * dst, float * scales, const float * mat, size_t ld_mat, ENN_WQUANT bits, T_SIZE N, T_SIZE M) {
+	const size_t row = wquant_row_bytes(bits, N);
+	const size_t half = (N + 1) / 2;
+	const int32_t qmax = wquant_max(bits);
+	for (T_SIZE j = 0; j < M; j++, mat += ld_mat) {
+		float absmax = 0;
+		for (T_SIZE i = 0; i < N; i++)
+			absmax = fabsf(mat[i]) > absmax ? fabsf(mat[i]) : absmax;
+		quant_params p;
+		p.scale = absmax > 0 ? absmax / qmax : 1.0f;
+		p.zero_point = 0;
+		scales[j] = p.scale;
+
+		if (bits == ENN_WQUANT_INT4) {
+			uint8_t * d = (uint8_t *)dst + j * row;
+			for (size_t k = 0; k < half; k++) {
+				const int32_t lo = quantize(mat[k], p);
+				const int32_t hi = k + half < N ? quantize(mat[k + half], p) : 0;
+				d[k] = (uint8_t)((lo & 0x0f) | ((hi & 0x0f) << 4));
+			}
+		} else {
+			int8_t * d = (int8_t *)dst + j * row;
+			for (T_SIZE i = 0; i < N; i++)
+				d[i] = quantize(mat[i], p);
+		}
+	}
+}
+
+/// DSTj = f(SCALEj * SUMi VECi * Qij + BIASj {if BIAS=true}), the forward pass of a dense layer with quantized weights
+template<typename T, bool BIAS, typename T_SIZE>
+void wmat_mul_fused(T * dst, const T * vec, const void * mat, ENN_WQUANT bits, const T * scales, const T * bias, T_SIZE N, T_SIZE M, const fused_activation<T>& f) {
+	kernel_wmat_mul_fused(dst, vec, mat, bits, scales, BIAS ? bias : (const T *)NULL, N, M, f);
+}
+
+/// DSTj = SUMi VECi * MATij, int32 sums of int8 products
+template<typename T, typename T_SIZE>
+void qmat_mul(int32_t * dst, const T * vec, const T * mat, T_SIZE N, T_SIZE M) {
+	kernel_qmat_mul(dst, vec, mat, N, M);
+}
+
+/// DSTj = output(SUMi VECi * MATij, CHANNELSj), the forward pass of a quantized dense layer
+template<typename T, typename T_SIZE>
+void qmat_mul_requantize(T * dst, const T * vec, const T * mat, const quant_channel * channels, T_SIZE N, T_SIZE M, const quant_output& out) {
+	kernel_qmat_mul_requantize(dst, 1, vec, mat, channels, N, M, out);
+}
+
+///
+/// The forward pass of a quantized convolution of NxM x C channels with F kernels of KxL x C,
+/// stored as F rows of K * L * C values. DST is P x F, where P is the number of outputs per kernel.
+/// The input patch of each output (see im2row_2d) is gathered into PATCH (K * L * C values)
+/// and multiplied with all the kernels at once, so that no patch matrix is needed.
+///
+template<typename T, typename T_SIZE>
+void qconvolve_2d(T * dst, const T * mat, const T * kernels, const quant_channel * channels, T * patch, T_SIZE N, T_SIZE M, T_SIZE C, T_SIZE K, T_SIZE L, T_SIZE F, T_SIZE stride, const quant_output& out) {
+	const size_t MLS = (M - L) / stride + 1;
+	const size_t NKS = (N - K) / stride + 1;
+	const size_t P = MLS * NKS;
+	const size_t row = (size_t)K * L * C;
+	const size_t channel = (size_t)N * M;
+
+	for (size_t b = 0; b < MLS; b++) {
+		for (size_t a = 0; a < NKS; a++) {
+			const T * p = mat + (b * stride) * N + a * stride;
+			T * d = patch;
+			for (size_t c = 0; c < C; c++, p += channel) {
+				const T * r = p;
+				for (size_t j = 0; j < L; j++, r += N)
+					for (size_t i = 0; i < K; i++)
+						*d++ = r[i];
+			}
+			kernel_qmat_mul_requantize(dst + a + b * NKS, P, patch, kernels, channels, row, F, out);
+		}
+	}
+}
+
+};
+
+#endif
@@ -7,8 +7,32 @@
 
 namespace EasyNeuralNetworks {
 
+///
+/// Unit stride kernels. See mvo_array.h
+///
+
+/// SUMi Ai * Bi
+template<typename T>
+inline T kernel_dot_product(const T * a, const T * b, size_t num) {
+	T acc = 0;
+	while (num--) {
+		acc += *a * *b;
+		++a;
+		++b;
+	}
+	return acc;
+}
+
+///
+/// Public vector functions
+///
+
 template<typename T, typename T_SIZE>
 inline void hadamard_product(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE stridea = 1, T_SIZE strideb = 1) {
+	if (stridea == 1 && strideb == 1) {
+		kernel_arr_binary(ENN_ARR_MUL, false, dst, a, b, num);
+		return;
+	}
 	while (num--) {
 		*dst = *a * *b;
 		a += stridea;
@@ -19,6 +43,10 @@ inline void hadamard_product(T * dst, const T * a, const T * b, T_SIZE num, T_SI
 
 template<typename T, typename T_SIZE>
 inline void hadamard_product_add(T * dst, const T * a, const T * b, T_SIZE num, T_SIZE stridea = 1, T_SIZE strideb = 1) {
+	if (stridea == 1 && strideb == 1) {
+		kernel_arr_binary(ENN_ARR_MUL, true, dst, a, b, num);
+		return;
+	}
 	while (num--) {
 		*dst += *a * *b;
 		a += stridea;
@@ -30,6 +58,10 @@ inline void hadamard_product_add(T * dst, const T * a, const T * b, T_SIZE num,
 template<typename T, typename T_SIZE>
 inline void normalize_vec(T * dst, T_SIZE num, T_SIZE stride) {
 	T sum = sqrt(sqrsum_arr(dst, num, stride));
+	if (stride == 1) {
+		kernel_arr_const(ENN_ARR_DIV, false, dst, dst, sum, num);
+		return;
+	}
 	while (num--) {
 		*dst /= sum;
 		dst += stride;
@@ -39,6 +71,8 @@ inline void normalize_vec(T * dst, T_SIZE num, T_SIZE stride) {
 // dot product of two vectors
 template<typename T, typename T_SIZE>
 inline T dot_product(const T * a, const T * b, T_SIZE num, T_SIZE stridea = 1, T_SIZE strideb = 1) {
+	if (stridea == 1 && strideb == 1)
+		return kernel_dot_product(a, b, num);
 	T acc = 0;
 	while (num--) {
 		acc += *a * *b;
@@ -69,15 +103,9 @@ inline T dot_product_2d(const T * a, const T * b, T_SIZE N, T_SIZE M, T_SIZE K,
 ///
 template<typename T, bool BIAS, typename T_SIZE>
 inline void outer_product(T * dst, const T * u, const T * v, T_SIZE N, T_SIZE M) {
-	const T * bp;
-
 	for (T_SIZE i = 0; i < N; i++) {
-		bp = v;
-		for (T_SIZE j = 0; j < M; j++) {
-				*dst = *u * *bp;
-				++bp;
-				++dst;
-		}
+		kernel_arr_const(ENN_ARR_MUL, false, dst, v, *u, M);
+		dst += M;
 		// update bias
 		if (BIAS) {
 			*dst = *u;
@@ -89,15 +117,9 @@ inline void outer_product(T * dst, const T * u, const T * v, T_SIZE N, T_SIZE M)
 
 template<typename T, bool BIAS, typename T_SIZE>
 inline void outer_product_const(T * dst, const T * u, const T * v, T_SIZE N, T_SIZE M, T alpha) {
-	const T * bp;
-
 	for (T_SIZE i = 0; i < N; i++) {
-		bp = v;
-		for (T_SIZE j = 0; j < M; j++) {
-				*dst = alpha * *u * *bp;
-				++bp;
-				++dst;
-		}
+		kernel_arr_const(ENN_ARR_MUL, false, dst, v, (T)(alpha * *u), M);
+		dst += M;
 		// update bias
 		if (BIAS) {
 			*dst = alpha * *u;
@@ -109,15 +131,9 @@ inline void outer_product_const(T * dst, const T * u, const T * v, T_SIZE N, T_S
 
 template<typename T, bool BIAS, typename T_SIZE>
 inline void outer_product_add_const(T * dst, const T * u, const T * v, T_SIZE N, T_SIZE M, T alpha) {
-	const T * bp;
-
 	for (T_SIZE i = 0; i < N; i++) {
-		bp = v;
-		for (T_SIZE j = 0; j < M; j++) {
-				*dst += alpha * *u * *bp;
-				++bp;
-				++dst;
-		}
+		kernel_arr_const(ENN_ARR_MUL, true, dst, v, (T)(alpha * *u), M);
+		dst += M;
 		// update bias
 		if (BIAS) {
 			*dst += alpha * *u;
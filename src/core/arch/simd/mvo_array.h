@@ -0,0 +1,250 @@
+///
+/// SIMD array kernels.
+/// Kernels are written against an operation set (see mvo_ops.h) and are shared
+/// by the architectures with vector units (arch/x86_sse, arch/neon).
+/// NOTE: this file has no include guard, it is included by the architecture mvo_kernels.h
+/// once for every instruction set inside that instruction set namespace (and target region).
+///
+
+template<typename OPS, ENN_ARR_OP OP>
+inline typename OPS::vf arr_op(typename OPS::vf a, typename OPS::vf b) {
+	switch (OP) {
+		case ENN_ARR_SUM: return OPS::add(a, b);
+		case ENN_ARR_DIFF: return OPS::sub(a, b);
+		case ENN_ARR_MUL: return OPS::mul(a, b);
+		case ENN_ARR_DIV: return OPS::div(a, b);
+		case ENN_ARR_SUMSQR: a = OPS::add(a, b); return OPS::mul(a, a);
+		case ENN_ARR_DIFFSQR: a = OPS::sub(a, b); return OPS::mul(a, a);
+		case ENN_ARR_SQRSUM: return OPS::madd(a, a, OPS::mul(b, b));
+		case ENN_ARR_SQRDIFF: return OPS::sub(OPS::mul(a, a), OPS::mul(b, b));
+	}
+	return a;
+}
+
+template<typename OPS, ENN_ARR_OP OP>
+inline size_t arr_binary_op(bool add, float * dst, const float * a, const float * b, size_t num) {
+	const size_t W = OPS::width;
+	size_t i = 0;
+	if (add) {
+		if (OP == ENN_ARR_MUL) {
+			for (; i + W <= num; i += W)
+				OPS::store(dst + i, OPS::madd(OPS::load(a + i), OPS::load(b + i), OPS::load(dst + i)));
+		} else {
+			for (; i + W <= num; i += W)
+				OPS::store(dst + i, OPS::add(OPS::load(dst + i), arr_op<OPS, OP>(OPS::load(a + i), OPS::load(b + i))));
+		}
+	} else {
+		for (; i + W <= num; i += W)
+			OPS::store(dst + i, arr_op<OPS, OP>(OPS::load(a + i), OPS::load(b + i)));
+	}
+	return i;
+}
+
+template<typename OPS, ENN_ARR_OP OP>
+inline void arr_binary_tail(bool add, float * dst, const float * a, const float * b, size_t num) {
+	size_t i = arr_binary_op<OPS, OP>(add, dst, a, b, num);
+	arr_binary_op<simd::scalar_ops, OP>(add, dst + i, a + i, b + i, num - i);
+}
+
+template<typename OPS>
+void arr_binary(ENN_ARR_OP op, bool add, float * dst, const float * a, const float * b, size_t num) {
+	switch (op) {
+		case ENN_ARR_SUM: arr_binary_tail<OPS, ENN_ARR_SUM>(add, dst, a, b, num); break;
+		case ENN_ARR_DIFF: arr_binary_tail<OPS, ENN_ARR_DIFF>(add, dst, a, b, num); break;
+		case ENN_ARR_MUL: arr_binary_tail<OPS, ENN_ARR_MUL>(add, dst, a, b, num); break;
+		case ENN_ARR_DIV: arr_binary_tail<OPS, ENN_ARR_DIV>(add, dst, a, b, num); break;
+		case ENN_ARR_SUMSQR: arr_binary_tail<OPS, ENN_ARR_SUMSQR>(add, dst, a, b, num); break;
+		case ENN_ARR_DIFFSQR: arr_binary_tail<OPS, ENN_ARR_DIFFSQR>(add, dst, a, b, num); break;
+		case ENN_ARR_SQRSUM: arr_binary_tail<OPS, ENN_ARR_SQRSUM>(add, dst, a, b, num); break;
+		case ENN_ARR_SQRDIFF: arr_binary_tail<OPS, ENN_ARR_SQRDIFF>(add, dst, a, b, num); break;
+	}
+}
+
+template<typename OPS, ENN_ARR_OP OP>
+inline size_t arr_const_op(bool add, float * dst, const float * a, float c, size_t num) {
+	const size_t W = OPS::width;
+	const typename OPS::vf C = OPS::set1(c);
+	size_t i = 0;
+	if (add) {
+		if (OP == ENN_ARR_MUL) {
+			for (; i + W <= num; i += W)
+				OPS::store(dst + i, OPS::madd(OPS::load(a + i), C, OPS::load(dst + i)));
+		} else {
+			for (; i + W <= num; i += W)
+				OPS::store(dst + i, OPS::add(OPS::load(dst + i), arr_op<OPS, OP>(OPS::load(a + i), C)));
+		}
+	} else {
+		for (; i + W <= num; i += W)
+			OPS::store(dst + i, arr_op<OPS, OP>(OPS::load(a + i), C));
+	}
+	return i;
+}
+
+template<typename OPS, ENN_ARR_OP OP>
+inline void arr_const_tail(bool add, float * dst, const float * a, float c, size_t num) {
+	size_t i = arr_const_op<OPS, OP>(add, dst, a, c, num);
+	arr_const_op<simd::scalar_ops, OP>(add, dst + i, a + i, c, num - i);
+}
+
+template<typename OPS>
+void arr_const(ENN_ARR_OP op, bool add, float * dst, const float * a, float c, size_t num) {
+	switch (op) {
+		case ENN_ARR_SUM: arr_const_tail<OPS, ENN_ARR_SUM>(add, dst, a, c, num); break;
+		case ENN_ARR_DIFF: arr_const_tail<OPS, ENN_ARR_DIFF>(add, dst, a, c, num); break;
+		case ENN_ARR_MUL: arr_const_tail<OPS, ENN_ARR_MUL>(add, dst, a, c, num); break;
+		case ENN_ARR_DIV: arr_const_tail<OPS, ENN_ARR_DIV>(add, dst, a, c, num); break;
+		default: assert(false);
+	}
+}
+
+/// vector of partial sums of num (multiple of width) values (or of their squares if SQR is true)
+/// using four independent accumulators. Arrays longer than ENN_REDUCE_BLOCK are summed pairwise,
+/// see arch/pure/mvo_array.h. The partial sums stay in vectors, so there is one horizontal sum per call.
+template<typename OPS, bool SQR>
+inline typename OPS::vf reduce_vec(const float * a, size_t num) {
+	const size_t W = OPS::width;
+	if (num > ENN_REDUCE_BLOCK) {
+		const size_t half = (num / 2) & ~(4 * W - 1);
+		return OPS::add(reduce_vec<OPS, SQR>(a, half), reduce_vec<OPS, SQR>(a + half, num - half));
+	}
+	typename OPS::vf acc0 = OPS::zero(), acc1 = OPS::zero(), acc2 = OPS::zero(), acc3 = OPS::zero();
+	typename OPS::vf x0, x1, x2, x3;
+	size_t i = 0;
+	for (; i + 4 * W <= num; i += 4 * W) {
+		x0 = OPS::load(a + i);
+		x1 = OPS::load(a + i + W);
+		x2 = OPS::load(a + i + 2 * W);
+		x3 = OPS::load(a + i + 3 * W);
+		if (SQR) {
+			acc0 = OPS::madd(x0, x0, acc0);
+			acc1 = OPS::madd(x1, x1, acc1);
+			acc2 = OPS::madd(x2, x2, acc2);
+			acc3 = OPS::madd(x3, x3, acc3);
+		} else {
+			acc0 = OPS::add(acc0, x0);
+			acc1 = OPS::add(acc1, x1);
+			acc2 = OPS::add(acc2, x2);
+			acc3 = OPS::add(acc3, x3);
+		}
+	}
+	for (; i < num; i += W) {
+		x0 = OPS::load(a + i);
+		acc0 = SQR ? OPS::madd(x0, x0, acc0) : OPS::add(acc0, x0);
+	}
+	return OPS::add(OPS::add(acc0, acc1), OPS::add(acc2, acc3));
+}
+
+template<typename OPS, bool SQR>
+inline float reduce_arr(const float * a, size_t num) {
+	const size_t n = num - num % OPS::width;
+	float acc = OPS::hsum(reduce_vec<OPS, SQR>(a, n));
+	for (size_t i = n; i < num; i++)
+		acc += SQR ? a[i] * a[i] : a[i];
+	return acc;
+}
+
+template<typename OPS>
+float sum_arr(const float * a, size_t num) {
+	return reduce_arr<OPS, false>(a, num);
+}
+
+template<typename OPS>
+float sqrsum_arr(const float * a, size_t num) {
+	return reduce_arr<OPS, true>(a, num);
+}
+
+/// vectors of partial SUMi (Ai - K) and SUMi (Ai - K)^2 of num (multiple of width) values, see reduce_vec
+template<typename OPS>
+inline void shifted_sums_vec(typename OPS::vf * Ex, typename OPS::vf * Ex2, const float * a, typename OPS::vf k, size_t num) {
+	const size_t W = OPS::width;
+	if (num > ENN_REDUCE_BLOCK) {
+		const size_t half = (num / 2) & ~(2 * W - 1);
+		typename OPS::vf Ex_hi, Ex2_hi;
+		shifted_sums_vec<OPS>(Ex, Ex2, a, k, half);
+		shifted_sums_vec<OPS>(&Ex_hi, &Ex2_hi, a + half, k, num - half);
+		*Ex = OPS::add(*Ex, Ex_hi);
+		*Ex2 = OPS::add(*Ex2, Ex2_hi);
+		return;
+	}
+	typename OPS::vf s0 = OPS::zero(), s1 = OPS::zero(), q0 = OPS::zero(), q1 = OPS::zero();
+	typename OPS::vf x0, x1;
+	size_t i = 0;
+	for (; i + 2 * W <= num; i += 2 * W) {
+		x0 = OPS::sub(OPS::load(a + i), k);
+		x1 = OPS::sub(OPS::load(a + i + W), k);
+		s0 = OPS::add(s0, x0);
+		s1 = OPS::add(s1, x1);
+		q0 = OPS::madd(x0, x0, q0);
+		q1 = OPS::madd(x1, x1, q1);
+	}
+	if (i < num) {
+		x0 = OPS::sub(OPS::load(a + i), k);
+		s0 = OPS::add(s0, x0);
+		q0 = OPS::madd(x0, x0, q0);
+	}
+	*Ex = OPS::add(s0, s1);
+	*Ex2 = OPS::add(q0, q1);
+}
+
+template<typename OPS>
+void shifted_sums_arr(float * Ex, float * Ex2, const float * a, float K, size_t num) {
+	const size_t n = num - num % OPS::width;
+	typename OPS::vf s, q;
+	shifted_sums_vec<OPS>(&s, &q, a, OPS::set1(K), n);
+	float sum = OPS::hsum(s);
+	float sqr = OPS::hsum(q);
+	for (size_t i = n; i < num; i++) {
+		float tmp = a[i] - K;
+		sum += tmp;
+		sqr += tmp * tmp;
+	}
+	*Ex = sum;
+	*Ex2 = sqr;
+}
+
+/// max (min if MIN is true) of the array
+template<typename OPS, bool MIN>
+inline float extreme_arr(const float * a, size_t num) {
+	const size_t W = OPS::width;
+	float acc = MIN ? std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity();
+	typename OPS::vf acc0 = OPS::set1(acc), acc1 = acc0;
+	size_t i = 0;
+	// NOTE: the loaded value goes first, so that NaNs are skipped the same way as in the generic version
+	for (; i + 2 * W <= num; i += 2 * W) {
+		acc0 = MIN ? OPS::min(OPS::load(a + i), acc0) : OPS::max(OPS::load(a + i), acc0);
+		acc1 = MIN ? OPS::min(OPS::load(a + i + W), acc1) : OPS::max(OPS::load(a + i + W), acc1);
+	}
+	acc = MIN ? OPS::hmin(OPS::min(acc0, acc1)) : OPS::hmax(OPS::max(acc0, acc1));
+	for (; i < num; i++)
+		acc = (MIN ? a[i] < acc : a[i] > acc) ? a[i] : acc;
+	return acc;
+}
+
+///
+/// max (min) value and the index of its first occurence in a single pass.
+/// The extreme of every ENN_REDUCE_BLOCK values is found with vectors and only the
+/// block holding the first occurence of the overall extreme, which is still in cache,
+/// is searched for the index.
+///
+template<typename OPS>
+float minmax_arr(bool is_min, size_t * index, const float * a, size_t num) {
+	float acc = is_min ? std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity();
+	size_t block = 0, i, end;
+	for (i = 0; i < num; i += ENN_REDUCE_BLOCK) {
+		const size_t n = num - i < ENN_REDUCE_BLOCK ? num - i : ENN_REDUCE_BLOCK;
+		const float tmp = is_min ? extreme_arr<OPS, true>(a + i, n) : extreme_arr<OPS, false>(a + i, n);
+		if (is_min ? tmp < acc : tmp > acc) {
+			acc = tmp;
+			block = i;
+		}
+	}
+	*index = 0;
+	end = num - block < ENN_REDUCE_BLOCK ? num : block + ENN_REDUCE_BLOCK;
+	for (i = block; i < end; i++) {
+		if (a[i] == acc) {
+			*index = i;
+			break;
+		}
+	}
+	return acc;
+}
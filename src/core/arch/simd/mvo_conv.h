@@ -0,0 +1,197 @@
+///
+/// SIMD convolution kernels. See mvo_array.h
+///
+
+///
+/// With unit stride the convolution is vectorized along the output,
+/// keeping a block of outputs in a register for the whole kernel.
+/// Otherwise each output is a dot product along the kernel.
+///
+template<typename OPS>
+void convolve_1d(float * dst, const float * vec, const float * kernel, size_t N, size_t M, size_t stride) {
+	const size_t W = OPS::width;
+	const size_t dst_size = (N - M) / stride + 1;
+	size_t i = 0, j;
+
+	if (stride == 1) {
+		for (; i + W <= dst_size; i += W) {
+			typename OPS::vf acc = OPS::zero();
+			for (j = 0; j < M; j++)
+				acc = OPS::madd(OPS::load(vec + i + j), OPS::set1(kernel[j]), acc);
+			OPS::store(dst + i, OPS::add(OPS::load(dst + i), acc));
+		}
+	}
+
+	for (; i < dst_size; i++)
+		dst[i] += dot_product<OPS>(vec + i * stride, kernel, M);
+}
+
+template<typename OPS>
+void convolve_2d(float * dst, const float * mat, const float * kernel, size_t N, size_t M, size_t K, size_t L, size_t stride) {
+	const size_t W = OPS::width;
+	const size_t MLS = (M - L) / stride + 1;
+	const size_t NKS = (N - K) / stride + 1;
+	size_t a, b, i, j;
+
+	for (b = 0; b < MLS; b++) {
+		const float * p = mat + (b * stride) * N;
+		a = 0;
+
+		if (stride == 1) {
+			for (; a + W <= NKS; a += W) {
+				typename OPS::vf acc = OPS::zero();
+				const float * row = p + a;
+				const float * k = kernel;
+				for (j = 0; j < L; j++) {
+					for (i = 0; i < K; i++)
+						acc = OPS::madd(OPS::load(row + i), OPS::set1(k[i]), acc);
+					row += N;
+					k += K;
+				}
+				OPS::store(dst + a, OPS::add(OPS::load(dst + a), acc));
+			}
+		}
+
+		for (; a < NKS; a++) {
+			float acc = 0;
+			const float * row = p + a * stride;
+			const float * k = kernel;
+			for (j = 0; j < L; j++) {
+				acc += dot_product<OPS>(row, k, K);
+				row += N;
+				k += K;
+			}
+			dst[a] += acc;
+		}
+		dst += NKS;
+	}
+}
+
+///
+/// FFT kernels, complex arrays are stored as real and imaginary parts
+///
+template<typename OPS>
+void fft_butterfly(float * ar, float * ai, float * br, float * bi, float wr, float wi, size_t num) {
+	const size_t W = OPS::width;
+	const typename OPS::vf vwr = OPS::set1(wr), vwi = OPS::set1(wi);
+	size_t i = 0;
+
+	for (; i + W <= num; i += W) {
+		typename OPS::vf xr = OPS::load(br + i), xi = OPS::load(bi + i);
+		typename OPS::vf tr = OPS::sub(OPS::mul(xr, vwr), OPS::mul(xi, vwi));
+		typename OPS::vf ti = OPS::madd(xr, vwi, OPS::mul(xi, vwr));
+		xr = OPS::load(ar + i);
+		xi = OPS::load(ai + i);
+		OPS::store(br + i, OPS::sub(xr, tr));
+		OPS::store(bi + i, OPS::sub(xi, ti));
+		OPS::store(ar + i, OPS::add(xr, tr));
+		OPS::store(ai + i, OPS::add(xi, ti));
+	}
+	for (; i < num; i++) {
+		const float tr = br[i] * wr - bi[i] * wi;
+		const float ti = br[i] * wi + bi[i] * wr;
+		br[i] = ar[i] - tr;
+		bi[i] = ai[i] - ti;
+		ar[i] += tr;
+		ai[i] += ti;
+	}
+}
+
+template<typename OPS>
+void complex_madd(float * dr, float * di, const float * ar, const float * ai, float cr, float ci, size_t num) {
+	const size_t W = OPS::width;
+	const typename OPS::vf vcr = OPS::set1(cr), vci = OPS::set1(ci), vnci = OPS::set1(-ci);
+	size_t i = 0;
+
+	for (; i + W <= num; i += W) {
+		typename OPS::vf xr = OPS::load(ar + i), xi = OPS::load(ai + i);
+		OPS::store(dr + i, OPS::madd(xi, vnci, OPS::madd(xr, vcr, OPS::load(dr + i))));
+		OPS::store(di + i, OPS::madd(xi, vcr, OPS::madd(xr, vci, OPS::load(di + i))));
+	}
+	for (; i < num; i++) {
+		dr[i] += ar[i] * cr - ai[i] * ci;
+		di[i] += ar[i] * ci + ai[i] * cr;
+	}
+}
+
+///
+/// Convolution of NF <= 4 kernels over all the channels at once. With unit stride NF blocks
+/// of outputs are kept in registers, otherwise NF outputs.
+///
+template<typename OPS, size_t NF>
+void convolve_2d_block(float * dst, const float * mat, const float * kernel, size_t row, size_t N, size_t M, size_t C, size_t K, size_t L, size_t stride) {
+	typedef typename OPS::vf vf;
+	const size_t W = OPS::width;
+	const size_t MLS = (M - L) / stride + 1;
+	const size_t NKS = (N - K) / stride + 1;
+	const size_t size = NKS * MLS;
+	const size_t channel = N * M;
+	size_t a, b, c, i, j;
+
+	for (b = 0; b < MLS; b++) {
+		const float * p = mat + (b * stride) * N;
+		a = 0;
+
+		if (stride == 1) {
+			for (; a + W <= NKS; a += W) {
+				vf acc0 = OPS::zero(), acc1 = OPS::zero(), acc2 = OPS::zero(), acc3 = OPS::zero();
+				const float * q = p + a;
+				const float * k = kernel;
+				for (c = 0; c < C; c++, q += channel) {
+					const float * r = q;
+					for (j = 0; j < L; j++, r += N, k += K) {
+						for (i = 0; i < K; i++) {
+							const vf x = OPS::load(r + i);
+							acc0 = OPS::madd(x, OPS::set1(k[i]), acc0);
+							if (NF > 1) acc1 = OPS::madd(x, OPS::set1(k[row + i]), acc1);
+							if (NF > 2) acc2 = OPS::madd(x, OPS::set1(k[2 * row + i]), acc2);
+							if (NF > 3) acc3 = OPS::madd(x, OPS::set1(k[3 * row + i]), acc3);
+						}
+					}
+				}
+				OPS::store(dst + a, acc0);
+				if (NF > 1) OPS::store(dst + size + a, acc1);
+				if (NF > 2) OPS::store(dst + 2 * size + a, acc2);
+				if (NF > 3) OPS::store(dst + 3 * size + a, acc3);
+			}
+		}
+
+		for (; a < NKS; a++) {
+			float acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+			const float * q = p + a * stride;
+			const float * k = kernel;
+			for (c = 0; c < C; c++, q += channel) {
+				const float * r = q;
+				for (j = 0; j < L; j++, r += N, k += K) {
+					for (i = 0; i < K; i++) {
+						const float x = r[i];
+						acc0 += x * k[i];
+						if (NF > 1) acc1 += x * k[row + i];
+						if (NF > 2) acc2 += x * k[2 * row + i];
+						if (NF > 3) acc3 += x * k[3 * row + i];
+					}
+				}
+			}
+			dst[a] = acc0;
+			if (NF > 1) dst[size + a] = acc1;
+			if (NF > 2) dst[2 * size + a] = acc2;
+			if (NF > 3) dst[3 * size + a] = acc3;
+		}
+		dst += NKS;
+	}
+}
+
+template<typename OPS>
+void convolve_2d_multi(float * dst, const float * mat, const float * kernel, size_t row, size_t N, size_t M, size_t C, size_t K, size_t L, size_t F, size_t stride) {
+	const size_t size = ((N - K) / stride + 1) * ((M - L) / stride + 1);
+	size_t f = 0;
+
+	for (; f + 4 <= F; f += 4)
+		convolve_2d_block<OPS, 4>(dst + f * size, mat, kernel + f * row, row, N, M, C, K, L, stride);
+	if (f + 2 <= F) {
+		convolve_2d_block<OPS, 2>(dst + f * size, mat, kernel + f * row, row, N, M, C, K, L, stride);
+		f += 2;
+	}
+	if (f < F)
+		convolve_2d_block<OPS, 1>(dst + f * size, mat, kernel + f * row, row, N, M, C, K, L, stride);
+}
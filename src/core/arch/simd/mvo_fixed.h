@@ -0,0 +1,164 @@
+///
+/// SIMD kernels for FixedPointType<int16_t, EXPONENT>, operating on the raw int16_t values.
+/// Written against a fixed point operation set, see scalar_fixed16_ops in mvo_ops.h
+///
+/// Element-wise operations shift each product by EXPONENT (passed as shift) and truncate it to 16 bit
+/// exactly like FixedPointType::operator *, and the sums wrap around the same way as int16_t does.
+/// dot products and mat_mul accumulate the products in 32 bit and round, shift and saturate once
+/// per output like the kernels in arch/pure/mvo_fixed.h. Either way the results are bit exact
+/// with the pure kernels.
+///
+
+template<typename FOPS, ENN_ARR_OP OP>
+inline typename FOPS::vi fixed16_op(typename FOPS::vi a, typename FOPS::vi b, int shift) {
+	typename FOPS::vi t;
+	switch (OP) {
+		case ENN_ARR_SUM: return FOPS::add(a, b);
+		case ENN_ARR_DIFF: return FOPS::sub(a, b);
+		case ENN_ARR_MUL: return FOPS::mul(a, b, shift);
+		case ENN_ARR_SUMSQR: t = FOPS::add(a, b); return FOPS::mul(t, t, shift);
+		case ENN_ARR_DIFFSQR: t = FOPS::sub(a, b); return FOPS::mul(t, t, shift);
+		case ENN_ARR_SQRSUM: return FOPS::add(FOPS::mul(a, a, shift), FOPS::mul(b, b, shift));
+		case ENN_ARR_SQRDIFF: return FOPS::sub(FOPS::mul(a, a, shift), FOPS::mul(b, b, shift));
+		default: return a;
+	}
+}
+
+/// DSTi (+)= Ai op Bi, or DSTi (+)= Ai op b if B is NULL
+template<typename FOPS, ENN_ARR_OP OP>
+void fixed16_arr(bool add, int16_t * dst, const int16_t * a, const int16_t * B, int16_t b, size_t num, int shift) {
+	typedef simd::scalar_fixed16_ops S;
+	const size_t W = FOPS::width;
+	const typename FOPS::vi bb = FOPS::set1(b);
+	size_t i = 0;
+	for (; i + W <= num; i += W) {
+		const typename FOPS::vi x = fixed16_op<FOPS, OP>(FOPS::load(a + i), B ? FOPS::load(B + i) : bb, shift);
+		FOPS::store(dst + i, add ? FOPS::add(FOPS::load(dst + i), x) : x);
+	}
+	for (; i < num; i++) {
+		const int16_t x = fixed16_op<S, OP>(a[i], B ? B[i] : b, shift);
+		dst[i] = add ? S::add(dst[i], x) : x;
+	}
+}
+
+/// returns false for the operations without a fixed point kernel (division)
+template<typename FOPS>
+bool fixed16_arr(ENN_ARR_OP op, bool add, int16_t * dst, const int16_t * a, const int16_t * B, int16_t b, size_t num, int shift) {
+	switch (op) {
+		case ENN_ARR_SUM: fixed16_arr<FOPS, ENN_ARR_SUM>(add, dst, a, B, b, num, shift); return true;
+		case ENN_ARR_DIFF: fixed16_arr<FOPS, ENN_ARR_DIFF>(add, dst, a, B, b, num, shift); return true;
+		case ENN_ARR_MUL: fixed16_arr<FOPS, ENN_ARR_MUL>(add, dst, a, B, b, num, shift); return true;
+		case ENN_ARR_SUMSQR: fixed16_arr<FOPS, ENN_ARR_SUMSQR>(add, dst, a, B, b, num, shift); return true;
+		case ENN_ARR_DIFFSQR: fixed16_arr<FOPS, ENN_ARR_DIFFSQR>(add, dst, a, B, b, num, shift); return true;
+		case ENN_ARR_SQRSUM: fixed16_arr<FOPS, ENN_ARR_SQRSUM>(add, dst, a, B, b, num, shift); return true;
+		case ENN_ARR_SQRDIFF: fixed16_arr<FOPS, ENN_ARR_SQRDIFF>(add, dst, a, B, b, num, shift); return true;
+		default: return false;
+	}
+}
+
+/// SUMi Ai * Bi in 32 bit, see kernel_fixed_dot
+template<typename FOPS>
+int32_t fixed16_dot(const int16_t * a, const int16_t * b, size_t num) {
+	const size_t W = FOPS::width;
+	typename FOPS::vw acc0 = FOPS::wzero(), acc1 = FOPS::wzero();
+	size_t i = 0;
+	for (; i + 2 * W <= num; i += 2 * W) {
+		acc0 = FOPS::madd(acc0, FOPS::load(a + i), FOPS::load(b + i));
+		acc1 = FOPS::madd(acc1, FOPS::load(a + i + W), FOPS::load(b + i + W));
+	}
+	for (; i + W <= num; i += W)
+		acc0 = FOPS::madd(acc0, FOPS::load(a + i), FOPS::load(b + i));
+	int32_t acc = FOPS::hsum(FOPS::wadd(acc0, acc1));
+	for (; i < num; i++)
+		acc += (int32_t)a[i] * (int32_t)b[i];
+	return acc;
+}
+
+///
+/// DSTj = narrow(SUMi VECi * MATij + (MAT(N+1)j {if bias} + DSTj {if add}) << shift), see kernel_fixed_mat_mul.
+/// Four rows of the matrix are multiplied at once, so that each load of the vector is shared.
+///
+template<typename FOPS>
+void fixed16_mat_mul(int16_t * dst, const int16_t * vec, const int16_t * mat, size_t N, size_t M, bool bias, bool add, int shift) {
+	const size_t W = FOPS::width;
+	const size_t row = bias ? N + 1 : N;
+	size_t i, j, k;
+	int32_t acc[4];
+
+	for (j = 0; j + 4 <= M; j += 4) {
+		const int16_t * m[4] = { mat + j * row, mat + (j + 1) * row, mat + (j + 2) * row, mat + (j + 3) * row };
+		typename FOPS::vw acc0 = FOPS::wzero(), acc1 = FOPS::wzero(), acc2 = FOPS::wzero(), acc3 = FOPS::wzero();
+
+		for (i = 0; i + W <= N; i += W) {
+			const typename FOPS::vi v = FOPS::load(vec + i);
+			acc0 = FOPS::madd(acc0, v, FOPS::load(m[0] + i));
+			acc1 = FOPS::madd(acc1, v, FOPS::load(m[1] + i));
+			acc2 = FOPS::madd(acc2, v, FOPS::load(m[2] + i));
+			acc3 = FOPS::madd(acc3, v, FOPS::load(m[3] + i));
+		}
+		acc[0] = FOPS::hsum(acc0);
+		acc[1] = FOPS::hsum(acc1);
+		acc[2] = FOPS::hsum(acc2);
+		acc[3] = FOPS::hsum(acc3);
+		for (k = 0; k < 4; k++) {
+			for (size_t l = i; l < N; l++)
+				acc[k] += (int32_t)vec[l] * (int32_t)m[k][l];
+			if (bias)
+				acc[k] += fixed_widen(m[k][N], shift);
+			if (add)
+				acc[k] += fixed_widen(dst[j + k], shift);
+			dst[j + k] = fixed_narrow<int16_t>(acc[k], shift);
+		}
+	}
+
+	for (; j < M; j++) {
+		const int16_t * m = mat + j * row;
+		int32_t a = fixed16_dot<FOPS>(vec, m, N);
+		if (bias)
+			a += fixed_widen(m[N], shift);
+		if (add)
+			a += fixed_widen(dst[j], shift);
+		dst[j] = fixed_narrow<int16_t>(a, shift);
+	}
+}
+
+/// DSTi (+)= SUMj VECj * MATij, see kernel_mat_mul_transposed. Four rows are accumulated at once
+template<typename FOPS>
+void fixed16_mat_mul_transposed(int16_t * dst, const int16_t * vec, const int16_t * mat, size_t N, size_t M, bool bias, bool add, int shift) {
+	const size_t W = FOPS::width;
+	const size_t row = bias ? N + 1 : N;
+	size_t i, j;
+
+	if (!add) {
+		for (i = 0; i < N; i++)
+			dst[i] = 0;
+	}
+
+	for (j = 0; j + 4 <= M; j += 4) {
+		const int16_t * m0 = mat + j * row;
+		const int16_t * m1 = m0 + row;
+		const int16_t * m2 = m1 + row;
+		const int16_t * m3 = m2 + row;
+		const typename FOPS::vi v0 = FOPS::set1(vec[j]), v1 = FOPS::set1(vec[j + 1]), v2 = FOPS::set1(vec[j + 2]), v3 = FOPS::set1(vec[j + 3]);
+		for (i = 0; i + W <= N; i += W) {
+			typename FOPS::vi d = FOPS::load(dst + i);
+			d = FOPS::add(d, FOPS::mul(FOPS::load(m0 + i), v0, shift));
+			d = FOPS::add(d, FOPS::mul(FOPS::load(m1 + i), v1, shift));
+			d = FOPS::add(d, FOPS::mul(FOPS::load(m2 + i), v2, shift));
+			d = FOPS::add(d, FOPS::mul(FOPS::load(m3 + i), v3, shift));
+			FOPS::store(dst + i, d);
+		}
+		for (; i < N; i++) {
+			typedef simd::scalar_fixed16_ops S;
+			int16_t d = dst[i];
+			d = S::add(d, S::mul(m0[i], vec[j], shift));
+			d = S::add(d, S::mul(m1[i], vec[j + 1], shift));
+			d = S::add(d, S::mul(m2[i], vec[j + 2], shift));
+			d = S::add(d, S::mul(m3[i], vec[j + 3], shift));
+			dst[i] = d;
+		}
+	}
+
+	for (; j < M; j++)
+		fixed16_arr<FOPS, ENN_ARR_MUL>(true, dst, mat + j * row, NULL, vec[j], N, shift);
+}
@@ -0,0 +1,68 @@
+///
+/// SIMD kernels for half precision weights, see arch/pure/mvo_half.h.
+/// Written against a vector operation set, see mvo_ops.h
+///
+
+template<typename OPS, ENN_HALF FORMAT>
+inline typename OPS::vf load_half(const uint16_t * p) {
+	return FORMAT == ENN_HALF_BFLOAT16 ? OPS::load_bf16(p) : OPS::load_f16(p);
+}
+
+///
+/// DSTj (+)= SUMi VECi * Hij + H(N+1)j {if bias}, see kernel_hmat_mul.
+/// The weights are converted to float in the inner loop, four rows at once so that each load of the vector is shared.
+///
+template<typename OPS, ENN_HALF FORMAT>
+void hmat_mul(float * dst, const float * vec, const uint16_t * mat, size_t N, size_t M, bool bias, bool add) {
+	const size_t W = OPS::width;
+	const size_t row = bias ? N + 1 : N;
+	size_t i, j, k;
+	float acc[4];
+
+	for (j = 0; j + 4 <= M; j += 4) {
+		const uint16_t * m[4] = { mat + j * row, mat + (j + 1) * row, mat + (j + 2) * row, mat + (j + 3) * row };
+		typename OPS::vf acc0 = OPS::zero(), acc1 = OPS::zero(), acc2 = OPS::zero(), acc3 = OPS::zero();
+
+		for (i = 0; i + W <= N; i += W) {
+			const typename OPS::vf v = OPS::load(vec + i);
+			acc0 = OPS::madd(v, load_half<OPS, FORMAT>(m[0] + i), acc0);
+			acc1 = OPS::madd(v, load_half<OPS, FORMAT>(m[1] + i), acc1);
+			acc2 = OPS::madd(v, load_half<OPS, FORMAT>(m[2] + i), acc2);
+			acc3 = OPS::madd(v, load_half<OPS, FORMAT>(m[3] + i), acc3);
+		}
+		acc[0] = OPS::hsum(acc0);
+		acc[1] = OPS::hsum(acc1);
+		acc[2] = OPS::hsum(acc2);
+		acc[3] = OPS::hsum(acc3);
+		for (k = 0; k < 4; k++) {
+			for (size_t l = i; l < N; l++)
+				acc[k] += vec[l] * half_to_float<FORMAT>(m[k][l]);
+			if (bias)
+				acc[k] += half_to_float<FORMAT>(m[k][N]);
+			dst[j + k] = add ? dst[j + k] + acc[k] : acc[k];
+		}
+	}
+
+	for (; j < M; j++) {
+		const uint16_t * m = mat + j * row;
+		typename OPS::vf a0 = OPS::zero();
+		for (i = 0; i + W <= N; i += W)
+			a0 = OPS::madd(OPS::load(vec + i), load_half<OPS, FORMAT>(m + i), a0);
+		float a = OPS::hsum(a0);
+		for (; i < N; i++)
+			a += vec[i] * half_to_float<FORMAT>(m[i]);
+		if (bias)
+			a += half_to_float<FORMAT>(m[N]);
+		dst[j] = add ? dst[j] + a : a;
+	}
+}
+
+template<typename OPS>
+void hmat_mul_f16(float * dst, const float * vec, const uint16_t * mat, size_t N, size_t M, bool bias, bool add) {
+	hmat_mul<OPS, ENN_HALF_FLOAT16>(dst, vec, mat, N, M, bias, add);
+}
+
+template<typename OPS>
+void hmat_mul_bf16(float * dst, const float * vec, const uint16_t * mat, size_t N, size_t M, bool bias, bool add) {
+	hmat_mul<OPS, ENN_HALF_BFLOAT16>(dst, vec, mat, N, M, bias, add);
+}
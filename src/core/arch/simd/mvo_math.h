@@ -0,0 +1,155 @@
+///
+/// SIMD transcendental kernels, see arch/pure/mvo_math.h for the approximations and tiers.
+/// NOTE: this file has no include guard, see mvo_array.h
+///
+
+/// e^x = 2^n * e^r, n = round(x / ln(2))
+template<typename OPS, bool PRECISE>
+inline typename OPS::vf exp_vec(typename OPS::vf x) {
+	typedef typename OPS::vf vf;
+	x = OPS::clamp(x, OPS::set1(ENN_MATH_EXP_MIN), OPS::set1(ENN_MATH_EXP_MAX));
+	const vf n = OPS::nearest(OPS::mul(x, OPS::set1(ENN_MATH_LOG2E)));
+	vf r = OPS::madd(n, OPS::set1(-ENN_MATH_LN2_HI), x);
+	r = OPS::madd(n, OPS::set1(-ENN_MATH_LN2_LO), r);
+	vf p;
+	if (PRECISE) {
+		p = OPS::madd(OPS::set1(ENN_MATH_EXP_C6), r, OPS::set1(ENN_MATH_EXP_C5));
+		p = OPS::madd(p, r, OPS::set1(ENN_MATH_EXP_C4));
+		p = OPS::madd(p, r, OPS::set1(ENN_MATH_EXP_C3));
+		p = OPS::madd(p, r, OPS::set1(ENN_MATH_EXP_C2));
+	} else {
+		p = OPS::madd(OPS::set1(ENN_MATH_EXP_FAST_C3), r, OPS::set1(ENN_MATH_EXP_FAST_C2));
+	}
+	p = OPS::madd(OPS::mul(r, r), p, OPS::add(r, OPS::set1(1.0f)));
+	return OPS::mul(p, OPS::pow2(n));
+}
+
+/// log(1 + t), 0 <= t <= 1
+template<typename OPS, bool PRECISE>
+inline typename OPS::vf log1p_vec(typename OPS::vf t) {
+	typedef typename OPS::vf vf;
+	const vf u = OPS::div(t, OPS::add(t, OPS::set1(2.0f)));
+	const vf w = OPS::mul(u, u);
+	vf q;
+	if (PRECISE) {
+		q = OPS::madd(OPS::set1(ENN_MATH_LOG1P_C3), w, OPS::set1(ENN_MATH_LOG1P_C2));
+		q = OPS::madd(q, w, OPS::set1(ENN_MATH_LOG1P_C1));
+		q = OPS::madd(q, w, OPS::set1(ENN_MATH_LOG1P_C0));
+	} else {
+		q = OPS::madd(OPS::set1(ENN_MATH_LOG1P_FAST_C1), w, OPS::set1(ENN_MATH_LOG1P_FAST_C0));
+	}
+	return OPS::mul(OPS::add(u, u), q);
+}
+
+template<typename OPS, ENN_MATH_FUNC F, bool PRECISE>
+inline typename OPS::vf math_vec(typename OPS::vf x) {
+	typedef typename OPS::vf vf;
+	const vf one = OPS::set1(1.0f);
+	switch (F) {
+		case ENN_MATH_EXP: return exp_vec<OPS, PRECISE>(x);
+		case ENN_MATH_TANH: return OPS::sub(one, OPS::div(OPS::set1(2.0f), OPS::add(exp_vec<OPS, PRECISE>(OPS::add(x, x)), one)));
+		case ENN_MATH_SIGMOID: return OPS::div(one, OPS::add(one, exp_vec<OPS, PRECISE>(OPS::sub(OPS::zero(), x))));
+		case ENN_MATH_SOFTPLUS: {
+			// log(1 + e^x) = max(x, 0) + log(1 + e^-|x|)
+			const vf e = exp_vec<OPS, PRECISE>(OPS::min(x, OPS::sub(OPS::zero(), x)));
+			return OPS::add(OPS::max(x, OPS::zero()), log1p_vec<OPS, PRECISE>(e));
+		}
+	}
+	return x;
+}
+
+/// the tail is processed in a padded vector, so that every element gets the same approximation
+template<typename OPS, ENN_MATH_FUNC F, bool PRECISE>
+void math_func_arr(float * dst, const float * a, size_t num) {
+	const size_t W = OPS::width;
+	size_t i = 0;
+	for (; i + 2 * W <= num; i += 2 * W) {
+		typename OPS::vf x0 = math_vec<OPS, F, PRECISE>(OPS::load(a + i));
+		typename OPS::vf x1 = math_vec<OPS, F, PRECISE>(OPS::load(a + i + W));
+		OPS::store(dst + i, x0);
+		OPS::store(dst + i + W, x1);
+	}
+	for (; i < num; i += W) {
+		float tmp[W];
+		const size_t n = num - i < W ? num - i : W;
+		for (size_t j = 0; j < W; j++)
+			tmp[j] = j < n ? a[i + j] : 0.0f;
+		OPS::store(tmp, math_vec<OPS, F, PRECISE>(OPS::load(tmp)));
+		for (size_t j = 0; j < n; j++)
+			dst[i + j] = tmp[j];
+	}
+}
+
+template<typename OPS, ENN_MATH_FUNC F>
+inline void math_func_arr(ENN_MATH_ACCURACY accuracy, float * dst, const float * a, size_t num) {
+	switch (accuracy) {
+		case ENN_MATH_FAST: math_func_arr<OPS, F, false>(dst, a, num); break;
+		case ENN_MATH_PRECISE: math_func_arr<OPS, F, true>(dst, a, num); break;
+		default: EasyNeuralNetworks::math_func_arr<float, F>(accuracy, dst, a, num);
+	}
+}
+
+template<typename OPS>
+void math_arr(ENN_MATH_FUNC func, ENN_MATH_ACCURACY accuracy, float * dst, const float * a, size_t num) {
+	switch (func) {
+		case ENN_MATH_EXP: math_func_arr<OPS, ENN_MATH_EXP>(accuracy, dst, a, num); break;
+		case ENN_MATH_TANH: math_func_arr<OPS, ENN_MATH_TANH>(accuracy, dst, a, num); break;
+		case ENN_MATH_SIGMOID: math_func_arr<OPS, ENN_MATH_SIGMOID>(accuracy, dst, a, num); break;
+		case ENN_MATH_SOFTPLUS: math_func_arr<OPS, ENN_MATH_SOFTPLUS>(accuracy, dst, a, num); break;
+	}
+}
+
+template<typename OPS, ENN_MATH_FUNC F, bool PRECISE>
+inline typename OPS::vf math_grad_vec(typename OPS::vf y) {
+	const typename OPS::vf one = OPS::set1(1.0f);
+	switch (F) {
+		case ENN_MATH_EXP: return y;
+		case ENN_MATH_TANH: return OPS::sub(one, OPS::mul(y, y));
+		case ENN_MATH_SIGMOID: return OPS::mul(y, OPS::sub(one, y));
+		case ENN_MATH_SOFTPLUS: return OPS::sub(one, exp_vec<OPS, PRECISE>(OPS::sub(OPS::zero(), y)));
+	}
+	return y;
+}
+
+template<typename OPS, ENN_MATH_FUNC F, bool PRECISE>
+void math_grad_func_arr(float * dst, const float * a, size_t num) {
+	const size_t W = OPS::width;
+	size_t i = 0;
+	for (; i + W <= num; i += W)
+		OPS::store(dst + i, OPS::mul(OPS::load(dst + i), math_grad_vec<OPS, F, PRECISE>(OPS::load(a + i))));
+	for (; i < num; i++)
+		dst[i] = dst[i] * math_grad_vec<simd::scalar_ops, F, PRECISE>(a[i]);
+}
+
+template<typename OPS>
+void math_grad_arr(ENN_MATH_FUNC func, ENN_MATH_ACCURACY accuracy, float * dst, const float * a, size_t num) {
+	switch (func) {
+		case ENN_MATH_EXP: math_grad_func_arr<OPS, ENN_MATH_EXP, true>(dst, a, num); break;
+		case ENN_MATH_TANH: math_grad_func_arr<OPS, ENN_MATH_TANH, true>(dst, a, num); break;
+		case ENN_MATH_SIGMOID: math_grad_func_arr<OPS, ENN_MATH_SIGMOID, true>(dst, a, num); break;
+		case ENN_MATH_SOFTPLUS:
+			if (accuracy == ENN_MATH_FAST)
+				math_grad_func_arr<OPS, ENN_MATH_SOFTPLUS, false>(dst, a, num);
+			else if (accuracy == ENN_MATH_PRECISE)
+				math_grad_func_arr<OPS, ENN_MATH_SOFTPLUS, true>(dst, a, num);
+			else
+				for (size_t i = 0; i < num; i++)
+					dst[i] = dst[i] * (float)(1.0 - exp(-(double)a[i]));
+			break;
+	}
+}
+
+/// max(x, 0) + negative_d * min(x, 0), equal to the scalar select since one of the terms is zero
+template<typename OPS>
+void relu_arr(float * dst, const float * a, float negative_d, size_t num) {
+	const size_t W = OPS::width;
+	const typename OPS::vf zero = OPS::zero();
+	const typename OPS::vf d = OPS::set1(negative_d);
+	size_t i = 0;
+	for (; i + W <= num; i += W) {
+		const typename OPS::vf x = OPS::load(a + i);
+		OPS::store(dst + i, OPS::madd(OPS::min(x, zero), d, OPS::max(x, zero)));
+	}
+	for (; i < num; i++)
+		dst[i] = a[i] > 0 ? a[i] : negative_d * a[i];
+}
@@ -0,0 +1,224 @@
+///
+/// SIMD matrix kernels. See mvo_array.h
+///
+
+///
+/// Four rows of the matrix are multiplied at once, so that each load of the vector
+/// is shared between four accumulators.
+/// With RELU each sum goes through x > 0 ? x : negative_d * x before it is stored.
+///
+template<typename OPS, bool RELU>
+void mat_mul_rows(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, bool add, float negative_d) {
+	const size_t W = OPS::width;
+	const size_t row = bias ? N + 1 : N;
+	size_t i, j;
+	float acc[4];
+
+	for (j = 0; j + 4 <= M; j += 4) {
+		const float * m0 = mat + j * row;
+		const float * m1 = m0 + row;
+		const float * m2 = m1 + row;
+		const float * m3 = m2 + row;
+		typename OPS::vf acc0 = OPS::zero(), acc1 = OPS::zero(), acc2 = OPS::zero(), acc3 = OPS::zero();
+		typename OPS::vf v;
+
+		for (i = 0; i + W <= N; i += W) {
+			v = OPS::load(vec + i);
+			acc0 = OPS::madd(v, OPS::load(m0 + i), acc0);
+			acc1 = OPS::madd(v, OPS::load(m1 + i), acc1);
+			acc2 = OPS::madd(v, OPS::load(m2 + i), acc2);
+			acc3 = OPS::madd(v, OPS::load(m3 + i), acc3);
+		}
+		acc[0] = OPS::hsum(acc0);
+		acc[1] = OPS::hsum(acc1);
+		acc[2] = OPS::hsum(acc2);
+		acc[3] = OPS::hsum(acc3);
+		for (; i < N; i++) {
+			acc[0] += vec[i] * m0[i];
+			acc[1] += vec[i] * m1[i];
+			acc[2] += vec[i] * m2[i];
+			acc[3] += vec[i] * m3[i];
+		}
+		if (bias) {
+			acc[0] += m0[N];
+			acc[1] += m1[N];
+			acc[2] += m2[N];
+			acc[3] += m3[N];
+		}
+		for (i = 0; i < 4; i++) {
+			if (RELU)
+				acc[i] = acc[i] > 0 ? acc[i] : negative_d * acc[i];
+			if (add)
+				dst[j + i] += acc[i];
+			else
+				dst[j + i] = acc[i];
+		}
+	}
+
+	for (; j < M; j++) {
+		const float * m = mat + j * row;
+		float a = dot_product<OPS>(vec, m, N);
+		if (bias)
+			a += m[N];
+		if (RELU)
+			a = a > 0 ? a : negative_d * a;
+		if (add)
+			dst[j] += a;
+		else
+			dst[j] = a;
+	}
+}
+
+template<typename OPS>
+void mat_mul(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, bool add) {
+	mat_mul_rows<OPS, false>(dst, vec, mat, N, M, bias, add, 0);
+}
+
+/// DSTj = leaky ReLU of the sums, the activation is applied in the store, see kernel_mat_mul_relu
+template<typename OPS>
+void mat_mul_relu(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, float negative_d) {
+	mat_mul_rows<OPS, true>(dst, vec, mat, N, M, bias, false, negative_d);
+}
+
+///
+/// DST = SUMj VECj * ROWj, where ROWj is the j-th row of the matrix.
+/// Four rows are accumulated at once, so that DST is read and written once per four rows.
+///
+template<typename OPS>
+void mat_mul_transposed(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, bool add) {
+	const size_t W = OPS::width;
+	const size_t row = bias ? N + 1 : N;
+	size_t i, j;
+
+	if (!add) {
+		for (i = 0; i < N; i++)
+			dst[i] = 0;
+	}
+
+	for (j = 0; j + 4 <= M; j += 4) {
+		const float * m0 = mat + j * row;
+		const float * m1 = m0 + row;
+		const float * m2 = m1 + row;
+		const float * m3 = m2 + row;
+		const typename OPS::vf v0 = OPS::set1(vec[j]);
+		const typename OPS::vf v1 = OPS::set1(vec[j + 1]);
+		const typename OPS::vf v2 = OPS::set1(vec[j + 2]);
+		const typename OPS::vf v3 = OPS::set1(vec[j + 3]);
+		typename OPS::vf acc;
+
+		for (i = 0; i + W <= N; i += W) {
+			acc = OPS::madd(v0, OPS::load(m0 + i), OPS::load(dst + i));
+			acc = OPS::madd(v1, OPS::load(m1 + i), acc);
+			acc = OPS::madd(v2, OPS::load(m2 + i), acc);
+			acc = OPS::madd(v3, OPS::load(m3 + i), acc);
+			OPS::store(dst + i, acc);
+		}
+		for (; i < N; i++)
+			dst[i] += vec[j] * m0[i] + vec[j + 1] * m1[i] + vec[j + 2] * m2[i] + vec[j + 3] * m3[i];
+	}
+
+	for (; j < M; j++)
+		arr_const_tail<OPS, ENN_ARR_MUL>(true, dst, mat + j * row, vec[j], N);
+}
+
+///
+/// GEMM micro-kernel for gemm_blocked (arch/pure/mvo_matrix.h).
+/// A 4 x (2 * width) block of C is kept in eight vector registers,
+/// each step broadcasts four values of A against two vectors of B.
+///
+template<typename OPS>
+struct gemm_kernel {
+	static const size_t mr = 4;
+	static const size_t nr = 2 * OPS::width;
+
+	static void run(size_t kc, const float * a, const float * b, float * c, size_t ldc, bool add) {
+		const size_t W = OPS::width;
+		typename OPS::vf c00 = OPS::zero(), c01 = OPS::zero(), c10 = OPS::zero(), c11 = OPS::zero();
+		typename OPS::vf c20 = OPS::zero(), c21 = OPS::zero(), c30 = OPS::zero(), c31 = OPS::zero();
+		typename OPS::vf b0, b1, x;
+
+		while (kc--) {
+			b0 = OPS::load(b);
+			b1 = OPS::load(b + W);
+			x = OPS::set1(a[0]);
+			c00 = OPS::madd(x, b0, c00);
+			c01 = OPS::madd(x, b1, c01);
+			x = OPS::set1(a[1]);
+			c10 = OPS::madd(x, b0, c10);
+			c11 = OPS::madd(x, b1, c11);
+			x = OPS::set1(a[2]);
+			c20 = OPS::madd(x, b0, c20);
+			c21 = OPS::madd(x, b1, c21);
+			x = OPS::set1(a[3]);
+			c30 = OPS::madd(x, b0, c30);
+			c31 = OPS::madd(x, b1, c31);
+			a += mr;
+			b += nr;
+		}
+
+		if (add) {
+			c00 = OPS::add(c00, OPS::load(c));
+			c01 = OPS::add(c01, OPS::load(c + W));
+			c10 = OPS::add(c10, OPS::load(c + ldc));
+			c11 = OPS::add(c11, OPS::load(c + ldc + W));
+			c20 = OPS::add(c20, OPS::load(c + 2 * ldc));
+			c21 = OPS::add(c21, OPS::load(c + 2 * ldc + W));
+			c30 = OPS::add(c30, OPS::load(c + 3 * ldc));
+			c31 = OPS::add(c31, OPS::load(c + 3 * ldc + W));
+		}
+		OPS::store(c, c00);
+		OPS::store(c + W, c01);
+		OPS::store(c + ldc, c10);
+		OPS::store(c + ldc + W, c11);
+		OPS::store(c + 2 * ldc, c20);
+		OPS::store(c + 2 * ldc + W, c21);
+		OPS::store(c + 3 * ldc, c30);
+		OPS::store(c + 3 * ldc + W, c31);
+	}
+};
+
+template<typename OPS>
+void mat_mul_batch(float * dst, const float * vec, const float * mat, size_t N, size_t M, size_t B, bool bias, bool add) {
+	gemm_blocked<float, gemm_kernel<OPS> >(dst, vec, mat, B, M, N, N, 1, M, 1, bias ? N + 1 : N, bias, add);
+}
+
+template<typename OPS>
+void mat_mul_transposed_batch(float * dst, const float * vec, const float * mat, size_t N, size_t M, size_t B, bool bias, bool add) {
+	gemm_blocked<float, gemm_kernel<OPS> >(dst, vec, mat, B, N, M, M, 1, N, bias ? N + 1 : N, 1, false, add);
+}
+
+template<typename OPS>
+void outer_product_batch(float * dst, const float * u, const float * v, size_t N, size_t M, size_t B, bool bias) {
+	gemm_blocked<float, gemm_kernel<OPS> >(dst, u, v, N, M, B, 1, N, bias ? M + 1 : M, M, 1, false, true);
+	if (bias)
+		outer_product_batch_bias(dst, u, N, M, B);
+}
+
+///
+/// Blocked transpose, see kernel_mat_transpose in arch/pure.
+/// Each cache block is transposed in 4x4 tiles in registers.
+///
+template<typename OPS>
+void mat_transpose(float * dst, const float * src, size_t width, size_t height) {
+	size_t x, y;
+
+	for (size_t y0 = 0; y0 < height; y0 += ENN_TRANSPOSE_BLOCK) {
+		const size_t y1 = y0 + ENN_TRANSPOSE_BLOCK < height ? y0 + ENN_TRANSPOSE_BLOCK : height;
+		for (size_t x0 = 0; x0 < width; x0 += ENN_TRANSPOSE_BLOCK) {
+			const size_t x1 = x0 + ENN_TRANSPOSE_BLOCK < width ? x0 + ENN_TRANSPOSE_BLOCK : width;
+			for (y = y0; y + 4 <= y1; y += 4) {
+				for (x = x0; x + 4 <= x1; x += 4)
+					OPS::transpose4(dst + y + x * height, height, src + x + y * width, width);
+				for (; x < x1; x++) {
+					dst[y + x * height] = src[x + y * width];
+					dst[y + 1 + x * height] = src[x + (y + 1) * width];
+					dst[y + 2 + x * height] = src[x + (y + 2) * width];
+					dst[y + 3 + x * height] = src[x + (y + 3) * width];
+				}
+			}
+			for (; y < y1; y++)
+				for (x = x0; x < x1; x++)
+					dst[y + x * height] = src[x + y * width];
+		}
+	}
+}
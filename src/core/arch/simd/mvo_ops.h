@@ -0,0 +1,136 @@
+#if !defined(ENN_SIMD_MVO_OPS_H)
+#define ENN_SIMD_MVO_OPS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <limits>
+#include <assert.h>
+#include "../../HalfFloatType.h"
+
+namespace EasyNeuralNetworks {
+namespace simd {
+
+///
+/// Vector operation sets.
+/// Kernels in mvo_array.h, mvo_vector.h, mvo_matrix.h and mvo_conv.h are written
+/// once against an operation set, which provides:
+///		vf						- vector type
+///		width					- number of floats in vf
+///		name()				- name reported by mvo_arch_name()
+///		load/store		- unaligned load/store
+///		load_i8(p)		- width int8 values converted to float, see mvo_quant.h
+///		load_i4(p, lo, hi) - width bytes of packed int4 values, low and high nibbles converted to float
+///		load_f16/load_bf16 - width float16/bfloat16 values converted to float, see mvo_half.h
+///		set1/zero			- broadcast
+///		add/sub/mul/div
+///		madd(a, b, c)	- a * b + c, fused if available
+///		max/min				- NaNs in the first argument are ignored
+///		clamp(a, lo, hi) - a limited to [lo, hi], NaNs are propagated
+///		hsum/hmax/hmin - horizontal reductions
+///		transpose4		- transposes a 4x4 block of floats between two strided matrices
+///		nearest				- rounds to the nearest integer
+///		pow2(n)				- 2^n for integral n in [-126, 127]
+/// scalar_ops is also used to process the tails.
+///
+struct scalar_ops {
+	typedef float vf;
+	static const size_t width = 1;
+	static inline const char * name() { return "pure"; }
+	static inline vf load(const float * p) { return *p; }
+	static inline void store(float * p, vf a) { *p = a; }
+	static inline vf load_i8(const int8_t * p) { return *p; }
+	static inline void load_i4(const uint8_t * p, vf& lo, vf& hi) {
+		lo = (float)((int8_t)(*p << 4) >> 4);
+		hi = (float)((int8_t)*p >> 4);
+	}
+	static inline vf load_f16(const uint16_t * p) { return float16_to_float(*p); }
+	static inline vf load_bf16(const uint16_t * p) { return bfloat16_to_float(*p); }
+	static inline vf set1(float a) { return a; }
+	static inline vf zero() { return 0; }
+	static inline vf add(vf a, vf b) { return a + b; }
+	static inline vf sub(vf a, vf b) { return a - b; }
+	static inline vf mul(vf a, vf b) { return a * b; }
+	static inline vf div(vf a, vf b) { return a / b; }
+	/// a * b + c
+	static inline vf madd(vf a, vf b, vf c) { return a * b + c; }
+	/// NaNs in a are ignored
+	static inline vf max(vf a, vf b) { return a > b ? a : b; }
+	static inline vf min(vf a, vf b) { return a < b ? a : b; }
+	static inline vf clamp(vf a, vf lo, vf hi) { return a < lo ? lo : a > hi ? hi : a; }
+	static inline float hsum(vf a) { return a; }
+	static inline float hmax(vf a) { return a; }
+	static inline float hmin(vf a) { return a; }
+	/// dst[y + x * ld_dst] = src[x + y * ld_src], x, y < 4
+	static inline void transpose4(float * dst, size_t ld_dst, const float * src, size_t ld_src) {
+		for (size_t y = 0; y < 4; y++)
+			for (size_t x = 0; x < 4; x++)
+				dst[y + x * ld_dst] = src[x + y * ld_src];
+	}
+	/// rounds half away from zero
+	static inline vf nearest(vf a) { return (float)(int32_t)(a < 0 ? a - 0.5f : a + 0.5f); }
+	static inline vf pow2(vf n) {
+		const uint32_t bits = (uint32_t)((int32_t)n + 127) << 23;
+		float p;
+		memcpy(&p, &bits, sizeof(p));
+		return p;
+	}
+};
+
+///
+/// int8 operation sets of the quantized kernels in mvo_quant.h:
+///		vi						- int32 accumulator type
+///		vx						- vector operand prepared for madd, e.g. widened to int16
+///		width					- number of int8 values processed by madd
+///		zero					- zero accumulator
+///		prepare(p)		- loads width int8 values of the vector operand
+///		madd(x, p, acc) - acc + x * (width int8 values at p), the products are exact
+///		hsum					- horizontal sum of the accumulator
+///		tail					- narrower operation set for the columns left over by width
+///
+struct scalar_qops {
+	typedef int32_t vi;
+	typedef int32_t vx;
+	typedef scalar_qops tail;
+	static const size_t width = 1;
+	static inline vi zero() { return 0; }
+	static inline vx prepare(const int8_t * p) { return *p; }
+	static inline vi madd(vx x, const int8_t * p, vi acc) { return acc + x * (int32_t)*p; }
+	static inline int32_t hsum(vi a) { return a; }
+};
+
+///
+/// FixedPointType<int16_t, EXPONENT> operation sets of the kernels in mvo_fixed.h, on raw int16_t values:
+///		vi						- vector of int16_t
+///		width					- number of values in vi
+///		load/store		- unaligned load/store
+///		set1/zero			- broadcast
+///		add/sub				- wrap around like int16_t
+///		mul(a, b, shift) - (a * b) >> shift truncated to 16 bit, shift <= 16, see FixedPointType::operator *
+///		vw						- int32_t accumulators of the products
+///		wzero/wadd		- zero, sum of the accumulators
+///		madd(acc, a, b)	- acc + a * b, the products of neighbouring int16_t values may share an accumulator
+///		hsum					- horizontal sum of the accumulators
+///
+struct scalar_fixed16_ops {
+	typedef int16_t vi;
+	static const size_t width = 1;
+	static inline vi load(const int16_t * p) { return *p; }
+	static inline void store(int16_t * p, vi a) { *p = a; }
+	static inline vi set1(int16_t a) { return a; }
+	static inline vi zero() { return 0; }
+	static inline vi add(vi a, vi b) { return (int16_t)(a + b); }
+	static inline vi sub(vi a, vi b) { return (int16_t)(a - b); }
+	static inline vi mul(vi a, vi b, int shift) { return (int16_t)(((int32_t)a * (int32_t)b) >> shift); }
+	typedef int32_t vw;
+	static inline vw wzero() { return 0; }
+	static inline vw wadd(vw a, vw b) { return a + b; }
+	static inline vw madd(vw acc, vi a, vi b) { return acc + (int32_t)a * (int32_t)b; }
+	static inline int32_t hsum(vw a) { return a; }
+};
+
+};
+};
+
+#endif
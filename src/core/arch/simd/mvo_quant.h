@@ -0,0 +1,152 @@
+///
+/// SIMD int8 kernels of the quantized layers, see arch/pure/mvo_quant.h.
+/// The int8 kernels are written against an int8 operation set (see scalar_qops in mvo_ops.h),
+/// the weight-only kernels against a vector operation set (see scalar_ops).
+///
+
+///
+/// DSTj += SUMi VECi * MAT(i + j * stride), i < N. Four rows of the matrix are multiplied at once,
+/// so that each load of the vector is shared between four accumulators.
+/// The columns left over by QOPS::width are done with the narrower QOPS::tail.
+///
+template<typename QOPS>
+void qmat_mul_add(int32_t * dst, const int8_t * vec, const int8_t * mat, size_t N, size_t stride, size_t M) {
+	const size_t W = QOPS::width;
+	const size_t n = N - N % W;
+	size_t i, j;
+
+	if (n) {
+		for (j = 0; j + 4 <= M; j += 4) {
+			const int8_t * m0 = mat + j * stride;
+			const int8_t * m1 = m0 + stride;
+			const int8_t * m2 = m1 + stride;
+			const int8_t * m3 = m2 + stride;
+			typename QOPS::vi acc0 = QOPS::zero(), acc1 = QOPS::zero(), acc2 = QOPS::zero(), acc3 = QOPS::zero();
+
+			for (i = 0; i < n; i += W) {
+				const typename QOPS::vx v = QOPS::prepare(vec + i);
+				acc0 = QOPS::madd(v, m0 + i, acc0);
+				acc1 = QOPS::madd(v, m1 + i, acc1);
+				acc2 = QOPS::madd(v, m2 + i, acc2);
+				acc3 = QOPS::madd(v, m3 + i, acc3);
+			}
+			dst[j] += QOPS::hsum(acc0);
+			dst[j + 1] += QOPS::hsum(acc1);
+			dst[j + 2] += QOPS::hsum(acc2);
+			dst[j + 3] += QOPS::hsum(acc3);
+		}
+
+		for (; j < M; j++) {
+			const int8_t * m = mat + j * stride;
+			typename QOPS::vi acc = QOPS::zero();
+			for (i = 0; i < n; i += W)
+				acc = QOPS::madd(QOPS::prepare(vec + i), m + i, acc);
+			dst[j] += QOPS::hsum(acc);
+		}
+	}
+
+	if (n < N)
+		qmat_mul_add<typename QOPS::tail>(dst, vec + n, mat + n, N - n, stride, M);
+}
+
+/// DSTj = SUMi VECi * MATij
+template<typename QOPS>
+void qmat_mul(int32_t * dst, const int8_t * vec, const int8_t * mat, size_t N, size_t M) {
+	for (size_t j = 0; j < M; j++)
+		dst[j] = 0;
+	qmat_mul_add<QOPS>(dst, vec, mat, N, N, M);
+}
+
+///
+/// DSTj = SUMi VECi * Qij, int8 weights converted to float in the inner loop.
+/// Four rows of the matrix are multiplied at once, see mat_mul in mvo_matrix.h
+///
+template<typename OPS>
+void wmat_mul_i8(float * dst, const float * vec, const int8_t * mat, size_t N, size_t M) {
+	const size_t W = OPS::width;
+	size_t i, j;
+
+	for (j = 0; j + 4 <= M; j += 4) {
+		const int8_t * m0 = mat + j * N;
+		const int8_t * m1 = m0 + N;
+		const int8_t * m2 = m1 + N;
+		const int8_t * m3 = m2 + N;
+		typename OPS::vf acc0 = OPS::zero(), acc1 = OPS::zero(), acc2 = OPS::zero(), acc3 = OPS::zero();
+
+		for (i = 0; i + W <= N; i += W) {
+			const typename OPS::vf v = OPS::load(vec + i);
+			acc0 = OPS::madd(v, OPS::load_i8(m0 + i), acc0);
+			acc1 = OPS::madd(v, OPS::load_i8(m1 + i), acc1);
+			acc2 = OPS::madd(v, OPS::load_i8(m2 + i), acc2);
+			acc3 = OPS::madd(v, OPS::load_i8(m3 + i), acc3);
+		}
+		float a0 = OPS::hsum(acc0), a1 = OPS::hsum(acc1), a2 = OPS::hsum(acc2), a3 = OPS::hsum(acc3);
+		for (; i < N; i++) {
+			a0 += vec[i] * m0[i];
+			a1 += vec[i] * m1[i];
+			a2 += vec[i] * m2[i];
+			a3 += vec[i] * m3[i];
+		}
+		dst[j] = a0;
+		dst[j + 1] = a1;
+		dst[j + 2] = a2;
+		dst[j + 3] = a3;
+	}
+
+	for (; j < M; j++) {
+		const int8_t * m = mat + j * N;
+		typename OPS::vf acc = OPS::zero();
+		for (i = 0; i + W <= N; i += W)
+			acc = OPS::madd(OPS::load(vec + i), OPS::load_i8(m + i), acc);
+		float a = OPS::hsum(acc);
+		for (; i < N; i++)
+			a += vec[i] * m[i];
+		dst[j] = a;
+	}
+}
+
+///
+/// DSTj = SUMi VECi * Qij, packed int4 weights (see kernel_wmat_mul_i4) converted to float in the inner loop.
+/// Each byte holds values k and k + half, so the low and high nibbles multiply two consecutive runs of the vector.
+///
+template<typename OPS>
+void wmat_mul_i4(float * dst, const float * vec, const uint8_t * mat, size_t N, size_t M) {
+	const size_t W = OPS::width;
+	const size_t half = (N + 1) / 2;
+	const float * vec_hi = vec + half;
+	size_t k, j;
+
+	for (j = 0; j < M; j += 2) {
+		const uint8_t * m0 = mat + j * half;
+		const uint8_t * m1 = j + 1 < M ? m0 + half : m0;
+		// separate accumulators for the low and high nibbles, so that the additions don't wait on each other
+		typename OPS::vf acc0 = OPS::zero(), acc1 = OPS::zero(), acc2 = OPS::zero(), acc3 = OPS::zero();
+		typename OPS::vf lo, hi;
+
+		for (k = 0; k + W <= N - half; k += W) {
+			const typename OPS::vf v_lo = OPS::load(vec + k);
+			const typename OPS::vf v_hi = OPS::load(vec_hi + k);
+			OPS::load_i4(m0 + k, lo, hi);
+			acc0 = OPS::madd(v_lo, lo, acc0);
+			acc1 = OPS::madd(v_hi, hi, acc1);
+			OPS::load_i4(m1 + k, lo, hi);
+			acc2 = OPS::madd(v_lo, lo, acc2);
+			acc3 = OPS::madd(v_hi, hi, acc3);
+		}
+		float a0 = OPS::hsum(OPS::add(acc0, acc1)), a1 = OPS::hsum(OPS::add(acc2, acc3));
+		for (; k < half; k++) {
+			simd::scalar_ops::vf l, h;
+			simd::scalar_ops::load_i4(m0 + k, l, h);
+			a0 += vec[k] * l;
+			if (k + half < N)
+				a0 += vec_hi[k] * h;
+			simd::scalar_ops::load_i4(m1 + k, l, h);
+			a1 += vec[k] * l;
+			if (k + half < N)
+				a1 += vec_hi[k] * h;
+		}
+		dst[j] = a0;
+		if (j + 1 < M)
+			dst[j + 1] = a1;
+	}
+}
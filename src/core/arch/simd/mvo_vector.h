@@ -0,0 +1,22 @@
+///
+/// SIMD vector kernels. See mvo_array.h
+///
+
+template<typename OPS>
+float dot_product(const float * a, const float * b, size_t num) {
+	const size_t W = OPS::width;
+	typename OPS::vf acc0 = OPS::zero(), acc1 = OPS::zero(), acc2 = OPS::zero(), acc3 = OPS::zero();
+	size_t i = 0;
+	for (; i + 4 * W <= num; i += 4 * W) {
+		acc0 = OPS::madd(OPS::load(a + i), OPS::load(b + i), acc0);
+		acc1 = OPS::madd(OPS::load(a + i + W), OPS::load(b + i + W), acc1);
+		acc2 = OPS::madd(OPS::load(a + i + 2 * W), OPS::load(b + i + 2 * W), acc2);
+		acc3 = OPS::madd(OPS::load(a + i + 3 * W), OPS::load(b + i + 3 * W), acc3);
+	}
+	for (; i + W <= num; i += W)
+		acc0 = OPS::madd(OPS::load(a + i), OPS::load(b + i), acc0);
+	float acc = OPS::hsum(OPS::add(OPS::add(acc0, acc1), OPS::add(acc2, acc3)));
+	for (; i < num; i++)
+		acc += a[i] * b[i];
+	return acc;
+}
@@ -0,0 +1,47 @@
+#if !defined(ENN_X86_SSE_MVO_FIXED_H)
+#define ENN_X86_SSE_MVO_FIXED_H
+
+#include <stdint.h>
+#include "../../FixedPointType.h"
+
+///
+/// x86 kernels for FixedPointType<int16_t, EXPONENT>, see arch/simd/mvo_fixed.h.
+/// Eight (SSE4.1) or sixteen (AVX2, AVX-512) values are processed at once, bit exact with the pure kernels.
+/// The dot products (and through them mat_mul and the convolutions) are bound to the raw kernels of
+/// arch/pure/mvo_fixed.h. Element-wise division and exponents above 16 fall back to the pure kernels.
+///
+namespace EasyNeuralNetworks {
+
+template<int EXPONENT>
+inline void kernel_arr_binary(ENN_ARR_OP op, bool add, FixedPointType<int16_t, EXPONENT> * dst, const FixedPointType<int16_t, EXPONENT> * a, const FixedPointType<int16_t, EXPONENT> * b, size_t num) {
+	if (EXPONENT > 16 || !ENN_X86_FKERNEL(fixed16_arr)(op, add, (int16_t *)dst, (const int16_t *)a, (const int16_t *)b, 0, num, EXPONENT))
+		kernel_arr_binary<FixedPointType<int16_t, EXPONENT> >(op, add, dst, a, b, num);
+}
+
+template<int EXPONENT>
+inline void kernel_arr_const(ENN_ARR_OP op, bool add, FixedPointType<int16_t, EXPONENT> * dst, const FixedPointType<int16_t, EXPONENT> * a, FixedPointType<int16_t, EXPONENT> c, size_t num) {
+	if (EXPONENT > 16 || !ENN_X86_FKERNEL(fixed16_arr)(op, add, (int16_t *)dst, (const int16_t *)a, NULL, c.get_raw(), num, EXPONENT))
+		kernel_arr_const<FixedPointType<int16_t, EXPONENT> >(op, add, dst, a, c, num);
+}
+
+template<>
+inline int32_t kernel_fixed_dot<int16_t>(const int16_t * a, const int16_t * b, size_t num) {
+	return ENN_X86_FKERNEL(fixed16_dot)(a, b, num);
+}
+
+template<>
+inline void kernel_fixed_mat_mul<int16_t>(int16_t * dst, const int16_t * vec, const int16_t * mat, size_t N, size_t M, bool bias, bool add, int shift) {
+	ENN_X86_FKERNEL(fixed16_mat_mul)(dst, vec, mat, N, M, bias, add, shift);
+}
+
+template<int EXPONENT>
+inline void kernel_mat_mul_transposed(FixedPointType<int16_t, EXPONENT> * dst, const FixedPointType<int16_t, EXPONENT> * vec, const FixedPointType<int16_t, EXPONENT> * mat, size_t N, size_t M, bool bias, bool add) {
+	if (EXPONENT > 16)
+		kernel_mat_mul_transposed<FixedPointType<int16_t, EXPONENT> >(dst, vec, mat, N, M, bias, add);
+	else
+		ENN_X86_FKERNEL(fixed16_mat_mul_transposed)((int16_t *)dst, (const int16_t *)vec, (const int16_t *)mat, N, M, bias, add, EXPONENT);
+}
+
+};
+
+#endif
@@ -0,0 +1,383 @@
+#if !defined(ENN_X86_SSE_MVO_KERNELS_H)
+#define ENN_X86_SSE_MVO_KERNELS_H
+
+#include "mvo_ops.h"
+
+///
+/// Binds the x86 kernels to the unit stride kernels of arch/pure for float (and int8_t for the quantized layers,
+/// FixedPointType<int16_t, EXPONENT> in mvo_fixed.h).
+///
+/// By default the kernels are compiled for the widest instruction set enabled
+/// by the compiler flags (-msse4.1, -mavx2 -mfma, -mavx512f).
+///
+/// With ENN_ARCH_X86_DISPATCH defined the kernels are compiled for every
+/// instruction set (pure, SSE4.1, AVX2+FMA+F16C and AVX-512) and the best one supported
+/// by the cpu is selected through a function table on the first call.
+///
+namespace EasyNeuralNetworks {
+namespace x86_sse {
+
+#if !defined(ENN_ARCH_X86_DISPATCH)
+
+namespace native {
+#include "../simd/mvo_array.h"
+#include "../simd/mvo_vector.h"
+#include "../simd/mvo_matrix.h"
+#include "../simd/mvo_conv.h"
+#include "../simd/mvo_math.h"
+#include "../simd/mvo_quant.h"
+#include "../simd/mvo_fixed.h"
+#include "../simd/mvo_half.h"
+};
+
+inline const char * arch_name() { return native_ops::name(); }
+
+#define ENN_X86_KERNEL(NAME) x86_sse::native::NAME<x86_sse::native_ops>
+#define ENN_X86_QKERNEL(NAME) x86_sse::native::NAME<x86_sse::native_qops>
+#define ENN_X86_FKERNEL(NAME) x86_sse::native::NAME<x86_sse::native_fixed16_ops>
+
+#else
+
+struct kernel_table {
+	const char * name;
+	void (*arr_binary)(ENN_ARR_OP op, bool add, float * dst, const float * a, const float * b, size_t num);
+	void (*arr_const)(ENN_ARR_OP op, bool add, float * dst, const float * a, float c, size_t num);
+	float (*sum_arr)(const float * a, size_t num);
+	float (*sqrsum_arr)(const float * a, size_t num);
+	void (*shifted_sums_arr)(float * Ex, float * Ex2, const float * a, float K, size_t num);
+	float (*minmax_arr)(bool is_min, size_t * index, const float * a, size_t num);
+	float (*dot_product)(const float * a, const float * b, size_t num);
+	void (*mat_mul)(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, bool add);
+	void (*mat_mul_relu)(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, float negative_d);
+	void (*mat_mul_transposed)(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, bool add);
+	void (*mat_mul_batch)(float * dst, const float * vec, const float * mat, size_t N, size_t M, size_t B, bool bias, bool add);
+	void (*mat_mul_transposed_batch)(float * dst, const float * vec, const float * mat, size_t N, size_t M, size_t B, bool bias, bool add);
+	void (*outer_product_batch)(float * dst, const float * u, const float * v, size_t N, size_t M, size_t B, bool bias);
+	void (*mat_transpose)(float * dst, const float * src, size_t width, size_t height);
+	void (*convolve_1d)(float * dst, const float * vec, const float * kernel, size_t N, size_t M, size_t stride);
+	void (*convolve_2d)(float * dst, const float * mat, const float * kernel, size_t N, size_t M, size_t K, size_t L, size_t stride);
+	void (*convolve_2d_multi)(float * dst, const float * mat, const float * kernel, size_t row, size_t N, size_t M, size_t C, size_t K, size_t L, size_t F, size_t stride);
+	void (*fft_butterfly)(float * ar, float * ai, float * br, float * bi, float wr, float wi, size_t num);
+	void (*complex_madd)(float * dr, float * di, const float * ar, const float * ai, float cr, float ci, size_t num);
+	void (*math_arr)(ENN_MATH_FUNC func, ENN_MATH_ACCURACY accuracy, float * dst, const float * a, size_t num);
+	void (*math_grad_arr)(ENN_MATH_FUNC func, ENN_MATH_ACCURACY accuracy, float * dst, const float * a, size_t num);
+	void (*relu_arr)(float * dst, const float * a, float negative_d, size_t num);
+	void (*qmat_mul)(int32_t * dst, const int8_t * vec, const int8_t * mat, size_t N, size_t M);
+	void (*wmat_mul_i8)(float * dst, const float * vec, const int8_t * mat, size_t N, size_t M);
+	void (*wmat_mul_i4)(float * dst, const float * vec, const uint8_t * mat, size_t N, size_t M);
+	bool (*fixed16_arr)(ENN_ARR_OP op, bool add, int16_t * dst, const int16_t * a, const int16_t * B, int16_t b, size_t num, int shift);
+	int32_t (*fixed16_dot)(const int16_t * a, const int16_t * b, size_t num);
+	void (*fixed16_mat_mul)(int16_t * dst, const int16_t * vec, const int16_t * mat, size_t N, size_t M, bool bias, bool add, int shift);
+	void (*fixed16_mat_mul_transposed)(int16_t * dst, const int16_t * vec, const int16_t * mat, size_t N, size_t M, bool bias, bool add, int shift);
+	void (*hmat_mul_f16)(float * dst, const float * vec, const uint16_t * mat, size_t N, size_t M, bool bias, bool add);
+	void (*hmat_mul_bf16)(float * dst, const float * vec, const uint16_t * mat, size_t N, size_t M, bool bias, bool add);
+};
+
+#define ENN_X86_KERNEL_TABLE(NAMESPACE, OPS, FOPS, QMAT_MUL, NAME) \
+	namespace NAMESPACE { \
+		inline const kernel_table * table() { \
+			static const kernel_table t = { \
+				NAME, \
+				&arr_binary<OPS>, \
+				&arr_const<OPS>, \
+				&sum_arr<OPS>, \
+				&sqrsum_arr<OPS>, \
+				&shifted_sums_arr<OPS>, \
+				&minmax_arr<OPS>, \
+				&dot_product<OPS>, \
+				&mat_mul<OPS>, \
+				&mat_mul_relu<OPS>, \
+				&mat_mul_transposed<OPS>, \
+				&mat_mul_batch<OPS>, \
+				&mat_mul_transposed_batch<OPS>, \
+				&outer_product_batch<OPS>, \
+				&mat_transpose<OPS>, \
+				&convolve_1d<OPS>, \
+				&convolve_2d<OPS>, \
+				&convolve_2d_multi<OPS>, \
+				&fft_butterfly<OPS>, \
+				&complex_madd<OPS>, \
+				&math_arr<OPS>, \
+				&math_grad_arr<OPS>, \
+				&relu_arr<OPS>, \
+				QMAT_MUL, \
+				&wmat_mul_i8<OPS>, \
+				&wmat_mul_i4<OPS>, \
+				&fixed16_arr<FOPS>, \
+				&fixed16_dot<FOPS>, \
+				&fixed16_mat_mul<FOPS>, \
+				&fixed16_mat_mul_transposed<FOPS>, \
+				&hmat_mul_f16<OPS>, \
+				&hmat_mul_bf16<OPS>, \
+			}; \
+			return &t; \
+		} \
+	};
+
+namespace pure {
+#include "../simd/mvo_array.h"
+#include "../simd/mvo_vector.h"
+#include "../simd/mvo_matrix.h"
+#include "../simd/mvo_conv.h"
+#include "../simd/mvo_math.h"
+#include "../simd/mvo_quant.h"
+#include "../simd/mvo_fixed.h"
+#include "../simd/mvo_half.h"
+};
+
+ENN_X86_TARGET_BEGIN("sse4.1")
+namespace sse41 {
+#include "../simd/mvo_array.h"
+#include "../simd/mvo_vector.h"
+#include "../simd/mvo_matrix.h"
+#include "../simd/mvo_conv.h"
+#include "../simd/mvo_math.h"
+#include "../simd/mvo_quant.h"
+#include "../simd/mvo_fixed.h"
+#include "../simd/mvo_half.h"
+};
+ENN_X86_TARGET_END
+
+ENN_X86_TARGET_BEGIN("avx2,fma,f16c")
+namespace avx2 {
+#include "../simd/mvo_array.h"
+#include "../simd/mvo_vector.h"
+#include "../simd/mvo_matrix.h"
+#include "../simd/mvo_conv.h"
+#include "../simd/mvo_math.h"
+#include "../simd/mvo_quant.h"
+#include "../simd/mvo_fixed.h"
+#include "../simd/mvo_half.h"
+};
+ENN_X86_TARGET_END
+
+ENN_X86_TARGET_BEGIN("avx512f,avx2,fma")
+namespace avx512 {
+#include "../simd/mvo_array.h"
+#include "../simd/mvo_vector.h"
+#include "../simd/mvo_matrix.h"
+#include "../simd/mvo_conv.h"
+#include "../simd/mvo_math.h"
+#include "../simd/mvo_quant.h"
+#include "../simd/mvo_fixed.h"
+#include "../simd/mvo_half.h"
+};
+ENN_X86_TARGET_END
+
+ENN_X86_TARGET_BEGIN("avx512f,avx512bw,avx512vnni,avx2,fma")
+namespace avx512vnni {
+#include "../simd/mvo_quant.h"
+};
+ENN_X86_TARGET_END
+
+/// the float kernels need AVX-512F only, the int8 kernels use AVX-512 VNNI on top of it if available
+inline void avx512_qmat_mul(int32_t * dst, const int8_t * vec, const int8_t * mat, size_t N, size_t M) {
+	static const bool vnni = __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vnni");
+	if (vnni)
+		avx512vnni::qmat_mul<avx512vnni_qops>(dst, vec, mat, N, M);
+	else
+		avx2::qmat_mul<avx2_qops>(dst, vec, mat, N, M);
+}
+
+ENN_X86_KERNEL_TABLE(pure, simd::scalar_ops, simd::scalar_fixed16_ops, &qmat_mul<simd::scalar_qops>, "pure")
+ENN_X86_KERNEL_TABLE(sse41, sse41_ops, sse41_fixed16_ops, &qmat_mul<sse41_qops>, "x86_sse41")
+ENN_X86_KERNEL_TABLE(avx2, avx2_ops, avx2_fixed16_ops, &qmat_mul<avx2_qops>, "x86_avx2")
+ENN_X86_KERNEL_TABLE(avx512, avx512_ops, avx2_fixed16_ops, &avx512_qmat_mul, "x86_avx512")
+
+#undef ENN_X86_KERNEL_TABLE
+
+/// returns kernels of the widest instruction set supported by the cpu
+inline const kernel_table * select_kernels() {
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return avx512::table();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c"))
+		return avx2::table();
+	if (__builtin_cpu_supports("sse4.1"))
+		return sse41::table();
+	return pure::table();
+}
+
+/// kernels in use. The cpu is probed once on the first call.
+inline const kernel_table *& kernels() {
+	static const kernel_table * current = select_kernels();
+	return current;
+}
+
+///
+/// Forces a specific kernel set by name ("pure", "x86_sse41", "x86_avx2" or "x86_avx512"),
+/// e.g. for benchmarking. Returns false if the name is unknown or the cpu does not support it.
+/// NOTE: not thread safe, should be called before any calculations.
+///
+inline bool use_kernels(const char * name) {
+	const kernel_table * tables[] = { avx512::table(), avx2::table(), sse41::table(), pure::table() };
+	const kernel_table * best = select_kernels();
+	bool supported = false;
+
+	for (size_t i = 0; i < sizeof(tables) / sizeof(tables[0]); i++) {
+		supported |= tables[i] == best;
+		if (supported && strcmp(tables[i]->name, name) == 0) {
+			kernels() = tables[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+inline const char * arch_name() { return kernels()->name; }
+
+#define ENN_X86_KERNEL(NAME) x86_sse::kernels()->NAME
+#define ENN_X86_QKERNEL(NAME) x86_sse::kernels()->NAME
+#define ENN_X86_FKERNEL(NAME) x86_sse::kernels()->NAME
+
+#endif
+
+};
+
+template<>
+inline void kernel_arr_binary<float>(ENN_ARR_OP op, bool add, float * dst, const float * a, const float * b, size_t num) {
+	ENN_X86_KERNEL(arr_binary)(op, add, dst, a, b, num);
+}
+
+template<>
+inline void kernel_arr_const<float>(ENN_ARR_OP op, bool add, float * dst, const float * a, float c, size_t num) {
+	ENN_X86_KERNEL(arr_const)(op, add, dst, a, c, num);
+}
+
+template<>
+inline float kernel_sum_arr<float>(const float * a, size_t num) {
+	return ENN_X86_KERNEL(sum_arr)(a, num);
+}
+
+template<>
+inline float kernel_sqrsum_arr<float>(const float * a, size_t num) {
+	return ENN_X86_KERNEL(sqrsum_arr)(a, num);
+}
+
+template<>
+inline void kernel_shifted_sums_arr<float>(float * Ex, float * Ex2, const float * a, float K, size_t num) {
+	ENN_X86_KERNEL(shifted_sums_arr)(Ex, Ex2, a, K, num);
+}
+
+template<>
+inline float kernel_minmax_arr<float>(bool is_min, size_t * index, const float * a, size_t num) {
+	return ENN_X86_KERNEL(minmax_arr)(is_min, index, a, num);
+}
+
+template<>
+inline float kernel_dot_product<float>(const float * a, const float * b, size_t num) {
+	return ENN_X86_KERNEL(dot_product)(a, b, num);
+}
+
+template<>
+inline void kernel_mat_mul<float>(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, bool add) {
+	ENN_X86_KERNEL(mat_mul)(dst, vec, mat, N, M, bias, add);
+}
+
+template<>
+inline void kernel_mat_mul_relu<float>(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, float negative_d) {
+	ENN_X86_KERNEL(mat_mul_relu)(dst, vec, mat, N, M, bias, negative_d);
+}
+
+template<>
+inline void kernel_mat_mul_transposed<float>(float * dst, const float * vec, const float * mat, size_t N, size_t M, bool bias, bool add) {
+	ENN_X86_KERNEL(mat_mul_transposed)(dst, vec, mat, N, M, bias, add);
+}
+
+template<>
+inline void kernel_mat_mul_batch<float>(float * dst, const float * vec, const float * mat, size_t N, size_t M, size_t B, bool bias, bool add) {
+	ENN_X86_KERNEL(mat_mul_batch)(dst, vec, mat, N, M, B, bias, add);
+}
+
+template<>
+inline void kernel_mat_mul_transposed_batch<float>(float * dst, const float * vec, const float * mat, size_t N, size_t M, size_t B, bool bias, bool add) {
+	ENN_X86_KERNEL(mat_mul_transposed_batch)(dst, vec, mat, N, M, B, bias, add);
+}
+
+template<>
+inline void kernel_outer_product_batch<float>(float * dst, const float * u, const float * v, size_t N, size_t M, size_t B, bool bias) {
+	ENN_X86_KERNEL(outer_product_batch)(dst, u, v, N, M, B, bias);
+}
+
+template<>
+inline void kernel_mat_transpose<float>(float * dst, const float * src, size_t width, size_t height) {
+	ENN_X86_KERNEL(mat_transpose)(dst, src, width, height);
+}
+
+template<>
+inline void kernel_convolve_1d<float>(float * dst, const float * vec, const float * kernel, size_t N, size_t M, size_t stride) {
+	ENN_X86_KERNEL(convolve_1d)(dst, vec, kernel, N, M, stride);
+}
+
+template<>
+inline void kernel_convolve_2d<float>(float * dst, const float * mat, const float * kernel, size_t N, size_t M, size_t K, size_t L, size_t stride) {
+	ENN_X86_KERNEL(convolve_2d)(dst, mat, kernel, N, M, K, L, stride);
+}
+
+template<>
+inline void kernel_convolve_2d_multi<float>(float * dst, const float * mat, const float * kernel, size_t row, size_t N, size_t M, size_t C, size_t K, size_t L, size_t F, size_t stride) {
+	ENN_X86_KERNEL(convolve_2d_multi)(dst, mat, kernel, row, N, M, C, K, L, F, stride);
+}
+
+template<>
+inline void kernel_fft_butterfly<float>(float * ar, float * ai, float * br, float * bi, float wr, float wi, size_t num) {
+	ENN_X86_KERNEL(fft_butterfly)(ar, ai, br, bi, wr, wi, num);
+}
+
+template<>
+inline void kernel_complex_madd<float>(float * dr, float * di, const float * ar, const float * ai, float cr, float ci, size_t num) {
+	ENN_X86_KERNEL(complex_madd)(dr, di, ar, ai, cr, ci, num);
+}
+
+template<>
+inline void kernel_math_arr<float>(ENN_MATH_FUNC func, ENN_MATH_ACCURACY accuracy, float * dst, const float * a, size_t num) {
+	ENN_X86_KERNEL(math_arr)(func, accuracy, dst, a, num);
+}
+
+template<>
+inline void kernel_math_grad_arr<float>(ENN_MATH_FUNC func, ENN_MATH_ACCURACY accuracy, float * dst, const float * a, size_t num) {
+	ENN_X86_KERNEL(math_grad_arr)(func, accuracy, dst, a, num);
+}
+
+template<>
+inline void kernel_relu_arr<float>(float * dst, const float * a, float negative_d, size_t num) {
+	ENN_X86_KERNEL(relu_arr)(dst, a, negative_d, num);
+}
+
+template<>
+inline void kernel_qmat_mul<int8_t>(int32_t * dst, const int8_t * vec, const int8_t * mat, size_t N, size_t M) {
+	ENN_X86_QKERNEL(qmat_mul)(dst, vec, mat, N, M);
+}
+
+template<>
+inline void kernel_wmat_mul_i8<float>(float * dst, const float * vec, const int8_t * mat, size_t N, size_t M) {
+	ENN_X86_KERNEL(wmat_mul_i8)(dst, vec, mat, N, M);
+}
+
+template<>
+inline void kernel_wmat_mul_i4<float>(float * dst, const float * vec, const uint8_t * mat, size_t N, size_t M) {
+	ENN_X86_KERNEL(wmat_mul_i4)(dst, vec, mat, N, M);
+}
+
+template<>
+inline void kernel_hmat_mul<float, float16>(float * dst, const float * vec, const float16 * mat, size_t N, size_t M, bool bias, bool add) {
+	ENN_X86_KERNEL(hmat_mul_f16)(dst, vec, reinterpret_cast<const uint16_t *>(mat), N, M, bias, add);
+}
+
+template<>
+inline void kernel_hmat_mul<float, bfloat16>(float * dst, const float * vec, const bfloat16 * mat, size_t N, size_t M, bool bias, bool add) {
+	ENN_X86_KERNEL(hmat_mul_bf16)(dst, vec, reinterpret_cast<const uint16_t *>(mat), N, M, bias, add);
+}
+
+};
+
+/// the instrumented build counts in the pure kernels, see FixedPointStats.h
+#if !defined(ENN_FIXED_POINT_STATS)
+#include "mvo_fixed.h"
+#endif
+
+#undef ENN_X86_KERNEL
+#undef ENN_X86_QKERNEL
+#undef ENN_X86_FKERNEL
+
+#endif
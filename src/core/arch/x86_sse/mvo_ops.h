@@ -0,0 +1,436 @@
+#if !defined(ENN_X86_SSE_MVO_OPS_H)
+#define ENN_X86_SSE_MVO_OPS_H
+
+#include <stdlib.h>
+#include <math.h>
+#include <limits>
+#include <assert.h>
+#include <string.h>
+#include <immintrin.h>
+#include "../simd/mvo_ops.h"
+
+///
+/// Instruction set regions.
+/// With ENN_ARCH_X86_DISPATCH every instruction set is compiled in regardless of
+/// the compiler flags and code between ENN_X86_TARGET_BEGIN/END is generated for
+/// the given target only. Otherwise only the sets enabled by the compiler flags are used.
+///
+#define ENN_X86_PRAGMA(x) _Pragma(#x)
+
+#if defined(ENN_ARCH_X86_DISPATCH) && defined(__clang__)
+#define ENN_X86_TARGET_BEGIN(TARGET) ENN_X86_PRAGMA(clang attribute push(__attribute__((target(TARGET))), apply_to = function))
+#define ENN_X86_TARGET_END ENN_X86_PRAGMA(clang attribute pop)
+#elif defined(ENN_ARCH_X86_DISPATCH)
+#define ENN_X86_TARGET_BEGIN(TARGET) ENN_X86_PRAGMA(GCC push_options) ENN_X86_PRAGMA(GCC target(TARGET))
+#define ENN_X86_TARGET_END ENN_X86_PRAGMA(GCC pop_options)
+#else
+#define ENN_X86_TARGET_BEGIN(TARGET)
+#define ENN_X86_TARGET_END
+#endif
+
+#if defined(ENN_ARCH_X86_DISPATCH) || defined(__SSE4_1__)
+#define ENN_X86_HAS_SSE41
+#endif
+
+#if defined(ENN_ARCH_X86_DISPATCH) || (defined(__AVX2__) && defined(__FMA__))
+#define ENN_X86_HAS_AVX2
+#endif
+
+/// float16 conversion instructions, required by the AVX2 set with ENN_ARCH_X86_DISPATCH
+#if defined(ENN_ARCH_X86_DISPATCH) || defined(__F16C__)
+#define ENN_X86_HAS_F16C
+#endif
+
+#if defined(ENN_ARCH_X86_DISPATCH) || (defined(__AVX512F__) && defined(ENN_X86_HAS_AVX2))
+#define ENN_X86_HAS_AVX512
+#endif
+
+#if defined(ENN_ARCH_X86_DISPATCH) || (defined(__AVX512VNNI__) && defined(__AVX512BW__) && defined(ENN_X86_HAS_AVX512))
+#define ENN_X86_HAS_AVX512VNNI
+#endif
+
+namespace EasyNeuralNetworks {
+namespace x86_sse {
+
+///
+/// x86 vector operation sets, see arch/simd/mvo_ops.h
+///
+
+#if defined(ENN_X86_HAS_SSE41)
+ENN_X86_TARGET_BEGIN("sse4.1")
+struct sse41_ops {
+	typedef __m128 vf;
+	static const size_t width = 4;
+	static inline const char * name() { return "x86_sse41"; }
+	static inline vf load(const float * p) { return _mm_loadu_ps(p); }
+	static inline void store(float * p, vf a) { _mm_storeu_ps(p, a); }
+	static inline __m128i load_i8x4(const void * p) {
+		int32_t a;
+		memcpy(&a, p, sizeof(a));
+		return _mm_cvtepi8_epi32(_mm_cvtsi32_si128(a));
+	}
+	static inline vf load_i8(const int8_t * p) { return _mm_cvtepi32_ps(load_i8x4(p)); }
+	/// the bytes are sign extended, the nibbles are sign extended by shifting them to the top
+	static inline void load_i4(const uint8_t * p, vf& lo, vf& hi) {
+		const __m128i a = load_i8x4(p);
+		lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(a, 28), 28));
+		hi = _mm_cvtepi32_ps(_mm_srai_epi32(a, 4));
+	}
+	/// without F16C the exponent and mantissa are moved to their float position and scaled
+	/// by 2^112, which rebiases the exponent and normalizes subnormals; infinities and NaNs
+	/// get the maximum exponent
+	static inline vf load_f16(const uint16_t * p) {
+#if defined(__F16C__)
+		return _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *)p));
+#else
+		const __m128i h = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)p));
+		const __m128i a = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+		const __m128 f = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(a, 13)), _mm_castsi128_ps(_mm_set1_epi32(0x77800000)));
+		const __m128i inf = _mm_and_si128(_mm_cmpgt_epi32(a, _mm_set1_epi32(0x7bff)), _mm_set1_epi32(0x7f800000));
+		const __m128i sign = _mm_slli_epi32(_mm_xor_si128(h, a), 16);
+		return _mm_or_ps(f, _mm_castsi128_ps(_mm_or_si128(inf, sign)));
+#endif
+	}
+	static inline vf load_bf16(const uint16_t * p) {
+		return _mm_castsi128_ps(_mm_slli_epi32(_mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)p)), 16));
+	}
+	static inline vf set1(float a) { return _mm_set1_ps(a); }
+	static inline vf zero() { return _mm_setzero_ps(); }
+	static inline vf add(vf a, vf b) { return _mm_add_ps(a, b); }
+	static inline vf sub(vf a, vf b) { return _mm_sub_ps(a, b); }
+	static inline vf mul(vf a, vf b) { return _mm_mul_ps(a, b); }
+	static inline vf div(vf a, vf b) { return _mm_div_ps(a, b); }
+	static inline vf madd(vf a, vf b, vf c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	static inline vf max(vf a, vf b) { return _mm_max_ps(a, b); }
+	static inline vf min(vf a, vf b) { return _mm_min_ps(a, b); }
+	/// maxps/minps return the second argument if either is NaN
+	static inline vf clamp(vf a, vf lo, vf hi) { return _mm_min_ps(hi, _mm_max_ps(lo, a)); }
+	static inline float hsum(vf a) {
+		a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+		a = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+		return _mm_cvtss_f32(a);
+	}
+	static inline float hmax(vf a) {
+		a = _mm_max_ps(a, _mm_movehl_ps(a, a));
+		a = _mm_max_ss(a, _mm_shuffle_ps(a, a, 1));
+		return _mm_cvtss_f32(a);
+	}
+	static inline float hmin(vf a) {
+		a = _mm_min_ps(a, _mm_movehl_ps(a, a));
+		a = _mm_min_ss(a, _mm_shuffle_ps(a, a, 1));
+		return _mm_cvtss_f32(a);
+	}
+	static inline void transpose4(float * dst, size_t ld_dst, const float * src, size_t ld_src) {
+		__m128 r0 = _mm_loadu_ps(src), r1 = _mm_loadu_ps(src + ld_src);
+		__m128 r2 = _mm_loadu_ps(src + 2 * ld_src), r3 = _mm_loadu_ps(src + 3 * ld_src);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_storeu_ps(dst, r0);
+		_mm_storeu_ps(dst + ld_dst, r1);
+		_mm_storeu_ps(dst + 2 * ld_dst, r2);
+		_mm_storeu_ps(dst + 3 * ld_dst, r3);
+	}
+	static inline vf nearest(vf a) { return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+	static inline vf pow2(vf n) {
+		return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23));
+	}
+};
+ENN_X86_TARGET_END
+#endif
+
+#if defined(ENN_X86_HAS_AVX2)
+ENN_X86_TARGET_BEGIN("avx2,fma,f16c")
+struct avx2_ops {
+	typedef __m256 vf;
+	static const size_t width = 8;
+	static inline const char * name() { return "x86_avx2"; }
+	static inline vf load(const float * p) { return _mm256_loadu_ps(p); }
+	static inline void store(float * p, vf a) { _mm256_storeu_ps(p, a); }
+	static inline vf load_i8(const int8_t * p) { return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)p))); }
+	static inline void load_i4(const uint8_t * p, vf& lo, vf& hi) {
+		const __m256i a = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)p));
+		lo = _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(a, 28), 28));
+		hi = _mm256_cvtepi32_ps(_mm256_srai_epi32(a, 4));
+	}
+	/// see sse41_ops::load_f16
+	static inline vf load_f16(const uint16_t * p) {
+#if defined(ENN_X86_HAS_F16C)
+		return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)p));
+#else
+		const __m256i h = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)p));
+		const __m256i a = _mm256_and_si256(h, _mm256_set1_epi32(0x7fff));
+		const __m256 f = _mm256_mul_ps(_mm256_castsi256_ps(_mm256_slli_epi32(a, 13)), _mm256_castsi256_ps(_mm256_set1_epi32(0x77800000)));
+		const __m256i inf = _mm256_and_si256(_mm256_cmpgt_epi32(a, _mm256_set1_epi32(0x7bff)), _mm256_set1_epi32(0x7f800000));
+		const __m256i sign = _mm256_slli_epi32(_mm256_xor_si256(h, a), 16);
+		return _mm256_or_ps(f, _mm256_castsi256_ps(_mm256_or_si256(inf, sign)));
+#endif
+	}
+	static inline vf load_bf16(const uint16_t * p) {
+		return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)p)), 16));
+	}
+	static inline vf set1(float a) { return _mm256_set1_ps(a); }
+	static inline vf zero() { return _mm256_setzero_ps(); }
+	static inline vf add(vf a, vf b) { return _mm256_add_ps(a, b); }
+	static inline vf sub(vf a, vf b) { return _mm256_sub_ps(a, b); }
+	static inline vf mul(vf a, vf b) { return _mm256_mul_ps(a, b); }
+	static inline vf div(vf a, vf b) { return _mm256_div_ps(a, b); }
+	static inline vf madd(vf a, vf b, vf c) { return _mm256_fmadd_ps(a, b, c); }
+	static inline vf max(vf a, vf b) { return _mm256_max_ps(a, b); }
+	static inline vf min(vf a, vf b) { return _mm256_min_ps(a, b); }
+	static inline vf clamp(vf a, vf lo, vf hi) { return _mm256_min_ps(hi, _mm256_max_ps(lo, a)); }
+	static inline float hsum(vf a) {
+		__m128 b = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+		b = _mm_add_ps(b, _mm_movehl_ps(b, b));
+		b = _mm_add_ss(b, _mm_shuffle_ps(b, b, 1));
+		return _mm_cvtss_f32(b);
+	}
+	static inline float hmax(vf a) {
+		__m128 b = _mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+		b = _mm_max_ps(b, _mm_movehl_ps(b, b));
+		b = _mm_max_ss(b, _mm_shuffle_ps(b, b, 1));
+		return _mm_cvtss_f32(b);
+	}
+	static inline float hmin(vf a) {
+		__m128 b = _mm_min_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+		b = _mm_min_ps(b, _mm_movehl_ps(b, b));
+		b = _mm_min_ss(b, _mm_shuffle_ps(b, b, 1));
+		return _mm_cvtss_f32(b);
+	}
+	static inline void transpose4(float * dst, size_t ld_dst, const float * src, size_t ld_src) {
+		sse41_ops::transpose4(dst, ld_dst, src, ld_src);
+	}
+	static inline vf nearest(vf a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+	static inline vf pow2(vf n) {
+		return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23));
+	}
+};
+ENN_X86_TARGET_END
+#endif
+
+#if defined(ENN_X86_HAS_AVX512)
+ENN_X86_TARGET_BEGIN("avx512f,avx2,fma")
+struct avx512_ops {
+	typedef __m512 vf;
+	static const size_t width = 16;
+	static inline const char * name() { return "x86_avx512"; }
+	static inline vf load(const float * p) { return _mm512_loadu_ps(p); }
+	static inline void store(float * p, vf a) { _mm512_storeu_ps(p, a); }
+	static inline vf load_i8(const int8_t * p) {
+		return _mm512_maskz_cvtepi32_ps(0xffff, _mm512_maskz_cvtepi8_epi32(0xffff, _mm_loadu_si128((const __m128i *)p)));
+	}
+	static inline void load_i4(const uint8_t * p, vf& lo, vf& hi) {
+		const __m512i a = _mm512_maskz_cvtepi8_epi32(0xffff, _mm_loadu_si128((const __m128i *)p));
+		lo = _mm512_maskz_cvtepi32_ps(0xffff, _mm512_maskz_srai_epi32(0xffff, _mm512_maskz_slli_epi32(0xffff, a, 28), 28));
+		hi = _mm512_maskz_cvtepi32_ps(0xffff, _mm512_maskz_srai_epi32(0xffff, a, 4));
+	}
+	static inline vf load_f16(const uint16_t * p) { return _mm512_maskz_cvtph_ps(0xffff, _mm256_loadu_si256((const __m256i *)p)); }
+	static inline vf load_bf16(const uint16_t * p) {
+		return _mm512_castsi512_ps(_mm512_maskz_slli_epi32(0xffff, _mm512_maskz_cvtepu16_epi32(0xffff, _mm256_loadu_si256((const __m256i *)p)), 16));
+	}
+	static inline vf set1(float a) { return _mm512_set1_ps(a); }
+	static inline vf zero() { return _mm512_setzero_ps(); }
+	static inline vf add(vf a, vf b) { return _mm512_add_ps(a, b); }
+	static inline vf sub(vf a, vf b) { return _mm512_sub_ps(a, b); }
+	static inline vf mul(vf a, vf b) { return _mm512_mul_ps(a, b); }
+	static inline vf div(vf a, vf b) { return _mm512_div_ps(a, b); }
+	static inline vf madd(vf a, vf b, vf c) { return _mm512_fmadd_ps(a, b, c); }
+	static inline vf max(vf a, vf b) { return _mm512_maskz_max_ps(0xffff, a, b); }
+	static inline vf min(vf a, vf b) { return _mm512_maskz_min_ps(0xffff, a, b); }
+	static inline vf clamp(vf a, vf lo, vf hi) { return min(hi, max(lo, a)); }
+	static inline float hsum(vf a) {
+		a = _mm512_add_ps(a, lanes<0x4e>(a));
+		a = _mm512_add_ps(a, lanes<0xb1>(a));
+		a = _mm512_add_ps(a, in_lane<0x4e>(a));
+		a = _mm512_add_ps(a, in_lane<0xb1>(a));
+		return _mm512_cvtss_f32(a);
+	}
+	static inline float hmax(vf a) {
+		a = _mm512_maskz_max_ps(0xffff, a, lanes<0x4e>(a));
+		a = _mm512_maskz_max_ps(0xffff, a, lanes<0xb1>(a));
+		a = _mm512_maskz_max_ps(0xffff, a, in_lane<0x4e>(a));
+		a = _mm512_maskz_max_ps(0xffff, a, in_lane<0xb1>(a));
+		return _mm512_cvtss_f32(a);
+	}
+	static inline float hmin(vf a) {
+		a = _mm512_maskz_min_ps(0xffff, a, lanes<0x4e>(a));
+		a = _mm512_maskz_min_ps(0xffff, a, lanes<0xb1>(a));
+		a = _mm512_maskz_min_ps(0xffff, a, in_lane<0x4e>(a));
+		a = _mm512_maskz_min_ps(0xffff, a, in_lane<0xb1>(a));
+		return _mm512_cvtss_f32(a);
+	}
+	static inline void transpose4(float * dst, size_t ld_dst, const float * src, size_t ld_src) {
+		sse41_ops::transpose4(dst, ld_dst, src, ld_src);
+	}
+	static inline vf nearest(vf a) { return _mm512_maskz_roundscale_ps(0xffff, a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+	static inline vf pow2(vf n) {
+		return _mm512_castsi512_ps(_mm512_maskz_slli_epi32(0xffff, _mm512_add_epi32(_mm512_maskz_cvtps_epi32(0xffff, n), _mm512_set1_epi32(127)), 23));
+	}
+private:
+	/// permutes 128 bit lanes and floats within the lanes respectively.
+	/// NOTE: maskz variants are used here and wherever gcc implements the plain intrinsic
+	/// with an undefined source (min/max, rounding, conversions, shifts), since the plain
+	/// ones trigger -Wmaybe-uninitialized in some gcc versions
+	template<int IMM>
+	static inline vf lanes(vf a) { return _mm512_maskz_shuffle_f32x4(0xffff, a, a, IMM); }
+	template<int IMM>
+	static inline vf in_lane(vf a) { return _mm512_maskz_permute_ps(0xffff, a, IMM); }
+};
+ENN_X86_TARGET_END
+#endif
+
+///
+/// x86 int8 operation sets, see scalar_qops in arch/simd/mvo_ops.h.
+/// SSE4.1 and AVX2 widen both operands to int16 and use pmaddwd, which sums pairs of
+/// products into int32 exactly. AVX-512 VNNI multiplies unsigned by signed bytes (vpdpbusd),
+/// so the vector is offset by 128 and 128 * SUM of the row is subtracted again.
+///
+
+#if defined(ENN_X86_HAS_SSE41)
+ENN_X86_TARGET_BEGIN("sse4.1")
+struct sse41_qops {
+	typedef __m128i vi;
+	typedef __m128i vx;
+	typedef simd::scalar_qops tail;
+	static const size_t width = 8;
+	static inline vi zero() { return _mm_setzero_si128(); }
+	static inline vx prepare(const int8_t * p) { return _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i *)p)); }
+	static inline vi madd(vx x, const int8_t * p, vi acc) { return _mm_add_epi32(acc, _mm_madd_epi16(x, prepare(p))); }
+	static inline int32_t hsum(vi a) {
+		a = _mm_add_epi32(a, _mm_shuffle_epi32(a, 0x4e));
+		a = _mm_add_epi32(a, _mm_shuffle_epi32(a, 0xb1));
+		return _mm_cvtsi128_si32(a);
+	}
+};
+ENN_X86_TARGET_END
+#endif
+
+#if defined(ENN_X86_HAS_AVX2)
+ENN_X86_TARGET_BEGIN("avx2,fma")
+struct avx2_qops {
+	typedef __m256i vi;
+	typedef __m256i vx;
+	typedef sse41_qops tail;
+	static const size_t width = 16;
+	static inline vi zero() { return _mm256_setzero_si256(); }
+	static inline vx prepare(const int8_t * p) { return _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)p)); }
+	static inline vi madd(vx x, const int8_t * p, vi acc) { return _mm256_add_epi32(acc, _mm256_madd_epi16(x, prepare(p))); }
+	static inline int32_t hsum(vi a) {
+		return sse41_qops::hsum(_mm_add_epi32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1)));
+	}
+};
+ENN_X86_TARGET_END
+#endif
+
+#if defined(ENN_X86_HAS_AVX512VNNI)
+ENN_X86_TARGET_BEGIN("avx512f,avx512bw,avx512vnni,avx2,fma")
+struct avx512vnni_qops {
+	/// products of the offset vector and the sums of the rows times 128
+	struct vi {
+		__m512i dot;
+		__m512i sum;
+	};
+	typedef __m512i vx;
+	typedef avx2_qops tail;
+	static const size_t width = 64;
+	static inline vi zero() { vi a = { _mm512_setzero_si512(), _mm512_setzero_si512() }; return a; }
+	static inline vx prepare(const int8_t * p) { return _mm512_xor_si512(_mm512_loadu_si512(p), _mm512_set1_epi8((char)0x80)); }
+	static inline vi madd(vx x, const int8_t * p, vi acc) {
+		const __m512i w = _mm512_loadu_si512(p);
+		acc.dot = _mm512_dpbusd_epi32(acc.dot, x, w);
+		acc.sum = _mm512_dpbusd_epi32(acc.sum, _mm512_set1_epi8((char)0x80), w);
+		return acc;
+	}
+	static inline int32_t hsum(vi a) {
+		const __m512i d = _mm512_sub_epi32(a.dot, a.sum);
+		return avx2_qops::hsum(_mm256_add_epi32(_mm512_maskz_extracti64x4_epi64(0xff, d, 0), _mm512_maskz_extracti64x4_epi64(0xff, d, 1)));
+	}
+};
+ENN_X86_TARGET_END
+#endif
+
+///
+/// x86 FixedPointType<int16_t, EXPONENT> operation sets, see scalar_fixed16_ops in arch/simd/mvo_ops.h.
+/// pmullw and pmulhw give the low and high halves of the 32 bit products, the 16 bits
+/// of the shifted product are (low >> shift) | (high << (16 - shift)).
+/// pmaddwd accumulates the products of pairs of values in 32 bit.
+///
+
+#if defined(ENN_X86_HAS_SSE41)
+ENN_X86_TARGET_BEGIN("sse4.1")
+struct sse41_fixed16_ops {
+	typedef __m128i vi;
+	static const size_t width = 8;
+	static inline vi load(const int16_t * p) { return _mm_loadu_si128((const __m128i *)p); }
+	static inline void store(int16_t * p, vi a) { _mm_storeu_si128((__m128i *)p, a); }
+	static inline vi set1(int16_t a) { return _mm_set1_epi16(a); }
+	static inline vi zero() { return _mm_setzero_si128(); }
+	static inline vi add(vi a, vi b) { return _mm_add_epi16(a, b); }
+	static inline vi sub(vi a, vi b) { return _mm_sub_epi16(a, b); }
+	static inline vi mul(vi a, vi b, int shift) {
+		return _mm_or_si128(_mm_srl_epi16(_mm_mullo_epi16(a, b), _mm_cvtsi32_si128(shift)),
+			_mm_sll_epi16(_mm_mulhi_epi16(a, b), _mm_cvtsi32_si128(16 - shift)));
+	}
+	typedef __m128i vw;
+	static inline vw wzero() { return _mm_setzero_si128(); }
+	static inline vw wadd(vw a, vw b) { return _mm_add_epi32(a, b); }
+	static inline vw madd(vw acc, vi a, vi b) { return _mm_add_epi32(acc, _mm_madd_epi16(a, b)); }
+	static inline int32_t hsum(vw a) {
+		a = _mm_add_epi32(a, _mm_shuffle_epi32(a, 0x4e));
+		a = _mm_add_epi32(a, _mm_shuffle_epi32(a, 0xb1));
+		return _mm_cvtsi128_si32(a);
+	}
+};
+ENN_X86_TARGET_END
+#endif
+
+#if defined(ENN_X86_HAS_AVX2)
+ENN_X86_TARGET_BEGIN("avx2,fma")
+struct avx2_fixed16_ops {
+	typedef __m256i vi;
+	static const size_t width = 16;
+	static inline vi load(const int16_t * p) { return _mm256_loadu_si256((const __m256i *)p); }
+	static inline void store(int16_t * p, vi a) { _mm256_storeu_si256((__m256i *)p, a); }
+	static inline vi set1(int16_t a) { return _mm256_set1_epi16(a); }
+	static inline vi zero() { return _mm256_setzero_si256(); }
+	static inline vi add(vi a, vi b) { return _mm256_add_epi16(a, b); }
+	static inline vi sub(vi a, vi b) { return _mm256_sub_epi16(a, b); }
+	static inline vi mul(vi a, vi b, int shift) {
+		return _mm256_or_si256(_mm256_srl_epi16(_mm256_mullo_epi16(a, b), _mm_cvtsi32_si128(shift)),
+			_mm256_sll_epi16(_mm256_mulhi_epi16(a, b), _mm_cvtsi32_si128(16 - shift)));
+	}
+	typedef __m256i vw;
+	static inline vw wzero() { return _mm256_setzero_si256(); }
+	static inline vw wadd(vw a, vw b) { return _mm256_add_epi32(a, b); }
+	static inline vw madd(vw acc, vi a, vi b) { return _mm256_add_epi32(acc, _mm256_madd_epi16(a, b)); }
+	static inline int32_t hsum(vw a) {
+		return sse41_fixed16_ops::hsum(_mm_add_epi32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1)));
+	}
+};
+ENN_X86_TARGET_END
+#endif
+
+#if !defined(ENN_ARCH_X86_DISPATCH)
+#if defined(ENN_X86_HAS_AVX512)
+typedef avx512_ops native_ops;
+#elif defined(ENN_X86_HAS_AVX2)
+typedef avx2_ops native_ops;
+#else
+typedef sse41_ops native_ops;
+#endif
+#if defined(ENN_X86_HAS_AVX512VNNI)
+typedef avx512vnni_qops native_qops;
+#elif defined(ENN_X86_HAS_AVX2)
+typedef avx2_qops native_qops;
+#else
+typedef sse41_qops native_qops;
+#endif
+#if defined(ENN_X86_HAS_AVX2)
+typedef avx2_fixed16_ops native_fixed16_ops;
+#else
+typedef sse41_fixed16_ops native_fixed16_ops;
+#endif
+#endif
+
+};
+};
+
+#endif
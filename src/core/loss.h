@@ -41,7 +41,9 @@ template<typename T, typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
 class L2Loss : public LossFunctionBase<T, T_SIZE> {
 public:
 	virtual T operator () (tensor<T, T_SIZE>& deltas, const tensor<T, T_SIZE>& target, const tensor<T, T_SIZE>& output) const {
-		ENN_LOSS_LOOP(*O - *Ta, *D * *D)
+		assert(deltas.size() == target.size() && deltas.size() == output.size());
+		diff_arr<T, T_SIZE>(deltas.data(), output.data(), target.data(), output.size());
+		return sqrsum_arr<T, T_SIZE>(deltas.data(), deltas.size());
 	}
 };
 
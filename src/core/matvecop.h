@@ -7,10 +7,103 @@
 
 #define ENN_BIAS (BIAS?1:0)
 
+///
+/// Architecture selection.
+/// Pure C++ implementations are always included and are used for any type
+/// the selected architecture has no kernels for.
+/// Define ENN_ARCH_PURE to disable architecture specific kernels altogether.
+/// Define ENN_ARCH_X86_DISPATCH to select x86 kernels at runtime based on the cpu.
+/// NEON kernels are used whenever the compiler targets NEON (__ARM_NEON).
+///
+#if !defined(ENN_ARCH_PURE) && !defined(ENN_ARCH_X86_SSE) && \
+		(defined(__SSE4_1__) || defined(__AVX2__) || (defined(ENN_ARCH_X86_DISPATCH) && (defined(__x86_64__) || defined(__i386__))))
+#define ENN_ARCH_X86_SSE
+#endif
+
+#if !defined(ENN_ARCH_PURE) && !defined(ENN_ARCH_NEON) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define ENN_ARCH_NEON
+#endif
+
+///
+/// Convolution layers lower the input into a matrix of patches (im2row) and run a single
+/// matrix multiplication against all the kernels.
+/// It needs a scratch buffer of (kernel size * channels + 1) x (outputs per kernel),
+/// hence it is enabled by default only on architectures with vector kernels.
+/// Otherwise the direct convolution computes 4 kernels per pass over the input
+/// with no scratch memory (see convolve_2d_multi).
+/// Define ENN_CONV_GEMM to 0 or 1 to override.
+///
+#if !defined(ENN_CONV_GEMM)
+#if defined(ENN_ARCH_X86_SSE) || defined(ENN_ARCH_NEON)
+#define ENN_CONV_GEMM 1
+#else
+#define ENN_CONV_GEMM 0
+#endif
+#endif
+
+///
+/// ConvLayer2D uses Winograd F(2x2, 3x3) for 3x3 kernels with unit stride. Kernels are
+/// transformed once when the weights are bound, the transformed kernels take
+/// 16/9 of the kernel weights and the scratch buffers 4 * (channels + kernels) * outputs.
+/// Enabled by default together with ENN_CONV_GEMM. Define ENN_CONV_WINOGRAD to 0 or 1 to override.
+/// With few input channels the transforms dominate and im2row + GEMM is faster,
+/// ENN_CONV_WINOGRAD_MIN_CHANNELS is the minimal number of input channels to use Winograd for.
+///
+#if !defined(ENN_CONV_WINOGRAD)
+#define ENN_CONV_WINOGRAD ENN_CONV_GEMM
+#endif
+
+#if !defined(ENN_CONV_WINOGRAD_MIN_CHANNELS)
+#define ENN_CONV_WINOGRAD_MIN_CHANNELS (ENN_CONV_GEMM ? 8 : 1)
+#endif
+
+///
+/// ConvLayer1D and ConvLayer2D use FFT overlap-save convolution for floating point types and
+/// unit stride when it is estimated to be faster than the direct convolution (see fft_conv_plan),
+/// i.e. for long 1D kernels and large 2D kernels. Kernel spectra are computed once when the
+/// weights are bound and take 2 * block size / kernel size of the kernel weights, the scratch
+/// buffers take 2 * block size * blocks * (channels + kernels).
+/// Enabled by default together with ENN_CONV_GEMM. Define ENN_CONV_FFT to 0 or 1 to override.
+///
+#if !defined(ENN_CONV_FFT)
+#define ENN_CONV_FFT ENN_CONV_GEMM
+#endif
+
 #include "arch/pure/mvo_array.h"
 #include "arch/pure/mvo_vector.h"
 #include "arch/pure/mvo_matrix.h"
 #include "arch/pure/mvo_conv.h"
+#include "arch/pure/mvo_math.h"
+#include "arch/pure/mvo_fused.h"
+#include "arch/pure/mvo_quant.h"
+#include "arch/pure/mvo_fixed.h"
+#include "arch/pure/mvo_half.h"
+#include "arch/pure/mvo_bfp.h"
+#include "arch/pure/mvo_convert.h"
 #include "arch/pure/mvo_rand.h"
 
+#if defined(ENN_ARCH_X86_SSE)
+#include "arch/x86_sse/mvo_kernels.h"
+#elif defined(ENN_ARCH_NEON)
+#include "arch/neon/mvo_kernels.h"
+#endif
+
+namespace EasyNeuralNetworks {
+
+///
+/// Name of the kernel set in use for float, e.g. "pure" or "x86_avx2".
+/// Useful for startup logs.
+///
+inline const char * mvo_arch_name() {
+#if defined(ENN_ARCH_X86_SSE)
+	return x86_sse::arch_name();
+#elif defined(ENN_ARCH_NEON)
+	return neon::arch_name();
+#else
+	return "pure";
+#endif
+}
+
+};
+
 #endif
@@ -2,6 +2,7 @@
 #define ENN_TENSOR_H
 
 #include <iterator>
+#include <functional>
 #include <assert.h>
 
 
@@ -17,6 +18,8 @@
 
 namespace EasyNeuralNetworks {
 
+namespace expr { template<typename E> struct node; };
+
 ///
 /// implements a three dimentional tensor.
 ///
@@ -129,6 +132,14 @@ public:
 		this->_needs_free = false;
 	}
 
+	/// element-wise evaluation of an expression, e.g. c = f * c + i * g, see core/tensor_expr.h
+	template<typename E> inline tensor<T, T_SIZE>& operator = (const expr::node<E>& e);
+	/// Ai = Ai op Ei, E - a tensor, an expression or a scalar
+	template<typename E> inline tensor<T, T_SIZE>& operator += (const E& e);
+	template<typename E> inline tensor<T, T_SIZE>& operator -= (const E& e);
+	template<typename E> inline tensor<T, T_SIZE>& operator *= (const E& e);
+	template<typename E> inline tensor<T, T_SIZE>& operator /= (const E& e);
+
 	/// raw access stuff
 	inline T* data() { return _data; }
 	inline T* data(T_SIZE z) { return _data + offset(z); }
@@ -263,7 +274,7 @@ public:
 		auto N = size();
 		auto p = data();
 		if (val == 0) {
-			memset(p, sizeof(T) * N, 0);
+			memset(p, 0, sizeof(T) * N);
 			return;
 		}
 		while (N--)
@@ -274,7 +285,7 @@ public:
 		auto N = width() * height();
 		auto p = data(z);
 		if (val == 0) {
-			memset(p, sizeof(T) * N, 0);
+			memset(p, 0, sizeof(T) * N);
 			return;
 		}
 		while (N--)
@@ -285,7 +296,7 @@ public:
 		auto N = width();
 		auto p = data(y, z);
 		if (val == 0) {
-			memset(p, sizeof(T) * N, 0);
+			memset(p, 0, sizeof(T) * N);
 			return;
 		}
 		while (N--)
@@ -297,7 +308,7 @@ public:
 		auto N = size();
 		auto p = data();
 		for (T_SIZE i = 0; i < N; i++) {
-			*p = setter(i++, *p, params);
+			*p = setter(i, *p, params);
 			++p;
 		}
 	}
@@ -336,4 +347,6 @@ public:
 
 };
 
+#include <core/tensor_expr.h>
+
 #endif
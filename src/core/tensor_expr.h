@@ -0,0 +1,210 @@
+#if !defined(ENN_TENSOR_EXPR_H)
+#define ENN_TENSOR_EXPR_H
+
+#include <stdlib.h>
+#include <type_traits>
+
+///
+/// Element-wise expressions are evaluated in blocks of ENN_EXPR_BLOCK values into a local buffer,
+/// which can't alias the operands, so that the compiler vectorizes the loop without runtime checks.
+///
+#if !defined(ENN_EXPR_BLOCK)
+#define ENN_EXPR_BLOCK 64
+#endif
+
+namespace EasyNeuralNetworks {
+
+///
+/// Expression templates over tensor<T, T_SIZE>.
+/// Arithmetic on tensors, expressions and scalars builds an expression instead of computing
+/// intermediate tensors, the expression is evaluated when assigned to a tensor in a single loop, e.g.
+///		c = f * c + i * g;
+/// computes Ci = Fi * Ci + Ii * Gi with no temporaries. The operands must be of the same size.
+/// Only the same element of each operand is accessed, so the destination may be an operand as well.
+/// NOTE: assigning a tensor to a tensor still rebinds the data, see tensor::operator =
+///
+namespace expr {
+
+template<typename E>
+struct node {
+	inline const E& self() const { return static_cast<const E&>(*this); }
+};
+
+/// elements of a tensor
+template<typename T>
+struct leaf : public node<leaf<T> > {
+	typedef T value_type;
+	const T * _data;
+	size_t _size;
+	leaf(const T * data, size_t size) : _data(data), _size(size) {}
+	inline T operator [] (size_t i) const { return _data[i]; }
+	inline size_t size() const { return _size; }
+};
+
+/// a scalar broadcast to every element, size() = 0 matches any size
+template<typename T>
+struct constant : public node<constant<T> > {
+	typedef T value_type;
+	const T _value;
+	constant(T value) : _value(value) {}
+	inline T operator [] (size_t i) const { return _value; }
+	inline size_t size() const { return 0; }
+};
+
+struct op_add { template<typename T> static inline T apply(T a, T b) { return a + b; } };
+struct op_sub { template<typename T> static inline T apply(T a, T b) { return a - b; } };
+struct op_mul { template<typename T> static inline T apply(T a, T b) { return a * b; } };
+struct op_div { template<typename T> static inline T apply(T a, T b) { return a / b; } };
+
+template<typename OP, typename A, typename B>
+struct binary : public node<binary<OP, A, B> > {
+	typedef typename A::value_type value_type;
+	const A _a;
+	const B _b;
+	binary(const A& a, const B& b) : _a(a), _b(b) {}
+	inline value_type operator [] (size_t i) const { return OP::template apply<value_type>(_a[i], _b[i]); }
+	inline size_t size() const { return _a.size() ? _a.size() : _b.size(); }
+};
+
+template<typename A>
+struct negate : public node<negate<A> > {
+	typedef typename A::value_type value_type;
+	const A _a;
+	negate(const A& a) : _a(a) {}
+	inline value_type operator [] (size_t i) const { return -_a[i]; }
+	inline size_t size() const { return _a.size(); }
+};
+
+///
+/// operand<X>::type is the expression of a tensor or an expression,
+/// scalars are wrapped by wrap<X, T>
+///
+template<typename X, typename = void>
+struct operand {
+	static const bool valid = false;
+	typedef void value_type;
+};
+
+template<typename T, typename T_SIZE>
+struct operand<tensor<T, T_SIZE>, void> {
+	static const bool valid = true;
+	typedef T value_type;
+	typedef leaf<T> type;
+	static inline type make(const tensor<T, T_SIZE>& t) { return type(t.data(), t.size()); }
+};
+
+template<typename E>
+struct operand<E, typename std::enable_if<std::is_base_of<node<E>, E>::value>::type> {
+	static const bool valid = true;
+	typedef typename E::value_type value_type;
+	typedef E type;
+	static inline const E& make(const E& e) { return e; }
+};
+
+template<typename X, typename T, bool IS_OPERAND = operand<X>::valid>
+struct wrap {
+	static const bool valid = std::is_arithmetic<X>::value || std::is_same<X, T>::value;
+	typedef constant<T> type;
+	static inline type make(const X& x) { return type((T)x); }
+};
+
+template<typename X, typename T>
+struct wrap<X, T, true> {
+	static const bool valid = std::is_same<typename operand<X>::value_type, T>::value;
+	typedef typename operand<X>::type type;
+	static inline type make(const X& x) { return operand<X>::make(x); }
+};
+
+/// value type of A op B, at least one of them must be a tensor or an expression
+template<typename A, typename B>
+struct binary_traits {
+	typedef typename std::conditional<operand<A>::valid, typename operand<A>::value_type, typename operand<B>::value_type>::type value_type;
+	static const bool valid = (operand<A>::valid || operand<B>::valid) && wrap<A, value_type>::valid && wrap<B, value_type>::valid;
+	typedef typename wrap<A, value_type>::type A_type;
+	typedef typename wrap<B, value_type>::type B_type;
+};
+
+/// DSTi = Ei
+template<typename T, typename E>
+inline void eval(T * dst, const E& e, size_t num) {
+	size_t i = 0;
+	if (std::is_arithmetic<T>::value) {
+		T tmp[ENN_EXPR_BLOCK];
+		for (; i + ENN_EXPR_BLOCK <= num; i += ENN_EXPR_BLOCK) {
+			for (size_t k = 0; k < ENN_EXPR_BLOCK; k++)
+				tmp[k] = e[i + k];
+			for (size_t k = 0; k < ENN_EXPR_BLOCK; k++)
+				dst[i + k] = tmp[k];
+		}
+	}
+	for (; i < num; i++)
+		dst[i] = e[i];
+}
+
+};
+
+#define ENN_EXPR_BINARY_OPERATOR(OP, NAME) \
+	template<typename A, typename B> \
+	inline typename std::enable_if<expr::binary_traits<A, B>::valid, \
+		expr::binary<expr::NAME, typename expr::binary_traits<A, B>::A_type, typename expr::binary_traits<A, B>::B_type> >::type \
+	operator OP (const A& a, const B& b) { \
+		typedef expr::binary_traits<A, B> traits; \
+		return expr::binary<expr::NAME, typename traits::A_type, typename traits::B_type>( \
+			expr::wrap<A, typename traits::value_type>::make(a), expr::wrap<B, typename traits::value_type>::make(b)); \
+	}
+
+ENN_EXPR_BINARY_OPERATOR(+, op_add)
+ENN_EXPR_BINARY_OPERATOR(-, op_sub)
+ENN_EXPR_BINARY_OPERATOR(*, op_mul)
+ENN_EXPR_BINARY_OPERATOR(/, op_div)
+
+#undef ENN_EXPR_BINARY_OPERATOR
+
+template<typename A>
+inline typename std::enable_if<expr::operand<A>::valid, expr::negate<typename expr::operand<A>::type> >::type
+operator - (const A& a) {
+	return expr::negate<typename expr::operand<A>::type>(expr::operand<A>::make(a));
+}
+
+namespace expr {
+using EasyNeuralNetworks::operator +;
+using EasyNeuralNetworks::operator -;
+using EasyNeuralNetworks::operator *;
+using EasyNeuralNetworks::operator /;
+};
+
+template<typename T, typename T_SIZE>
+template<typename E>
+inline tensor<T, T_SIZE>& tensor<T, T_SIZE>::operator = (const expr::node<E>& e) {
+	assert(e.self().size() == 0 || e.self().size() == size());
+	expr::eval(data(), e.self(), size());
+	return *this;
+}
+
+template<typename T, typename T_SIZE>
+template<typename E>
+inline tensor<T, T_SIZE>& tensor<T, T_SIZE>::operator += (const E& e) {
+	return *this = *this + e;
+}
+
+template<typename T, typename T_SIZE>
+template<typename E>
+inline tensor<T, T_SIZE>& tensor<T, T_SIZE>::operator -= (const E& e) {
+	return *this = *this - e;
+}
+
+template<typename T, typename T_SIZE>
+template<typename E>
+inline tensor<T, T_SIZE>& tensor<T, T_SIZE>::operator *= (const E& e) {
+	return *this = *this * e;
+}
+
+template<typename T, typename T_SIZE>
+template<typename E>
+inline tensor<T, T_SIZE>& tensor<T, T_SIZE>::operator /= (const E& e) {
+	return *this = *this / e;
+}
+
+};
+
+#endif
@@ -22,7 +22,7 @@ class AveragePoolingLayer1D : public LayerBase<T, T_SIZE> {
 	T_SIZE _stride;
 	bool training = false;
 public:
-	AveragePoolingLayer1D(T_INPUT& input, T_SIZE width, T_SIZE stride=0) : T_LAYER(input, LUActivation<T>()) {
+	AveragePoolingLayer1D(T_INPUT& input, T_SIZE width, T_SIZE stride=0) : T_LAYER(input, lu_activation<T, T_SIZE>()) {
 		assert(width > 1);
 		_kernel_width = width;
 		if (stride == 0)
@@ -55,13 +55,13 @@ public:
 	virtual void training_begin()
 	{
 		this->gradients().resize(this->inputs());
-		this->widths().resize(this->inputs());
+		this->weights().resize(this->inputs());
 		training = true;
 	}
 	virtual void training_end()
 	{
 		this->gradients().resize(0, 0, 0);
-		this->widths().resize(0, 0, 0);
+		this->weights().resize(0, 0, 0);
 		training = false;
 	}
 
@@ -0,0 +1,65 @@
+#if !defined(ENN_BLOCK_FLOAT_CONV_LAYER_2D_H)
+#define ENN_BLOCK_FLOAT_CONV_LAYER_2D_H
+
+#include <core/BlockFloatLayerBase.h>
+#include <core/matvecop.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// Block floating point 2D convolution, inference only, see BlockFloatLayerBase and ConvLayer2D.
+/// The input has one exponent per channel, so do the outputs.
+///
+/// Imported from the float weights of a ConvLayer2D<float, BIAS>, shape (N * M * C + 1, 1, K).
+/// The mantissas of the weights are organized as one row of N * M * C values per kernel, shape (N * M * C, K, 1),
+/// with one exponent per channel of each kernel, the biases are stored in bias().
+///
+template <typename T = int16_t,
+				  bool BIAS = ENN_DEFAULT_BIAS,
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+class BlockFloatConvLayer2D : public BlockFloatLayerBase<T, T_SIZE> {
+	typedef BlockFloatLayerBase<T, T_SIZE> T_BASE;
+	typedef typename T_BASE::T_INPUT T_INPUT;
+	typedef typename T_BASE::T_EXPONENTS T_EXPONENTS;
+	typedef typename T_BASE::T_FLOAT_INPUT T_FLOAT_INPUT;
+	typedef typename T_BASE::T_FLOAT_ACTIVATION T_FLOAT_ACTIVATION;
+	T_SIZE _stride;
+	T_SIZE _kernel_width;
+	T_SIZE _kernel_height;
+public:
+	BlockFloatConvLayer2D(T_INPUT& input, T_EXPONENTS& input_exponents, T_SIZE kernel_width, T_SIZE kernel_height, T_SIZE num_kernels, T_SIZE stride, const T_FLOAT_INPUT& weights, const T_FLOAT_ACTIVATION& activation)
+		: BlockFloatConvLayer2D(input, input_exponents, kernel_width, kernel_height, num_kernels, stride, activation) {
+		assert(weights.size() == (this->weights().width() + ENN_BIAS) * num_kernels);
+		this->convert_weights(weights.data(), this->weights().width(), BIAS, num_kernels, kernel_width * kernel_height);
+	}
+
+	/// the converted weights are bound later, see BlockFloatLayerBase::weights
+	BlockFloatConvLayer2D(T_INPUT& input, T_EXPONENTS& input_exponents, T_SIZE kernel_width, T_SIZE kernel_height, T_SIZE num_kernels, T_SIZE stride, const T_FLOAT_ACTIVATION& activation)
+		: T_BASE(input, input_exponents, activation) {
+		assert(input_exponents.size() == input.depth());
+		_stride = stride;
+		_kernel_width = kernel_width;
+		_kernel_height = kernel_height;
+		this->outputs().resize((input.width() - kernel_width) / stride + 1, (input.height() - kernel_height) / stride + 1, num_kernels);
+		this->_exponents.resize(num_kernels, 1, 1);
+		this->weights().resize(kernel_width * kernel_height * input.depth(), num_kernels, 1);
+		this->_weight_exponents.resize(input.depth(), num_kernels, 1);
+		this->_acc.resize(this->output_block(), 1, 1);
+	}
+
+	///
+	///
+	///
+	virtual void forward()
+	{
+		bfp_convolve_2d<T, T_SIZE>(this->outputs(), this->_exponents, this->_acc, this->inputs(), this->_input_exponents,
+			this->weights(), this->_weight_exponents, BIAS ? this->_bias.data() : (const T *)NULL, this->_bias_exponents,
+			this->inputs().width(), this->inputs().height(), this->inputs().depth(), _kernel_width, _kernel_height,
+			this->weights().height(), _stride, this->_relu);
+		this->activation_forward();
+	}
+};
+
+};
+
+#endif
@@ -0,0 +1,64 @@
+#if !defined(ENN_BLOCK_FLOAT_DENSE_LAYER_H)
+#define ENN_BLOCK_FLOAT_DENSE_LAYER_H
+
+#include <core/BlockFloatLayerBase.h>
+#include <core/matvecop.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// Block floating point fully connected layer, inference only, see BlockFloatLayerBase.
+/// Can accept any shape of input. Output can be any shape, with one exponent per depth slice.
+///
+/// Imported from the float weights of a DenseLayer<float, BIAS>:
+/// Wij = W[i + j * (N + 1)], i < N, j < M, where i = N is the bias.
+/// The mantissas of the weights are organized as Wij = W[i + j * N], shape (N, M, 1),
+/// with one exponent per block of the input in each row, the biases are stored in bias().
+///
+template <typename T = int16_t,
+				  bool BIAS = ENN_DEFAULT_BIAS,
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+class BlockFloatDenseLayer : public BlockFloatLayerBase<T, T_SIZE> {
+	typedef BlockFloatLayerBase<T, T_SIZE> T_BASE;
+	typedef typename T_BASE::T_INPUT T_INPUT;
+	typedef typename T_BASE::T_EXPONENTS T_EXPONENTS;
+	typedef typename T_BASE::T_FLOAT_INPUT T_FLOAT_INPUT;
+	typedef typename T_BASE::T_FLOAT_ACTIVATION T_FLOAT_ACTIVATION;
+	tensor<int, T_SIZE> _acc_exponents;
+public:
+	BlockFloatDenseLayer(T_INPUT& input, T_EXPONENTS& input_exponents, T_SIZE out_width, const T_FLOAT_INPUT& weights, const T_FLOAT_ACTIVATION& activation)
+		: BlockFloatDenseLayer(input, input_exponents, out_width, 1, 1, weights, activation) { }
+
+	BlockFloatDenseLayer(T_INPUT& input, T_EXPONENTS& input_exponents, T_SIZE out_width, T_SIZE out_height, T_SIZE out_depth, const T_FLOAT_INPUT& weights, const T_FLOAT_ACTIVATION& activation)
+		: BlockFloatDenseLayer(input, input_exponents, out_width, out_height, out_depth, activation) {
+		assert(weights.size() == (input.size() + ENN_BIAS) * this->outputs().size());
+		this->convert_weights(weights.data(), input.size(), BIAS, this->outputs().size(), this->input_block());
+	}
+
+	/// the converted weights are bound later, see BlockFloatLayerBase::weights
+	BlockFloatDenseLayer(T_INPUT& input, T_EXPONENTS& input_exponents, T_SIZE out_width, T_SIZE out_height, T_SIZE out_depth, const T_FLOAT_ACTIVATION& activation)
+		: T_BASE(input, input_exponents, activation)
+	{
+		this->outputs().resize(out_width, out_height, out_depth);
+		this->_exponents.resize(out_depth, 1, 1);
+		this->weights().resize(input.size(), this->outputs().size(), 1);
+		this->_weight_exponents.resize(input_exponents.size(), this->outputs().size(), 1);
+		this->_acc.resize(this->outputs().size(), 1, 1);
+		_acc_exponents.resize(this->outputs().size(), 1, 1);
+	}
+
+	///
+	///
+	///
+	virtual void forward()
+	{
+		bfp_mat_mul<T, T_SIZE>(this->outputs(), this->_exponents, this->_acc, _acc_exponents, this->inputs(), this->_input_exponents,
+			this->weights(), this->_weight_exponents, BIAS ? this->_bias.data() : (const T *)NULL, this->_bias_exponents,
+			this->inputs().size(), this->outputs().size(), this->input_block(), this->output_block(), this->_relu);
+		this->activation_forward();
+	}
+};
+
+};
+
+#endif
@@ -31,7 +31,7 @@ class ConcatLayer : public LayerBase<T, T_SIZE> {
 	ENN_T_LAYER_TYPEDEF(T_LAYER);
 	std::vector<T_INPUT> _inputs;
 public:
-	ConcatLayer(T_SIZE num_layers, ...) : T_LAYER(LUActivation<T>()) {
+	ConcatLayer(T_SIZE num_layers, ...) : T_LAYER(lu_activation<T, T_SIZE>()) {
 		va_list layers;
 		va_start(layers, num_layers);
 		for (T_SIZE i = 0; i < num_layers; i++) {
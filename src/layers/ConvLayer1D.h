@@ -2,6 +2,7 @@
 #define ENN_CONV_LAYER_1D_H
 
 #include <core/LayerBase.h>
+#include <core/matvecop.h>
 
 namespace EasyNeuralNetworks {
 
@@ -21,15 +22,32 @@ namespace EasyNeuralNetworks {
 /// weights shape is (N * M + 1, 1, K), where +1 is reserved for bias
 /// Basically weights tensor contains embedded tensors inside for each kernel,
 /// where the embedded kernel is stored as a tensor of shape (N, 1, M) + bias
+/// T_ACTIVATION_POLICY binds the activation at compile time, see ActivationPolicy
 template <typename T = ENN_DEFAULT_TYPE,
 				  bool BIAS = ENN_DEFAULT_BIAS,
-					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE,
+					typename T_ACTIVATION_POLICY = ActivationBase<T, T_SIZE> >
 class ConvLayer1D : public LayerBase<T, T_SIZE> {
 	ENN_T_INPUT_TYPEDEF(T_INPUT);
 	ENN_T_LAYER_TYPEDEF(T_LAYER);
-	ENN_T_ACTIVATION_TYPEDEF(T_ACTIVATION);
+	typedef T_ACTIVATION_POLICY T_ACTIVATION;
+	typedef ActivationPolicy<T_ACTIVATION_POLICY> T_POLICY;
 	T_SIZE _stride;
 	T_SIZE _kernel_width;
+#if ENN_CONV_GEMM
+	/// input patches, one row per output (see im2row_1d), reused across calls
+	T_INPUT _patches;
+#endif
+#if ENN_CONV_FFT
+	/// kernel spectra, scratch buffers and twiddle factors of the FFT convolution (see convolve_fft)
+	T_INPUT _fft_kernels;
+	T_INPUT _fft_input;
+	T_INPUT _fft_output;
+	T_INPUT _fft_twiddles;
+	size_t _fft_width;
+	size_t _fft_height;
+	bool _fft_ready;
+#endif
 public:
 	ConvLayer1D(T_INPUT& input, T_SIZE kernel_width, T_SIZE num_kernels, T_SIZE stride, T_INPUT& weights, const T_ACTIVATION& activation)
 		: ConvLayer1D(input, kernel_width, num_kernels, stride, activation) {
@@ -44,6 +62,27 @@ public:
 		_kernel_width = kernel_width;
 		this->outputs().resize((input.width() - kernel_width) / stride + 1, 1, num_kernels);
 		this->weights().resize(kernel_width * input.depth() + ENN_BIAS, 1, num_kernels);
+#if ENN_CONV_FFT
+		_fft_ready = false;
+		if (!std::is_floating_point<T>::value || stride != 1 ||
+				!fft_conv_plan(&_fft_width, &_fft_height, input.width(), 1, input.depth(), num_kernels, kernel_width, 1))
+			_fft_width = 0;
+#endif
+	}
+
+	using T_LAYER::weights;
+
+	///
+	/// binds the weights. The kernel spectra are computed if the FFT convolution is used.
+	/// NOTE: call again if the weights are modified in place.
+	///
+	virtual void weights(T_INPUT& weights) {
+		T_LAYER::weights(weights);
+#if ENN_CONV_FFT
+		_fft_ready = false;
+		if (_fft_width)
+			fft_prepare();
+#endif
 	}
 
 
@@ -52,26 +91,55 @@ public:
 	///
 	virtual void forward()
 	{
-		this->outputs().fill(0);
-		for (T_SIZE i = 0; i < this->weights().depth(); i ++) {
-			auto feature_map = this->outputs().window(i, 1);
-			auto kernel = this->weights().window(i, 1);
-			for (T_SIZE channel = 0; channel < this->inputs().depth(); channel++) {
-				T * W = kernel.data() + channel * _kernel_width;
-				convolve_1d_add<T, T_SIZE, false>(feature_map, this->inputs().data(channel), W, this->inputs().width(), _kernel_width, _stride);
+#if ENN_CONV_FFT
+		if (_fft_width) {
+			if (!_fft_ready)
+				fft_prepare();
+			convolve_fft<T, T_SIZE>(this->outputs(), this->inputs(), _fft_kernels, _fft_twiddles, _fft_twiddles.size(), _fft_input, _fft_output,
+				this->inputs().width(), 1, this->inputs().depth(), this->weights().depth(), _kernel_width, 1, _fft_width, _fft_height);
+			if (BIAS) {
+				for (T_SIZE i = 0; i < this->weights().depth(); i ++)
+					sum_arr<T, T_SIZE>(this->outputs().data(i), this->weights().data(i)[this->weights().width() - 1], this->outputs().width());
 			}
-			sum_arr_add<T, T_SIZE>(feature_map, kernel[kernel.size() - 1], feature_map.size());
+			T_POLICY::apply_forward_inplace(this->_activation, this->outputs());
+			return;
 		}
-		this->_activation.apply_forward_inplace(this->outputs());
+#endif
+#if ENN_CONV_GEMM
+		const T_SIZE row = _kernel_width * this->inputs().depth() + ENN_BIAS;
+		const T_SIZE P = this->outputs().width();
+		if (_patches.width() != row || _patches.height() != P)
+			_patches.resize(row, P, 1);
+		im2row_1d<T, T_SIZE>(_patches, this->inputs(), this->inputs().width(), this->inputs().depth(), _kernel_width, _stride, BIAS);
+		mat_mul_batch<T, false, T_SIZE, false>(this->outputs(), this->weights(), _patches, row, P, this->weights().depth());
+#else
+		convolve_2d_multi<T, T_SIZE>(this->outputs(), this->inputs(), this->weights(), this->weights().width(),
+			this->inputs().width(), 1, this->inputs().depth(), _kernel_width, 1, this->weights().depth(), _stride);
+		if (BIAS) {
+			for (T_SIZE i = 0; i < this->weights().depth(); i ++)
+				sum_arr<T, T_SIZE>(this->outputs().data(i), this->weights().data(i)[this->weights().width() - 1], this->outputs().width());
+		}
+#endif
+		T_POLICY::apply_forward_inplace(this->_activation, this->outputs());
 	}
 
+	///
+	/// the trainers set the weights in place (e.g. BackPropTrainer::init), the kernel spectra
+	/// are computed again by the next forward()
+	///
 	virtual void training_begin()
 	{
 		this->gradients().resize(this->inputs());
+#if ENN_CONV_FFT
+		_fft_ready = false;
+#endif
 	}
 	virtual void training_end()
 	{
 		this->gradients().resize(0, 0, 0);
+#if ENN_CONV_FFT
+		_fft_ready = false;
+#endif
 	}
 
 	///
@@ -80,7 +148,7 @@ public:
 	virtual void backward(T_INPUT& gradients)
 	{
 		// apply activation derivative
-		this->_activation.apply_backward_inplace(gradients, this->outputs());
+		T_POLICY::apply_backward_inplace(this->_activation, gradients, this->outputs());
 
 		this->gradients().fill(0);
 		for (T_SIZE i = 0; i < this->weights().depth(); i ++) {
@@ -88,7 +156,7 @@ public:
 			auto G = gradients.data(i);
 			for (T_SIZE channel = 0; channel < this->inputs().depth(); channel++) {
 				T * W = kernel.data() + channel * _kernel_width;
-				convolve_1d_add<T, T_SIZE, true>(gradients().data(channel), G, W, this->inputs().width(), _kernel_width, _stride);
+				convolve_1d_add<T, T_SIZE, true>(this->gradients().data(channel), G, W, this->inputs().width(), _kernel_width, _stride);
 			}
 		}
 	}
@@ -98,7 +166,29 @@ public:
 	///
 	virtual void update(const T_INPUT& gradients, T alpha)
 	{
+#if ENN_CONV_FFT
+		_fft_ready = false;
+#endif
+	}
+
+private:
+#if ENN_CONV_FFT
+	void fft_prepare() {
+		const T_SIZE C = this->inputs().depth();
+		const T_SIZE K = this->weights().depth();
+		const size_t n = _fft_width * _fft_height;
+		const size_t blocks = fft_conv_blocks(_fft_width, _fft_height, this->inputs().width(), 1, _kernel_width, 1);
+		if (_fft_twiddles.size() != n) {
+			_fft_twiddles.resize(n, 1, 1);
+			fft_twiddles<T>(_fft_twiddles, n);
+			_fft_kernels.resize(2 * n, C, K);
+			_fft_input.resize(2 * n, blocks, C);
+			_fft_output.resize(2 * n, blocks, K);
+		}
+		fft_conv_kernels<T, T_SIZE>(_fft_kernels, this->weights(), _fft_twiddles, n, C, K, _kernel_width, 1, this->weights().width(), _fft_width, _fft_height);
+		_fft_ready = true;
 	}
+#endif
 };
 
 };
@@ -2,6 +2,7 @@
 #define ENN_CONV_LAYER_2D_H
 
 #include <core/LayerBase.h>
+#include <core/matvecop.h>
 
 namespace EasyNeuralNetworks {
 
@@ -21,16 +22,40 @@ namespace EasyNeuralNetworks {
 /// weights shape is (N * M * C + 1, 1, K), where +1 is reserved for bias
 /// Basically weights tensor contains embedded tensors inside for each kernel,
 /// where the embedded kernel is stored as a tensor of shape (N, M, C) + bias
+/// T_ACTIVATION_POLICY binds the activation at compile time, see ActivationPolicy
 template <typename T = ENN_DEFAULT_TYPE,
 				  bool BIAS = ENN_DEFAULT_BIAS,
-					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE,
+					typename T_ACTIVATION_POLICY = ActivationBase<T, T_SIZE> >
 class ConvLayer2D : public LayerBase<T, T_SIZE> {
 	ENN_T_INPUT_TYPEDEF(T_INPUT);
 	ENN_T_LAYER_TYPEDEF(T_LAYER);
-	ENN_T_ACTIVATION_TYPEDEF(T_ACTIVATION);
+	typedef T_ACTIVATION_POLICY T_ACTIVATION;
+	typedef ActivationPolicy<T_ACTIVATION_POLICY> T_POLICY;
 	T_SIZE _stride;
 	T_SIZE _kernel_width;
 	T_SIZE _kernel_height;
+#if ENN_CONV_GEMM
+	/// input patches, one row per output (see im2row_2d), reused across calls
+	T_INPUT _patches;
+#endif
+#if ENN_CONV_WINOGRAD
+	/// Winograd transformed kernels and scratch buffers (see convolve_3x3_winograd)
+	T_INPUT _winograd_kernels;
+	T_INPUT _winograd_input;
+	T_INPUT _winograd_products;
+	bool _winograd_ready;
+#endif
+#if ENN_CONV_FFT
+	/// kernel spectra, scratch buffers and twiddle factors of the FFT convolution (see convolve_fft)
+	T_INPUT _fft_kernels;
+	T_INPUT _fft_input;
+	T_INPUT _fft_output;
+	T_INPUT _fft_twiddles;
+	size_t _fft_width;
+	size_t _fft_height;
+	bool _fft_ready;
+#endif
 public:
 	ConvLayer2D(T_INPUT& input, T_SIZE kernel_width, T_SIZE kernel_height, T_SIZE num_kernels, T_SIZE stride, T_LAYER& weights, const T_ACTIVATION& activation)
 		: ConvLayer2D(input, kernel_width, kernel_height, num_kernels, stride, activation) {
@@ -45,6 +70,37 @@ public:
 		_kernel_height = kernel_height;
 		this->outputs().resize((input.width() - kernel_width) / stride + 1, (input.height() - kernel_height) / stride + 1, num_kernels);
 		this->weights().resize(kernel_width * kernel_height * input.depth() + ENN_BIAS, 1, num_kernels);
+#if ENN_CONV_WINOGRAD
+		_winograd_ready = false;
+#endif
+#if ENN_CONV_FFT
+		_fft_ready = false;
+		// 3x3 and smaller kernels are left to Winograd and im2row
+		if (!std::is_floating_point<T>::value || stride != 1 || kernel_width * kernel_height <= 9 ||
+				!fft_conv_plan(&_fft_width, &_fft_height, input.width(), input.height(), input.depth(), num_kernels, kernel_width, kernel_height))
+			_fft_width = 0;
+#endif
+	}
+
+	using T_LAYER::weights;
+
+	///
+	/// binds the weights. 3x3 kernels with unit stride are transformed for the Winograd convolution,
+	/// the kernel spectra are computed if the FFT convolution is used.
+	/// NOTE: call again if the weights are modified in place.
+	///
+	virtual void weights(T_INPUT& weights) {
+		T_LAYER::weights(weights);
+#if ENN_CONV_FFT
+		_fft_ready = false;
+		if (_fft_width)
+			fft_prepare();
+#endif
+#if ENN_CONV_WINOGRAD
+		_winograd_ready = false;
+		if (winograd())
+			winograd_prepare();
+#endif
 	}
 
 	///
@@ -52,26 +108,75 @@ public:
 	///
 	virtual void forward()
 	{
-		this->outputs().fill(0);
-		for (T_SIZE i = 0; i < this->weights().depth(); i ++) {
-			auto feature_map = this->outputs().window(i, 1);
-			auto kernel = this->weights().window(i, 1);
-			for (T_SIZE channel = 0; channel < this->inputs().depth(); channel++) {
-				T * W = kernel.data() + channel * _kernel_width * _kernel_height;
-				convolve_2d_add<T, T_SIZE, false>(feature_map, this->inputs().data(channel), W, this->inputs().width(), this->inputs().height(), _kernel_width, _kernel_height, _stride);
+#if ENN_CONV_FFT
+		if (_fft_width) {
+			if (!_fft_ready)
+				fft_prepare();
+			convolve_fft<T, T_SIZE>(this->outputs(), this->inputs(), _fft_kernels, _fft_twiddles, _fft_twiddles.size(), _fft_input, _fft_output,
+				this->inputs().width(), this->inputs().height(), this->inputs().depth(), this->weights().depth(), _kernel_width, _kernel_height, _fft_width, _fft_height);
+			if (BIAS) {
+				for (T_SIZE i = 0; i < this->weights().depth(); i ++)
+					sum_arr<T, T_SIZE>(this->outputs().data(i), this->weights().data(i)[this->weights().width() - 1], this->outputs().width() * this->outputs().height());
 			}
-			sum_arr_add<T, T_SIZE>(feature_map, kernel[kernel.size() - 1], feature_map.size());
+			T_POLICY::apply_forward_inplace(this->_activation, this->outputs());
+			return;
+		}
+#endif
+#if ENN_CONV_WINOGRAD
+		if (winograd()) {
+			if (!_winograd_ready)
+				winograd_prepare();
+			convolve_3x3_winograd<T, T_SIZE>(this->outputs(), this->inputs(), _winograd_kernels, _winograd_input, _winograd_products,
+				this->inputs().width(), this->inputs().height(), this->inputs().depth(), this->weights().depth());
+			if (BIAS) {
+				for (T_SIZE i = 0; i < this->weights().depth(); i ++)
+					sum_arr<T, T_SIZE>(this->outputs().data(i), this->weights().data(i)[this->weights().width() - 1], this->outputs().width() * this->outputs().height());
+			}
+			T_POLICY::apply_forward_inplace(this->_activation, this->outputs());
+			return;
+		}
+#endif
+#if ENN_CONV_GEMM
+		const T_SIZE row = _kernel_width * _kernel_height * this->inputs().depth() + ENN_BIAS;
+		const T_SIZE P = this->outputs().width() * this->outputs().height();
+		if (_patches.width() != row || _patches.height() != P)
+			_patches.resize(row, P, 1);
+		im2row_2d<T, T_SIZE>(_patches, this->inputs(), this->inputs().width(), this->inputs().height(), this->inputs().depth(), _kernel_width, _kernel_height, _stride, BIAS);
+		mat_mul_batch<T, false, T_SIZE, false>(this->outputs(), this->weights(), _patches, row, P, this->weights().depth());
+#else
+		convolve_2d_multi<T, T_SIZE>(this->outputs(), this->inputs(), this->weights(), this->weights().width(),
+			this->inputs().width(), this->inputs().height(), this->inputs().depth(), _kernel_width, _kernel_height, this->weights().depth(), _stride);
+		if (BIAS) {
+			for (T_SIZE i = 0; i < this->weights().depth(); i ++)
+				sum_arr<T, T_SIZE>(this->outputs().data(i), this->weights().data(i)[this->weights().width() - 1], this->outputs().width() * this->outputs().height());
 		}
-		this->_activation.apply_forward_inplace(this->outputs());
+#endif
+		T_POLICY::apply_forward_inplace(this->_activation, this->outputs());
 	}
 
+	///
+	/// the trainers set the weights in place (e.g. BackPropTrainer::init), the transformed kernels
+	/// are prepared again by the next forward()
+	///
 	virtual void training_begin()
 	{
 		this->gradients().resize(this->inputs());
+#if ENN_CONV_WINOGRAD
+		_winograd_ready = false;
+#endif
+#if ENN_CONV_FFT
+		_fft_ready = false;
+#endif
 	}
 	virtual void training_end()
 	{
 		this->gradients().resize(0, 0, 0);
+#if ENN_CONV_WINOGRAD
+		_winograd_ready = false;
+#endif
+#if ENN_CONV_FFT
+		_fft_ready = false;
+#endif
 	}
 
 	///
@@ -80,7 +185,7 @@ public:
 	virtual void backward(T_INPUT& gradients)
 	{
 		// apply activation derivative
-		this->_activation.apply_backward_inplace(gradients, this->outputs());
+		T_POLICY::apply_backward_inplace(this->_activation, gradients, this->outputs());
 
 		this->gradients().fill(0);
 		for (T_SIZE i = 0; i < this->weights().depth(); i ++) {
@@ -88,7 +193,7 @@ public:
 			auto G = gradients.data(i);
 			for (T_SIZE channel = 0; channel < this->inputs().depth(); channel++) {
 				T * W = kernel.data() + channel * _kernel_width;
-				convolve_2d_add<T, T_SIZE, true>(gradients().data(channel), G, W, this->inputs().width(), this->inputs().height(), _kernel_width, _kernel_height, _stride);
+				convolve_2d_add<T, T_SIZE, true>(this->gradients().data(channel), G, W, this->inputs().width(), this->inputs().height(), _kernel_width, _kernel_height, _stride);
 			}
 		}
 	}
@@ -98,7 +203,53 @@ public:
 	///
 	virtual void update(const T_INPUT& gradients, T alpha)
 	{
+#if ENN_CONV_WINOGRAD
+		_winograd_ready = false;
+#endif
+#if ENN_CONV_FFT
+		_fft_ready = false;
+#endif
 	}
+
+private:
+#if ENN_CONV_WINOGRAD
+	/// the transforms have factors of 0.5, which would truncate in fixed point
+	inline bool winograd() const {
+		return std::is_floating_point<T>::value && _kernel_width == 3 && _kernel_height == 3 && _stride == 1 &&
+				this->inputs().depth() >= ENN_CONV_WINOGRAD_MIN_CHANNELS;
+	}
+
+	void winograd_prepare() {
+		const T_SIZE C = this->inputs().depth();
+		const T_SIZE K = this->weights().depth();
+		const T_SIZE tiles = ((this->inputs().width() - 1) / 2) * ((this->inputs().height() - 1) / 2);
+		if (_winograd_kernels.width() != C || _winograd_kernels.height() != K) {
+			_winograd_kernels.resize(C, K, 16);
+			_winograd_input.resize(C, tiles, 16);
+			_winograd_products.resize(tiles, K, 16);
+		}
+		winograd_3x3_kernels<T, T_SIZE>(_winograd_kernels, this->weights(), C, K, this->weights().width());
+		_winograd_ready = true;
+	}
+#endif
+#if ENN_CONV_FFT
+	void fft_prepare() {
+		const T_SIZE C = this->inputs().depth();
+		const T_SIZE K = this->weights().depth();
+		const size_t n = _fft_width * _fft_height;
+		const size_t tn = _fft_width > _fft_height ? _fft_width : _fft_height;
+		const size_t blocks = fft_conv_blocks(_fft_width, _fft_height, this->inputs().width(), this->inputs().height(), _kernel_width, _kernel_height);
+		if (_fft_twiddles.size() != tn) {
+			_fft_twiddles.resize(tn, 1, 1);
+			fft_twiddles<T>(_fft_twiddles, tn);
+			_fft_kernels.resize(2 * n, C, K);
+			_fft_input.resize(2 * n, blocks, C);
+			_fft_output.resize(2 * n, blocks, K);
+		}
+		fft_conv_kernels<T, T_SIZE>(_fft_kernels, this->weights(), _fft_twiddles, tn, C, K, _kernel_width, _kernel_height, this->weights().width(), _fft_width, _fft_height);
+		_fft_ready = true;
+	}
+#endif
 };
 
 };
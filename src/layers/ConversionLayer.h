@@ -0,0 +1,70 @@
+#if !defined(ENN_CONVERSION_LAYER_H)
+#define ENN_CONVERSION_LAYER_H
+
+#include <core/LayerBase.h>
+#include <core/matvecop.h>
+#include <activations/LUActivation.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// Converts the outputs of a layer of type T_IN to T_OUT, see MixedNeuralNetwork. Inference only.
+/// e.g. ConversionLayer<float, FixedPointType<int16_t, 12>> after a float convolution,
+/// or ConversionLayer<FixedPointType<int16_t, 12>, float> before a float softmax.
+///
+/// float to FixedPointType rounds and saturates, FixedPointType to FixedPointType of another
+/// type or exponent shifts, see mvo_convert.h. With quant_params the int8_t side holds int8
+/// quantized values, e.g. the inputs or outputs of the Quantized layers.
+/// The outputs have the shape of the inputs.
+///
+/// NOTE: MixedDenseLayer converts in the epilogue of the dense kernel, which saves this layer
+/// after a dense layer.
+///
+template <typename T_IN,
+					typename T_OUT,
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+class ConversionLayer : public LayerBase<T_OUT, T_SIZE> {
+	typedef T_OUT T;
+	ENN_T_INPUT_TYPEDEF(T_INPUT);
+	ENN_T_LAYER_TYPEDEF(T_LAYER);
+	typedef tensor<T_IN, T_SIZE> T_FROM;
+
+	T_FROM _from;
+	quant_params _params;
+	bool _quantized;
+public:
+	ConversionLayer(T_FROM& input)
+		: T_LAYER(identity()), _from(input), _quantized(false) {
+		this->outputs().resize(input.width(), input.height(), input.depth());
+	}
+
+	/// params are the quantization parameters of the int8_t inputs or outputs
+	ConversionLayer(T_FROM& input, const quant_params& params)
+		: T_LAYER(identity()), _from(input), _params(params), _quantized(true) {
+		this->outputs().resize(input.width(), input.height(), input.depth());
+	}
+
+	/// inputs of type T_IN, see MixedNeuralNetwork
+	inline T_FROM& inputs() { return _from; }
+	inline const T_FROM& inputs() const { return _from; }
+
+	virtual void forward() {
+		convert_arr(this->outputs().data(), _from.data(), _quantized ? &_params : (const quant_params *)NULL, _from.size());
+	}
+
+	/// conversion layers are inference only
+	virtual void training_begin() {}
+	virtual void training_end() {}
+	virtual void backward(T_INPUT& deltas) {}
+	virtual void update(const T_INPUT& gradients, T alpha) {}
+
+private:
+	static const ActivationBase<T, T_SIZE>& identity() {
+		static const LUActivation<T, T_SIZE> lu;
+		return lu;
+	}
+};
+
+};
+
+#endif
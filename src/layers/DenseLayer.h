@@ -17,13 +17,22 @@ namespace EasyNeuralNetworks {
 ///     where N is the input size and M is the output size,
 ///           i = N is the bias
 /// Weights shape is (N + 1, M, 1), where +1 reserved for biases
+/// T_ACTIVATION_POLICY binds the activation at compile time, see ActivationPolicy
 template <typename T = ENN_DEFAULT_TYPE,
 				  bool BIAS = ENN_DEFAULT_BIAS,
-					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE,
+					typename T_ACTIVATION_POLICY = ActivationBase<T, T_SIZE> >
 class DenseLayer : public LayerBase<T, T_SIZE> {
 	ENN_T_INPUT_TYPEDEF(T_INPUT);
-	ENN_T_ACTIVATION_TYPEDEF(T_ACTIVATION);
+	typedef T_ACTIVATION_POLICY T_ACTIVATION;
+	typedef ActivationPolicy<T_ACTIVATION_POLICY> T_POLICY;
 	ENN_T_LAYER_TYPEDEF(T_LAYER);
+
+	/// deferred updates, see training_batch(). Row b holds the scaled deltas and the inputs of sample b
+	T_INPUT _batch_deltas;
+	T_INPUT _batch_inputs;
+	T_SIZE _batch_size = 1;
+	T_SIZE _batch_count = 0;
 public:
 	DenseLayer(T_INPUT& input, T_SIZE out_width, T_INPUT& weights, const T_ACTIVATION& activation)
 		: DenseLayer(input, out_width, 1, weights, activation) { }
@@ -55,15 +64,36 @@ public:
 	///
 	virtual void forward()
 	{
+		fused_activation<T> f;
+		if (T_POLICY::fused(this->_activation, f)) {
+			mat_mul_fused<T, BIAS, T_SIZE>(this->outputs(), this->inputs(), this->weights(), this->inputs().size(), this->outputs().size(), f);
+			return;
+		}
 		mat_mul<T, BIAS, T_SIZE, false>(this->outputs(), this->inputs(), this->weights(), this->inputs().size(), this->outputs().size());
-		this->activation().apply_forward_inplace(this->outputs());
+		T_POLICY::apply_forward_inplace(this->_activation, this->outputs());
 	}
 
 	virtual void training_begin() {
 		this->gradients().resize(this->inputs());
 	}
 	virtual void training_end() {
+		update_end();
 		this->gradients().resize(0, 0, 0);
+		_batch_deltas.resize(0, 0, 0);
+		_batch_inputs.resize(0, 0, 0);
+	}
+
+	///
+	/// collects up to batch samples in update() and applies them as a single rank-batch
+	/// update, so that the weights are read and written once per batch instead of once per sample
+	///
+	virtual void training_batch(T_SIZE batch) {
+		_batch_size = batch > 1 ? batch : 1;
+		_batch_count = 0;
+		if (_batch_size > 1) {
+			_batch_deltas.resize(this->outputs().size(), _batch_size, 1);
+			_batch_inputs.resize(this->inputs().size(), _batch_size, 1);
+		}
 	}
 
 	///
@@ -72,7 +102,12 @@ public:
 	virtual void backward(T_INPUT& gradients)
 	{
 		// calculate gradients
-		this->_activation.apply_backward_inplace(gradients, this->outputs());
+		fused_activation<T> f;
+		if (T_POLICY::fused(this->_activation, f)) {
+			mat_mul_transposed_fused<T, BIAS, T_SIZE>(this->gradients(), gradients, this->outputs(), this->weights(), this->inputs().size(), this->outputs().size(), f);
+			return;
+		}
+		T_POLICY::apply_backward_inplace(this->_activation, gradients, this->outputs());
 		mat_mul<T, BIAS, T_SIZE, true>(this->gradients(), gradients, this->weights(), this->inputs().size(), this->outputs().size());
 	}
 
@@ -81,7 +116,29 @@ public:
 	///
 	virtual void update(const T_INPUT& gradients, T alpha)
 	{
-		outer_product_add_const<T, BIAS, T_SIZE>(this->weights(), gradients, this->inputs(), this->outputs().size(), this->inputs().size(), -alpha);
+		if (_batch_size <= 1) {
+			outer_product_add_const<T, BIAS, T_SIZE>(this->weights(), gradients, this->inputs(), this->outputs().size(), this->inputs().size(), -alpha);
+			return;
+		}
+
+		mul_arr<T, T_SIZE>(_batch_deltas.data(_batch_count, 0), gradients, -alpha, this->outputs().size());
+		const T * I = this->inputs().data();
+		T * dst = _batch_inputs.data(_batch_count, 0);
+		for (T_SIZE i = 0; i < this->inputs().size(); i++)
+			dst[i] = I[i];
+		if (++_batch_count == _batch_size)
+			update_end();
+	}
+
+	///
+	/// applies the collected updates
+	///
+	virtual void update_end()
+	{
+		if (_batch_count == 0)
+			return;
+		outer_product_batch_add<T, BIAS, T_SIZE>(this->weights(), _batch_deltas, _batch_inputs, this->outputs().size(), this->inputs().size(), _batch_count);
+		_batch_count = 0;
 	}
 };
 
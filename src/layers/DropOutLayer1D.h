@@ -15,7 +15,7 @@ class DropOutLayer1D : public LayerBase<T, T_SIZE> {
 	ENN_T_LAYER_TYPEDEF(T_LAYER);
 	T _dropout_percent;
 public:
-	DropOutLayer1D(T_INPUT& input, T dropout_percent) : T_LAYER(input, LUActivation<T>()) {
+	DropOutLayer1D(T_INPUT& input, T dropout_percent) : T_LAYER(input, lu_activation<T, T_SIZE>()) {
 		this->outputs(this->inputs());
 		_dropout_percent = dropout_percent;
 	}
@@ -0,0 +1,108 @@
+#if !defined(ENN_HALF_WEIGHTS_DENSE_LAYER_H)
+#define ENN_HALF_WEIGHTS_DENSE_LAYER_H
+
+#include <core/LayerBase.h>
+#include <core/ProgmemHelper.h>
+#include <core/matvecop.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// Fully connected float layer with half precision weights, inference only.
+/// H is float16 or bfloat16 (see HalfFloatType): the weights take half the memory of the
+/// float weights and are converted to float in the inner loop, the inputs, the outputs and
+/// the sums stay float (see mvo_half.h). Unlike QuantizedWeightsDenseLayer there are no scales,
+/// float16 keeps 11 significant bits up to 65504, bfloat16 keeps 8 bits and the range of float.
+///
+/// Weights are organized as in DenseLayer<float, BIAS>, shape (N + 1, M, 1), and are rounded on load.
+/// Weights can be loaded from flash a row at a time, see weights(const ProgmemHelper<float>&),
+/// or be bound directly as half precision values, see weights(tensor<H, T_SIZE>&).
+/// T_ACTIVATION_POLICY binds the activation at compile time, see ActivationPolicy
+///
+template <typename H = float16,
+				  bool BIAS = ENN_DEFAULT_BIAS,
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE,
+					typename T_ACTIVATION_POLICY = ActivationBase<float, T_SIZE> >
+class HalfWeightsDenseLayer : public LayerBase<float, T_SIZE> {
+	typedef float T;
+	ENN_T_INPUT_TYPEDEF(T_INPUT);
+	typedef T_ACTIVATION_POLICY T_ACTIVATION;
+	typedef ActivationPolicy<T_ACTIVATION_POLICY> T_POLICY;
+	ENN_T_LAYER_TYPEDEF(T_LAYER);
+
+	tensor<H, T_SIZE> _hweights;
+public:
+	HalfWeightsDenseLayer(T_INPUT& input, T_SIZE out_width, T_INPUT& weights, const T_ACTIVATION& activation)
+		: HalfWeightsDenseLayer(input, out_width, 1, 1, activation) {
+		this->weights(weights);
+	}
+
+	HalfWeightsDenseLayer(T_INPUT& input, T_SIZE out_width, const ProgmemHelper<T>& weights, const T_ACTIVATION& activation)
+		: HalfWeightsDenseLayer(input, out_width, 1, 1, activation) {
+		this->weights(weights);
+	}
+
+	HalfWeightsDenseLayer(T_INPUT& input, T_SIZE out_width, T_SIZE out_height, T_SIZE out_depth, const T_ACTIVATION& activation)
+		: T_LAYER(input, activation)
+	{
+		this->outputs().resize(out_width, out_height, out_depth);
+		_hweights.resize(input.size() + ENN_BIAS, this->outputs().size(), 1);
+	}
+
+	inline const tensor<H, T_SIZE>& half_weights() const { return _hweights; }
+
+	using T_LAYER::weights;
+
+	///
+	/// rounds the float weights to half precision, the layer does not keep them.
+	/// weights are organized as in DenseLayer, shape (N + 1, M, 1)
+	///
+	virtual void weights(T_INPUT& weights) {
+		assert(weights.size() == _hweights.size());
+		to_half_arr<H, T_SIZE>(_hweights.data(), weights.data(), _hweights.size());
+	}
+
+	///
+	/// reads the float weights from flash a row at a time and rounds them.
+	/// weights are organized as in DenseLayer, see weights(T_INPUT&)
+	///
+	virtual void weights(const ProgmemHelper<T>& weights) {
+		const T_SIZE N = this->inputs().size();
+		const T_SIZE M = this->outputs().size();
+		T_INPUT buf(N + ENN_BIAS, 1, 1);
+		for (T_SIZE j = 0; j < M; j++) {
+			weights.read(buf.data(), N + ENN_BIAS, (size_t)j * (N + ENN_BIAS));
+			to_half_arr<H, T_SIZE>(_hweights.data() + (size_t)j * (N + ENN_BIAS), buf.data(), N + ENN_BIAS);
+		}
+	}
+
+	/// weights already in half precision, organized as in weights(T_INPUT&)
+	void weights(tensor<H, T_SIZE>& weights) {
+		assert(weights.size() == _hweights.size());
+		_hweights = weights;
+	}
+
+	///
+	///
+	///
+	virtual void forward()
+	{
+		fused_activation<T> f;
+		if (T_POLICY::fused(this->_activation, f)) {
+			hmat_mul_fused<T, H, BIAS, T_SIZE>(this->outputs(), this->inputs(), _hweights.data(), this->inputs().size(), this->outputs().size(), f);
+			return;
+		}
+		hmat_mul<T, H, BIAS, T_SIZE>(this->outputs(), this->inputs(), _hweights.data(), this->inputs().size(), this->outputs().size());
+		T_POLICY::apply_forward_inplace(this->_activation, this->outputs());
+	}
+
+	/// the half precision weights are inference only
+	virtual void training_begin() {}
+	virtual void training_end() {}
+	virtual void backward(T_INPUT& deltas) {}
+	virtual void update(const T_INPUT& gradients, T alpha) {}
+};
+
+};
+
+#endif
@@ -0,0 +1,73 @@
+#if !defined(ENN_HALF_WEIGHTS_LSTM_LAYER_H)
+#define ENN_HALF_WEIGHTS_LSTM_LAYER_H
+
+#include <core/LayerBase.h>
+#include <core/matvecop.h>
+#include "LSTMLayer.h"
+
+namespace EasyNeuralNetworks {
+
+///
+/// LSTMLayer<float, BIAS> with half precision weights and recurrent weights, inference only.
+/// H is float16 or bfloat16 (see HalfFloatType), the gates are accumulated in float (see mvo_half.h)
+/// and the states stay float, only the weights are stored in 16 bits.
+///
+/// Weights and recurrent weights are organized as in LSTMLayer and are rounded on load,
+/// the layer does not keep the float weights.
+///
+template <typename H = float16,
+				  bool BIAS = ENN_DEFAULT_BIAS,
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+class HalfWeightsLSTMLayer : public LSTMLayer<float, BIAS, T_SIZE> {
+	typedef float T;
+	typedef LSTMLayer<float, BIAS, T_SIZE> T_LSTM;
+	ENN_T_INPUT_TYPEDEF(T_INPUT);
+	ENN_T_ACTIVATION_TYPEDEF(T_ACTIVATION);
+
+	tensor<H, T_SIZE> _hweights;
+	tensor<H, T_SIZE> _hrecurrent_weights;
+public:
+	HalfWeightsLSTMLayer(T_INPUT& input, T_SIZE out_width, T_INPUT& weights, T_INPUT& recurrent_weights, const T_ACTIVATION& activation, const T_ACTIVATION& recurrent_activation)
+		: HalfWeightsLSTMLayer(input, out_width, 1, weights, recurrent_weights, activation, recurrent_activation) { }
+
+	HalfWeightsLSTMLayer(T_INPUT& input, T_SIZE out_width, T_SIZE out_height, T_INPUT& weights, T_INPUT& recurrent_weights, const T_ACTIVATION& activation, const T_ACTIVATION& recurrent_activation)
+		: HalfWeightsLSTMLayer(input, out_width, out_height, 1, weights, recurrent_weights, activation, recurrent_activation) { }
+
+	HalfWeightsLSTMLayer(T_INPUT& input, T_SIZE out_width, T_SIZE out_height, T_SIZE out_depth, T_INPUT& weights, T_INPUT& recurrent_weights, const T_ACTIVATION& activation, const T_ACTIVATION& recurrent_activation)
+		: T_LSTM(input, out_width, out_height, out_depth, activation, recurrent_activation) {
+		_hweights.resize(this->_weights.width(), this->_weights.height(), this->_weights.depth());
+		_hrecurrent_weights.resize(this->_recurrent_weights.width(), this->_recurrent_weights.height(), this->_recurrent_weights.depth());
+		this->_weights.resize(0, 0, 0);
+		this->_recurrent_weights.resize(0, 0, 0);
+		this->weights(weights);
+		this->recurrent_weights(recurrent_weights);
+	}
+
+	inline const tensor<H, T_SIZE>& half_weights() const { return _hweights; }
+	inline const tensor<H, T_SIZE>& half_recurrent_weights() const { return _hrecurrent_weights; }
+
+	using T_LSTM::weights;
+
+	/// rounds the float weights to half precision, organized as in LSTMLayer
+	virtual void weights(T_INPUT& weights) {
+		assert(weights.size() == _hweights.size());
+		to_half_arr<H, T_SIZE>(_hweights.data(), weights.data(), _hweights.size());
+	}
+
+	/// rounds the float recurrent weights to half precision, organized as in LSTMLayer
+	void recurrent_weights(T_INPUT& recurrent_weights) {
+		assert(recurrent_weights.size() == _hrecurrent_weights.size());
+		to_half_arr<H, T_SIZE>(_hrecurrent_weights.data(), recurrent_weights.data(), _hrecurrent_weights.size());
+	}
+
+protected:
+	virtual void gates()
+	{
+		hmat_mul<T, H, BIAS, T_SIZE>(this->_z, this->inputs(), _hweights.data(), this->inputs().size(), this->_z.size());
+		hmat_mul_add<T, H, false, T_SIZE>(this->_z, this->outputs(), _hrecurrent_weights.data(), this->outputs().size(), this->_z.size());
+	}
+};
+
+};
+
+#endif
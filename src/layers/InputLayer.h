@@ -18,7 +18,7 @@ class InputLayer : public LayerBase<T, T_SIZE> {
 	ENN_T_ACTIVATION_TYPEDEF(T_ACTIVATION);
 	ENN_T_LAYER_TYPEDEF(T_LAYER);
 public:
-	InputLayer(T_SIZE width, T_SIZE height = 1, T_SIZE depth = 1) : T_LAYER(LUActivation<T, T_SIZE>()) {
+	InputLayer(T_SIZE width, T_SIZE height = 1, T_SIZE depth = 1) : T_LAYER(lu_activation<T, T_SIZE>()) {
 		this->inputs().resize(width, height, depth);
 		this->outputs(this->inputs());
 	}
@@ -22,6 +22,7 @@ template <typename T = ENN_DEFAULT_TYPE,
 				  bool BIAS = ENN_DEFAULT_BIAS,
 					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
 class LSTMLayer : public LayerBase<T, T_SIZE> {
+protected:
 	ENN_T_INPUT_TYPEDEF(T_INPUT);
 	ENN_T_ACTIVATION_TYPEDEF(T_ACTIVATION);
 	ENN_T_LAYER_TYPEDEF(T_LAYER);
@@ -60,7 +61,16 @@ public:
 		this->_recurrent_weights.resize(this->outputs().size(), this->outputs().size(), 4);
 
 		this->_carry.resize(this->outputs());
-		this->_z.resize(this->outputs() * 4);
+		this->_z.resize(this->outputs().width(), this->outputs().height(), this->outputs().depth() * 4);
+	}
+
+	///
+	/// z = inputs . weights + outputs . recurrent_weights, see HalfWeightsLSTMLayer
+	///
+	virtual void gates()
+	{
+		mat_mul<T, BIAS, T_SIZE, false>(_z, this->inputs(), this->weights(), this->inputs().size(), _z.size());
+		mat_mul_add<T, false, T_SIZE, false>(_z, this->outputs(), _recurrent_weights, this->outputs().size(), _z.size());
 	}
 
 	///
@@ -90,27 +100,26 @@ public:
 		// h = o * self.activation(c)
 		// return h, [h, c]  # output, states
 
-		mat_mul<T, BIAS, T_SIZE, false>(_z, this->inputs(), this->weights(), this->inputs().size(), _z.size());
-		mat_mul_add<T, false, T_SIZE, false>(_z, this->outputs(), _recurrent_weights, this->outputs().size(), _z.size());
+		gates();
 
-		T_INPUT z0(_z.window(0, 1));
-		T_INPUT z1(_z.window(1, 1));
-		T_INPUT z2(_z.window(2, 1));
-		T_INPUT z3(_z.window(3, 1));
+		const T_SIZE depth = _carry.depth();
+		T_INPUT z0(_z.window(0 * depth, depth));
+		T_INPUT z1(_z.window(1 * depth, depth));
+		T_INPUT z2(_z.window(2 * depth, depth));
+		T_INPUT z3(_z.window(3 * depth, depth));
 
 		_recurrent_activation.apply_forward_inplace(z0);	// i
 		_recurrent_activation.apply_forward_inplace(z1);	// f
 		this->activation().apply_forward_inplace(z2);			// c
 		_recurrent_activation.apply_forward_inplace(z3);	// o
 
-		// c = f * c_tm1 + i * self.activation(z2)
-		hadamard_product<T, T_SIZE>(_carry, z1, _carry, _carry.size());
-		hadamard_product_add<T, T_SIZE>(_carry, z0, z2, _carry.size());
+		// c = f * c_tm1 + i * self.activation(z2), a single pass, see core/tensor_expr.h
+		_carry = z1 * _carry + z0 * z2;
 
 		// h = o * self.activation(c)
 		this->outputs().copy(_carry);
 		this->activation().apply_forward_inplace(this->outputs());
-		hadamard_product<T, T_SIZE>(this->outputs(), this->outputs(), z3, z3.size());
+		this->outputs() *= z3;
 	}
 
 	virtual void training_begin() {
@@ -23,11 +23,11 @@ class MaxPoolingLayer2D : public LayerBase<T, T_SIZE> {
 	T_SIZE _stride;
 	bool training = false;
 public:
-	MaxPoolingLayer2D(T_INPUT& input, T_SIZE width, T_SIZE height, T_SIZE stride=0) : T_LAYER(input, LUActivation<T>()) {
+	MaxPoolingLayer2D(T_INPUT& input, T_SIZE width, T_SIZE height, T_SIZE stride=0) : T_LAYER(input, lu_activation<T, T_SIZE>()) {
 		assert(width > 1);
 		assert(height > 1);
 		if (stride == 0)
-			stride = min(width, height);
+			stride = width < height ? width : height;
 		assert((input.width() - width) % stride == 0);
 		assert((input.height() - height) % stride == 0);
 		_kernel_width = width;
@@ -72,12 +72,12 @@ public:
 	virtual void training_begin()
 	{
 		this->gradients().resize(this->inputs());
-		this->widths().resize(this->inputs());
+		this->weights().resize(this->inputs());
 	}
 	virtual void training_end()
 	{
 		this->gradients().resize(0, 0, 0);
-		this->widths().resize(0, 0, 0);
+		this->weights().resize(0, 0, 0);
 	}
 
 	///
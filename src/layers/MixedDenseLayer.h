@@ -0,0 +1,91 @@
+#if !defined(ENN_MIXED_DENSE_LAYER_H)
+#define ENN_MIXED_DENSE_LAYER_H
+
+#include <core/LayerBase.h>
+#include <core/matvecop.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// Fully connected layer with inputs and weights of type T_IN and outputs of type T_OUT,
+/// inference only, see MixedNeuralNetwork.
+/// It is a DenseLayer<T_IN> followed by a ConversionLayer<T_IN, T_OUT> with the conversion fused
+/// into the epilogue of the kernel (see kernel_mixed_mat_mul): with FixedPointType inputs the wide
+/// sum of the products is shifted once to the output exponent, or scaled to float, instead of
+/// being narrowed to T_IN and converted again. e.g.
+///		MixedDenseLayer<FixedPointType<int16_t, 12>, FixedPointType<int16_t, 10>> between layers of different ranges,
+///		MixedDenseLayer<FixedPointType<int16_t, 12>, float> with a float softmax as the last layer,
+///		MixedDenseLayer<float, FixedPointType<int16_t, 12>> as the first layer of a fixed point network.
+///
+/// Weights are organized as in DenseLayer<T_IN, BIAS>, shape (N + 1, M, 1).
+/// The activation is applied to the outputs, in T_OUT.
+/// T_ACTIVATION_POLICY binds the activation at compile time, see ActivationPolicy
+///
+template <typename T_IN,
+					typename T_OUT,
+					bool BIAS = ENN_DEFAULT_BIAS,
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE,
+					typename T_ACTIVATION_POLICY = ActivationBase<T_OUT, T_SIZE> >
+class MixedDenseLayer : public LayerBase<T_OUT, T_SIZE> {
+	typedef T_OUT T;
+	ENN_T_INPUT_TYPEDEF(T_INPUT);
+	typedef T_ACTIVATION_POLICY T_ACTIVATION;
+	typedef ActivationPolicy<T_ACTIVATION_POLICY> T_POLICY;
+	ENN_T_LAYER_TYPEDEF(T_LAYER);
+	typedef tensor<T_IN, T_SIZE> T_FROM;
+
+	T_FROM _from;
+	T_FROM _mixed_weights;
+public:
+	MixedDenseLayer(T_FROM& input, T_SIZE out_width, T_FROM& weights, const T_ACTIVATION& activation)
+		: MixedDenseLayer(input, out_width, 1, 1, activation) {
+		this->weights(weights);
+	}
+
+	MixedDenseLayer(T_FROM& input, T_SIZE out_width, T_SIZE out_height, T_SIZE out_depth, T_FROM& weights, const T_ACTIVATION& activation)
+		: MixedDenseLayer(input, out_width, out_height, out_depth, activation) {
+		this->weights(weights);
+	}
+
+	MixedDenseLayer(T_FROM& input, T_SIZE out_width, T_SIZE out_height, T_SIZE out_depth, const T_ACTIVATION& activation)
+		: T_LAYER(activation), _from(input)
+	{
+		this->outputs().resize(out_width, out_height, out_depth);
+		_mixed_weights.resize(input.size() + ENN_BIAS, this->outputs().size(), 1);
+	}
+
+	/// inputs of type T_IN, see MixedNeuralNetwork
+	inline T_FROM& inputs() { return _from; }
+	inline const T_FROM& inputs() const { return _from; }
+
+	/// weights of type T_IN
+	inline T_FROM& mixed_weights() { return _mixed_weights; }
+	inline const T_FROM& mixed_weights() const { return _mixed_weights; }
+
+	using T_LAYER::weights;
+
+	/// weights of type T_IN, organized as in DenseLayer
+	void weights(T_FROM& weights) {
+		assert(weights.size() == _mixed_weights.size());
+		_mixed_weights = weights;
+	}
+
+	///
+	///
+	///
+	virtual void forward()
+	{
+		mixed_mat_mul<T_OUT, T_IN, BIAS, T_SIZE>(this->outputs(), _from, _mixed_weights, _from.size(), this->outputs().size());
+		T_POLICY::apply_forward_inplace(this->_activation, this->outputs());
+	}
+
+	/// mixed precision layers are inference only
+	virtual void training_begin() {}
+	virtual void training_end() {}
+	virtual void backward(T_INPUT& deltas) {}
+	virtual void update(const T_INPUT& gradients, T alpha) {}
+};
+
+};
+
+#endif
@@ -0,0 +1,59 @@
+#if !defined(ENN_QUANTIZED_CONV_LAYER_1D_H)
+#define ENN_QUANTIZED_CONV_LAYER_1D_H
+
+#include <core/QuantizedLayerBase.h>
+#include <core/matvecop.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// int8 quantized 1D convolution, inference only, see QuantizedLayerBase and ConvLayer1D.
+///
+/// Imported from the float weights of a ConvLayer1D<float, BIAS>, shape (N * M + 1, 1, K).
+/// Quantized weights are organized as one row of N * M values per kernel, shape (N * M, K, 1),
+/// the biases are stored in channels().
+///
+template <bool BIAS = ENN_DEFAULT_BIAS,
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+class QuantizedConvLayer1D : public QuantizedLayerBase<T_SIZE> {
+	typedef QuantizedLayerBase<T_SIZE> T_BASE;
+	typedef typename T_BASE::T_INPUT T_INPUT;
+	typedef typename T_BASE::T_FLOAT_INPUT T_FLOAT_INPUT;
+	typedef typename T_BASE::T_FLOAT_ACTIVATION T_FLOAT_ACTIVATION;
+	T_SIZE _stride;
+	T_SIZE _kernel_width;
+	/// the input patch of a single output, see qconvolve_2d
+	T_INPUT _patch;
+public:
+	QuantizedConvLayer1D(T_INPUT& input, const quant_params& input_params, T_SIZE kernel_width, T_SIZE num_kernels, T_SIZE stride, const T_FLOAT_INPUT& weights, const T_FLOAT_ACTIVATION& activation, const quant_params& output_params, const quant_params& pre_params = quant_table_params())
+		: QuantizedConvLayer1D(input, input_params, kernel_width, num_kernels, stride, output_params) {
+		assert(weights.size() == (this->weights().width() + ENN_BIAS) * num_kernels);
+		this->quantize_weights(weights.data(), this->weights().width(), BIAS, num_kernels, activation, pre_params);
+	}
+
+	/// the quantized weights are bound later, see QuantizedLayerBase::weights
+	QuantizedConvLayer1D(T_INPUT& input, const quant_params& input_params, T_SIZE kernel_width, T_SIZE num_kernels, T_SIZE stride, const quant_params& output_params)
+		: T_BASE(input, input_params, output_params) {
+		assert(input.height() == 1);
+		_stride = stride;
+		_kernel_width = kernel_width;
+		this->outputs().resize((input.width() - kernel_width) / stride + 1, 1, num_kernels);
+		this->weights().resize(kernel_width * input.depth(), num_kernels, 1);
+		this->_channels.resize(num_kernels, 1, 1);
+		_patch.resize(this->weights().width(), 1, 1);
+	}
+
+	///
+	///
+	///
+	virtual void forward()
+	{
+		qconvolve_2d<int8_t, T_SIZE>(this->outputs(), this->inputs(), this->weights(), this->_channels.data(), _patch,
+			this->inputs().width(), 1, this->inputs().depth(), _kernel_width, 1,
+			this->weights().height(), _stride, this->_output);
+	}
+};
+
+};
+
+#endif
@@ -0,0 +1,60 @@
+#if !defined(ENN_QUANTIZED_CONV_LAYER_2D_H)
+#define ENN_QUANTIZED_CONV_LAYER_2D_H
+
+#include <core/QuantizedLayerBase.h>
+#include <core/matvecop.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// int8 quantized 2D convolution, inference only, see QuantizedLayerBase and ConvLayer2D.
+///
+/// Imported from the float weights of a ConvLayer2D<float, BIAS>, shape (N * M * C + 1, 1, K).
+/// Quantized weights are organized as one row of N * M * C values per kernel, shape (N * M * C, K, 1),
+/// the biases are stored in channels().
+///
+template <bool BIAS = ENN_DEFAULT_BIAS,
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+class QuantizedConvLayer2D : public QuantizedLayerBase<T_SIZE> {
+	typedef QuantizedLayerBase<T_SIZE> T_BASE;
+	typedef typename T_BASE::T_INPUT T_INPUT;
+	typedef typename T_BASE::T_FLOAT_INPUT T_FLOAT_INPUT;
+	typedef typename T_BASE::T_FLOAT_ACTIVATION T_FLOAT_ACTIVATION;
+	T_SIZE _stride;
+	T_SIZE _kernel_width;
+	T_SIZE _kernel_height;
+	/// the input patch of a single output, see qconvolve_2d
+	T_INPUT _patch;
+public:
+	QuantizedConvLayer2D(T_INPUT& input, const quant_params& input_params, T_SIZE kernel_width, T_SIZE kernel_height, T_SIZE num_kernels, T_SIZE stride, const T_FLOAT_INPUT& weights, const T_FLOAT_ACTIVATION& activation, const quant_params& output_params, const quant_params& pre_params = quant_table_params())
+		: QuantizedConvLayer2D(input, input_params, kernel_width, kernel_height, num_kernels, stride, output_params) {
+		assert(weights.size() == (this->weights().width() + ENN_BIAS) * num_kernels);
+		this->quantize_weights(weights.data(), this->weights().width(), BIAS, num_kernels, activation, pre_params);
+	}
+
+	/// the quantized weights are bound later, see QuantizedLayerBase::weights
+	QuantizedConvLayer2D(T_INPUT& input, const quant_params& input_params, T_SIZE kernel_width, T_SIZE kernel_height, T_SIZE num_kernels, T_SIZE stride, const quant_params& output_params)
+		: T_BASE(input, input_params, output_params) {
+		_stride = stride;
+		_kernel_width = kernel_width;
+		_kernel_height = kernel_height;
+		this->outputs().resize((input.width() - kernel_width) / stride + 1, (input.height() - kernel_height) / stride + 1, num_kernels);
+		this->weights().resize(kernel_width * kernel_height * input.depth(), num_kernels, 1);
+		this->_channels.resize(num_kernels, 1, 1);
+		_patch.resize(this->weights().width(), 1, 1);
+	}
+
+	///
+	///
+	///
+	virtual void forward()
+	{
+		qconvolve_2d<int8_t, T_SIZE>(this->outputs(), this->inputs(), this->weights(), this->_channels.data(), _patch,
+			this->inputs().width(), this->inputs().height(), this->inputs().depth(), _kernel_width, _kernel_height,
+			this->weights().height(), _stride, this->_output);
+	}
+};
+
+};
+
+#endif
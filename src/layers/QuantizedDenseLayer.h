@@ -0,0 +1,56 @@
+#if !defined(ENN_QUANTIZED_DENSE_LAYER_H)
+#define ENN_QUANTIZED_DENSE_LAYER_H
+
+#include <core/QuantizedLayerBase.h>
+#include <core/matvecop.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// int8 quantized fully connected layer, inference only, see QuantizedLayerBase.
+/// Can accept any shape of input. Output can be any shape.
+///
+/// Imported from the float weights of a DenseLayer<float, BIAS>:
+/// Wij = W[i + j * (N + 1)], i < N, j < M, where i = N is the bias.
+/// Quantized weights are organized as Wij = W[i + j * N], shape (N, M, 1),
+/// the biases are stored in channels().
+///
+template <bool BIAS = ENN_DEFAULT_BIAS,
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+class QuantizedDenseLayer : public QuantizedLayerBase<T_SIZE> {
+	typedef QuantizedLayerBase<T_SIZE> T_BASE;
+	typedef typename T_BASE::T_INPUT T_INPUT;
+	typedef typename T_BASE::T_FLOAT_INPUT T_FLOAT_INPUT;
+	typedef typename T_BASE::T_FLOAT_ACTIVATION T_FLOAT_ACTIVATION;
+public:
+	QuantizedDenseLayer(T_INPUT& input, const quant_params& input_params, T_SIZE out_width, const T_FLOAT_INPUT& weights, const T_FLOAT_ACTIVATION& activation, const quant_params& output_params, const quant_params& pre_params = quant_table_params())
+		: QuantizedDenseLayer(input, input_params, out_width, 1, 1, weights, activation, output_params, pre_params) { }
+
+	QuantizedDenseLayer(T_INPUT& input, const quant_params& input_params, T_SIZE out_width, T_SIZE out_height, T_SIZE out_depth, const T_FLOAT_INPUT& weights, const T_FLOAT_ACTIVATION& activation, const quant_params& output_params, const quant_params& pre_params = quant_table_params())
+		: QuantizedDenseLayer(input, input_params, out_width, out_height, out_depth, output_params) {
+		assert(weights.size() == (input.size() + ENN_BIAS) * this->outputs().size());
+		this->quantize_weights(weights.data(), input.size(), BIAS, this->outputs().size(), activation, pre_params);
+	}
+
+	/// the quantized weights are bound later, see QuantizedLayerBase::weights
+	QuantizedDenseLayer(T_INPUT& input, const quant_params& input_params, T_SIZE out_width, T_SIZE out_height, T_SIZE out_depth, const quant_params& output_params)
+		: T_BASE(input, input_params, output_params)
+	{
+		this->outputs().resize(out_width, out_height, out_depth);
+		this->weights().resize(input.size(), this->outputs().size(), 1);
+		this->_channels.resize(this->outputs().size(), 1, 1);
+	}
+
+	///
+	///
+	///
+	virtual void forward()
+	{
+		qmat_mul_requantize<int8_t, T_SIZE>(this->outputs(), this->inputs(), this->weights(), this->_channels.data(),
+			this->inputs().size(), this->outputs().size(), this->_output);
+	}
+};
+
+};
+
+#endif
@@ -0,0 +1,126 @@
+#if !defined(ENN_QUANTIZED_WEIGHTS_DENSE_LAYER_H)
+#define ENN_QUANTIZED_WEIGHTS_DENSE_LAYER_H
+
+#include <core/LayerBase.h>
+#include <core/ProgmemHelper.h>
+#include <core/matvecop.h>
+
+namespace EasyNeuralNetworks {
+
+///
+/// Fully connected float layer with weight-only quantization, inference only.
+/// Batch-1 inference of large dense layers is bound by streaming the weights from memory,
+/// int8 weights take 1/4 and int4 weights 1/8 of the float weights, the inputs and outputs stay float
+/// and need no calibration (see mvo_quant.h, ENN_WQUANT).
+/// Unpacking int4 weights takes more arithmetic, they pay off when the weights don't fit in the cache.
+///
+/// Imported from the float weights of a DenseLayer<float, BIAS>, which are quantized on load:
+/// Wij = W[i + j * (N + 1)], i < N, j < M, where i = N is the bias.
+/// Each row j is quantized with its own scale, SCALEj = max|Wij| / 127 (int8) or / 7 (int4),
+/// the biases are kept as float.
+/// Weights can be loaded from flash a row at a time, see weights(const ProgmemHelper<float>&),
+/// so that the float weights never have to be in memory at once.
+/// T_ACTIVATION_POLICY binds the activation at compile time, see ActivationPolicy
+///
+template <ENN_WQUANT BITS = ENN_WQUANT_INT8,
+				  bool BIAS = ENN_DEFAULT_BIAS,
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE,
+					typename T_ACTIVATION_POLICY = ActivationBase<float, T_SIZE> >
+class QuantizedWeightsDenseLayer : public LayerBase<float, T_SIZE> {
+	typedef float T;
+	ENN_T_INPUT_TYPEDEF(T_INPUT);
+	typedef T_ACTIVATION_POLICY T_ACTIVATION;
+	typedef ActivationPolicy<T_ACTIVATION_POLICY> T_POLICY;
+	ENN_T_LAYER_TYPEDEF(T_LAYER);
+
+	/// wquant_row_bytes(BITS, N) bytes per row
+	tensor<int8_t, T_SIZE> _qweights;
+	T_INPUT _scales;
+	T_INPUT _bias;
+public:
+	QuantizedWeightsDenseLayer(T_INPUT& input, T_SIZE out_width, T_INPUT& weights, const T_ACTIVATION& activation)
+		: QuantizedWeightsDenseLayer(input, out_width, 1, 1, activation) {
+		this->weights(weights);
+	}
+
+	QuantizedWeightsDenseLayer(T_INPUT& input, T_SIZE out_width, const ProgmemHelper<T>& weights, const T_ACTIVATION& activation)
+		: QuantizedWeightsDenseLayer(input, out_width, 1, 1, activation) {
+		this->weights(weights);
+	}
+
+	QuantizedWeightsDenseLayer(T_INPUT& input, T_SIZE out_width, T_SIZE out_height, T_SIZE out_depth, const T_ACTIVATION& activation)
+		: T_LAYER(input, activation)
+	{
+		this->outputs().resize(out_width, out_height, out_depth);
+		_qweights.resize(wquant_row_bytes(BITS, input.size()), this->outputs().size(), 1);
+		_scales.resize(this->outputs().size(), 1, 1);
+		if (BIAS)
+			_bias.resize(this->outputs().size(), 1, 1);
+	}
+
+	/// quantized weights, wquant_row_bytes(BITS, N) bytes per output
+	inline const tensor<int8_t, T_SIZE>& quantized_weights() const { return _qweights; }
+	inline const T_INPUT& scales() const { return _scales; }
+	inline const T_INPUT& bias() const { return _bias; }
+
+	using T_LAYER::weights;
+
+	///
+	/// quantizes the float weights, the layer does not keep them.
+	/// weights are organized as in DenseLayer, shape (N + 1, M, 1)
+	///
+	virtual void weights(T_INPUT& weights) {
+		const T_SIZE N = this->inputs().size();
+		const T_SIZE M = this->outputs().size();
+		assert(weights.size() == (N + ENN_BIAS) * M);
+		wquantize_mat<T_SIZE>(_qweights.data(), _scales.data(), weights.data(), N + ENN_BIAS, BITS, N, M);
+		if (BIAS) {
+			for (T_SIZE j = 0; j < M; j++)
+				_bias[j] = weights.data()[N + j * (N + 1)];
+		}
+	}
+
+	///
+	/// reads the float weights from flash a row at a time and quantizes them.
+	/// weights are organized as in DenseLayer, see weights(T_INPUT&)
+	///
+	virtual void weights(const ProgmemHelper<T>& weights) {
+		const T_SIZE N = this->inputs().size();
+		const T_SIZE M = this->outputs().size();
+		const size_t row = wquant_row_bytes(BITS, N);
+		T_INPUT buf(N + ENN_BIAS, 1, 1);
+		for (T_SIZE j = 0; j < M; j++) {
+			weights.read(buf.data(), N + ENN_BIAS, (size_t)j * (N + ENN_BIAS));
+			wquantize_mat<T_SIZE>(_qweights.data() + j * row, _scales.data() + j, buf.data(), N + ENN_BIAS, BITS, N, 1);
+			if (BIAS)
+				_bias[j] = buf[N];
+		}
+	}
+
+	///
+	///
+	///
+	virtual void forward()
+	{
+		fused_activation<T> f;
+		if (T_POLICY::fused(this->_activation, f)) {
+			wmat_mul_fused<T, BIAS, T_SIZE>(this->outputs(), this->inputs(), _qweights.data(), BITS, _scales.data(), _bias.data(),
+				this->inputs().size(), this->outputs().size(), f);
+			return;
+		}
+		f.op = ENN_FUSED_NONE;
+		wmat_mul_fused<T, BIAS, T_SIZE>(this->outputs(), this->inputs(), _qweights.data(), BITS, _scales.data(), _bias.data(),
+			this->inputs().size(), this->outputs().size(), f);
+		T_POLICY::apply_forward_inplace(this->_activation, this->outputs());
+	}
+
+	/// the quantized weights are inference only
+	virtual void training_begin() {}
+	virtual void training_end() {}
+	virtual void backward(T_INPUT& deltas) {}
+	virtual void update(const T_INPUT& gradients, T alpha) {}
+};
+
+};
+
+#endif
@@ -15,12 +15,15 @@ namespace EasyNeuralNetworks {
 /// This layer will flatten the input for computation.
 /// Weights are organized as the same way as for a DenseLayer.
 /// Note that recurrent weights are without bias.
+/// T_ACTIVATION_POLICY binds the activation at compile time, see ActivationPolicy
 template <typename T = ENN_DEFAULT_TYPE,
 				  bool BIAS = ENN_DEFAULT_BIAS,
-					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE>
+					typename T_SIZE = ENN_DEFAULT_SIZE_TYPE,
+					typename T_ACTIVATION_POLICY = ActivationBase<T, T_SIZE> >
 class RNNLayer : public LayerBase<T, T_SIZE> {
 	ENN_T_INPUT_TYPEDEF(T_INPUT);
-	ENN_T_ACTIVATION_TYPEDEF(T_ACTIVATION);
+	typedef T_ACTIVATION_POLICY T_ACTIVATION;
+	typedef ActivationPolicy<T_ACTIVATION_POLICY> T_POLICY;
 	ENN_T_LAYER_TYPEDEF(T_LAYER);
 	T_INPUT _recurrent_weights;
 	T_INPUT _memory;
@@ -62,7 +65,7 @@ public:
 		mat_mul<T, false, T_SIZE, false>(_memory, this->outputs(), _recurrent_weights, this->outputs().size(), this->outputs().size());
 		mat_mul<T, BIAS, T_SIZE, false>(this->outputs(), this->inputs(), this->weights(), this->inputs().size(), this->outputs().size());
 		sum_arr<T, T_SIZE>(this->outputs(), this->outputs(), _memory, this->outputs().size());
-		this->activation().apply_forward_inplace(this->outputs());
+		T_POLICY::apply_forward_inplace(this->_activation, this->outputs());
 	}
 
 	virtual void training_begin() {
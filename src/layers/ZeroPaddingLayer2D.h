@@ -17,7 +17,7 @@ class ZeroPaddingLayer2D : public LayerBase<T, T_SIZE> {
 	T_SIZE _padding_w;
 	T_SIZE _padding_h;
 public:
-	ZeroPaddingLayer2D(T_INPUT& input, T_SIZE padding_w, T_SIZE padding_h) : T_LAYER(input, LUActivation<T>()) {
+	ZeroPaddingLayer2D(T_INPUT& input, T_SIZE padding_w, T_SIZE padding_h) : T_LAYER(input, lu_activation<T, T_SIZE>()) {
 		this->outputs().resize(input.width() + 2 * padding_w, input.height() + 2 * padding_h, input.depth());
 		this->outputs().fill(0);
 		_padding_w = padding_w;
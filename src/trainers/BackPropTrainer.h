@@ -1,6 +1,7 @@
 #if !defined(ENN_BACKPROP_TRAINER_H)
 #define ENN_BACKPROP_TRAINER_H
 
+#include <functional>
 #include <NeuralNetwork.h>
 #include <core/matvecop.h>
 
@@ -29,6 +30,7 @@ private:
 	T momentum;
 	T decay;
 	T current_momentum;
+	T_SIZE batch_size = 1;
 	const T_LOSS& loss_func;
 	EpochCallback_t callback;
 	void * callback_data;
@@ -48,6 +50,14 @@ public:
 		this->callback_data = callback_data;
 	}
 
+	///
+	/// number of samples whose weight updates are collected and applied at once
+	/// (see LayerBase::training_batch). 1 updates the weights after every sample.
+	/// should be set before init()
+	///
+	inline void batch(T_SIZE size) { batch_size = size; }
+	inline T_SIZE batch() const { return batch_size; }
+
 	virtual void init(const T_INPUT &inputs, const T_INPUT &outputs, NeuralNetwork<T, T_SIZE>* network) override {
 		TrainerBase<T, T_SIZE>::init(inputs, outputs, network);
 
@@ -55,6 +65,7 @@ public:
 
 		for (auto L : this->layers) {
 			L->training_begin();
+			L->training_batch(batch_size);
 
 			if (W_INIT != ENN_WEIGHTS_NONE && L->trainable()) {
 				// initialize weights
@@ -134,6 +145,11 @@ public:
 				++L;
 			}
 		}
+
+		// apply the updates of the last incomplete batch
+		for (auto L : this->layers)
+			L->update_end();
+
 		mean_error /= (T)this->inputs.size();
 	}
 };
@@ -0,0 +1,14 @@
+#
+# Cross compiles [env:native_aarch64] with the aarch64 GNU toolchain,
+# statically linked so that qemu-aarch64 runs it without a sysroot.
+#
+Import("env")
+
+env.Replace(
+	CC="aarch64-linux-gnu-gcc",
+	CXX="aarch64-linux-gnu-g++",
+	AR="aarch64-linux-gnu-ar",
+	RANLIB="aarch64-linux-gnu-ranlib",
+	LINK="aarch64-linux-gnu-g++",
+)
+env.Append(LINKFLAGS=["-static"])
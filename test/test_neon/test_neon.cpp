@@ -0,0 +1,326 @@
+///
+/// Checks the NEON kernels against the pure kernels of arch/pure, see [env:native_aarch64] in platformio.ini.
+/// Float kernels are compared with the pure kernels instantiated for double, int8 and
+/// FixedPointType<int16_t, EXPONENT> kernels must be bit exact with them.
+/// Sizes are chosen so that the vector loops and the scalar tails are both exercised.
+///
+#include <unity.h>
+#include <string.h>
+#include <math.h>
+#include <NeuralNetwork.h>
+
+using namespace EasyNeuralNetworks;
+
+typedef FixedPointType<int16_t, 10> F;
+
+static const size_t sizes[] = { 1, 3, 4, 7, 8, 15, 16, 17, 31, 64, 67 };
+static const size_t num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+
+static float rand_float(float range) { return (rand() % 20001 - 10000) * (range / 10000.0f); }
+
+static void fill(float * a, size_t num, float range = 1.0f) {
+	for (size_t i = 0; i < num; i++)
+		a[i] = rand_float(range);
+}
+
+static void fill(F * a, size_t num, int16_t range) {
+	for (size_t i = 0; i < num; i++)
+		a[i] = F::from_raw((int16_t)(rand() % (2 * range + 1) - range));
+}
+
+template<typename T, typename U>
+static void copy(T * dst, const U * src, size_t num) {
+	for (size_t i = 0; i < num; i++)
+		dst[i] = (T)src[i];
+}
+
+/// |A - REF| <= tolerance * (1 + |REF|)
+static void assert_near(const float * a, const double * ref, size_t num, double tolerance, const char * what) {
+	for (size_t i = 0; i < num; i++) {
+		char msg[96];
+		snprintf(msg, sizeof(msg), "%s [%u] %g != %g", what, (unsigned)i, a[i], ref[i]);
+		TEST_ASSERT_TRUE_MESSAGE(fabs(a[i] - ref[i]) <= tolerance * (1.0 + fabs(ref[i])), msg);
+	}
+}
+
+static void assert_equal(const F * a, const F * ref, size_t num, const char * what) {
+	for (size_t i = 0; i < num; i++) {
+		char msg[96];
+		snprintf(msg, sizeof(msg), "%s [%u]", what, (unsigned)i);
+		TEST_ASSERT_EQUAL_INT16_MESSAGE(ref[i].get_raw(), a[i].get_raw(), msg);
+	}
+}
+
+void setUp() { srand(1); }
+void tearDown() {}
+
+void test_arch() {
+	TEST_ASSERT_EQUAL_STRING("neon", mvo_arch_name());
+}
+
+void test_arr_ops() {
+	float a[67], b[67], dst[67];
+	double da[67], db[67], ref[67];
+	for (size_t s = 0; s < num_sizes; s++) {
+		const size_t n = sizes[s];
+		fill(a, n);
+		fill(b, n);
+		for (size_t i = 0; i < n; i++)
+			b[i] += b[i] < 0 ? -0.5f : 0.5f;
+		copy(da, a, n);
+		copy(db, b, n);
+		for (int op = ENN_ARR_SUM; op <= ENN_ARR_SQRDIFF; op++) {
+			for (int add = 0; add < 2; add++) {
+				fill(dst, n);
+				copy(ref, dst, n);
+				kernel_arr_binary((ENN_ARR_OP)op, add, dst, a, b, n);
+				kernel_arr_binary<double>((ENN_ARR_OP)op, add, ref, da, db, n);
+				assert_near(dst, ref, n, 1e-5, "arr_binary");
+				if (op > ENN_ARR_DIV)
+					continue;
+				copy(ref, dst, n);
+				kernel_arr_const((ENN_ARR_OP)op, add, dst, a, 0.75f, n);
+				kernel_arr_const<double>((ENN_ARR_OP)op, add, ref, da, 0.75, n);
+				assert_near(dst, ref, n, 1e-5, "arr_const");
+			}
+		}
+	}
+}
+
+void test_reductions() {
+	float a[67];
+	double da[67];
+	for (size_t s = 0; s < num_sizes; s++) {
+		const size_t n = sizes[s];
+		fill(a, n);
+		copy(da, a, n);
+		float r = kernel_sum_arr(a, n);
+		// a single block of the pairwise sums of the pure kernels, see ENN_REDUCE_BLOCK
+		double ref = kernel_block_sum_arr<double, false>(da, n);
+		assert_near(&r, &ref, 1, 1e-5, "sum_arr");
+		r = kernel_sqrsum_arr(a, n);
+		ref = kernel_block_sum_arr<double, true>(da, n);
+		assert_near(&r, &ref, 1, 1e-5, "sqrsum_arr");
+		for (int is_min = 0; is_min < 2; is_min++) {
+			size_t index = 0, ref_index = 0;
+			r = kernel_minmax_arr(is_min, &index, a, n);
+			ref = kernel_minmax_arr<double>(is_min, &ref_index, da, n);
+			TEST_ASSERT_EQUAL_FLOAT(ref, r);
+			TEST_ASSERT_EQUAL_UINT32(ref_index, index);
+		}
+		r = kernel_dot_product(a, a, n);
+		ref = kernel_dot_product<double>(da, da, n);
+		assert_near(&r, &ref, 1, 1e-5, "dot_product");
+	}
+}
+
+void test_mat_mul() {
+	static float vec[3 * 67], mat[68 * 67], dst[3 * 67], tmat[68 * 67];
+	static double dvec[3 * 67], dmat[68 * 67], ref[3 * 67];
+	for (size_t s = 0; s < num_sizes; s++) {
+		const size_t N = sizes[s], M = sizes[num_sizes - 1 - s];
+		for (int bias = 0; bias < 2; bias++) {
+			const size_t row = bias ? N + 1 : N;
+			fill(vec, 3 * N);
+			fill(mat, row * M);
+			copy(dvec, vec, 3 * N);
+			copy(dmat, mat, row * M);
+			for (int add = 0; add < 2; add++) {
+				fill(dst, 3 * M);
+				copy(ref, dst, 3 * M);
+				kernel_mat_mul(dst, vec, mat, N, M, bias, add);
+				kernel_mat_mul<double>(ref, dvec, dmat, N, M, bias, add);
+				assert_near(dst, ref, M, 1e-5, "mat_mul");
+
+				fill(dst, 3 * M);
+				copy(ref, dst, 3 * M);
+				kernel_mat_mul_batch(dst, vec, mat, N, M, 3, bias, add);
+				kernel_mat_mul_batch<double>(ref, dvec, dmat, N, M, 3, bias, add);
+				assert_near(dst, ref, 3 * M, 1e-5, "mat_mul_batch");
+
+				// VEC is M here, the result N
+				fill(dst, N);
+				copy(ref, dst, N);
+				kernel_mat_mul_transposed(dst, vec, mat, N, M, bias, add);
+				kernel_mat_mul_transposed<double>(ref, dvec, dmat, N, M, bias, add);
+				assert_near(dst, ref, N, 1e-5, "mat_mul_transposed");
+			}
+			kernel_mat_mul_relu(dst, vec, mat, N, M, bias, 0.1f);
+			kernel_mat_mul_relu<double>(ref, dvec, dmat, N, M, bias, 0.1);
+			assert_near(dst, ref, M, 1e-5, "mat_mul_relu");
+			kernel_mat_transpose(tmat, mat, row, M);
+			for (size_t j = 0; j < M; j++)
+				for (size_t i = 0; i < row; i++)
+					TEST_ASSERT_EQUAL_FLOAT(mat[i + j * row], tmat[j + i * M]);
+		}
+	}
+}
+
+void test_convolve() {
+	static float mat[3 * 20 * 17], kernel[5 * 3 * 5 * 4], dst[5 * 20 * 17];
+	static double dmat[3 * 20 * 17], dkernel[5 * 3 * 5 * 4], ref[5 * 20 * 17];
+	const size_t N = 20, M = 17, C = 3, K = 5, L = 4, F = 5;
+	const size_t row = C * K * L;
+	fill(mat, N * M * C);
+	fill(kernel, F * row);
+	copy(dmat, mat, N * M * C);
+	copy(dkernel, kernel, F * row);
+	for (size_t stride = 1; stride <= 2; stride++) {
+		const size_t NKS = (N - K) / stride + 1, MLS = (M - L) / stride + 1;
+		const size_t n1 = (N * M - K) / stride + 1;
+
+		fill(dst, n1);
+		copy(ref, dst, n1);
+		kernel_convolve_1d(dst, mat, kernel, N * M, K, stride);
+		kernel_convolve_1d<double>(ref, dmat, dkernel, N * M, K, stride);
+		assert_near(dst, ref, n1, 1e-5, "convolve_1d");
+
+		fill(dst, NKS * MLS);
+		copy(ref, dst, NKS * MLS);
+		kernel_convolve_2d(dst, mat, kernel, N, M, K, L, stride);
+		kernel_convolve_2d<double>(ref, dmat, dkernel, N, M, K, L, stride);
+		assert_near(dst, ref, NKS * MLS, 1e-5, "convolve_2d");
+
+		// a block of 4 kernels and a single one
+		memset(dst, 0, sizeof(dst));
+		memset(ref, 0, sizeof(ref));
+		kernel_convolve_2d_multi(dst, mat, kernel, row, N, M, C, K, L, F, stride);
+		kernel_convolve_2d_multi<double>(ref, dmat, dkernel, row, N, M, C, K, L, F, stride);
+		assert_near(dst, ref, NKS * MLS * F, 1e-5, "convolve_2d_multi");
+	}
+}
+
+void test_math() {
+	static float a[67], dst[67], scalar[67];
+	static double ref[67];
+	for (size_t s = 0; s < num_sizes; s++) {
+		const size_t n = sizes[s];
+		fill(a, n, 12.0f);
+		a[0] = -100.0f;
+		for (int func = ENN_MATH_EXP; func <= ENN_MATH_SOFTPLUS; func++) {
+			for (int accuracy = ENN_MATH_FAST; accuracy <= ENN_MATH_EXACT; accuracy++) {
+				kernel_math_arr((ENN_MATH_FUNC)func, (ENN_MATH_ACCURACY)accuracy, dst, a, n);
+				// the pure scalar approximations of the same tier
+				switch (func) {
+					case ENN_MATH_EXP: math_func_arr<float, ENN_MATH_EXP>((ENN_MATH_ACCURACY)accuracy, scalar, a, n); break;
+					case ENN_MATH_TANH: math_func_arr<float, ENN_MATH_TANH>((ENN_MATH_ACCURACY)accuracy, scalar, a, n); break;
+					case ENN_MATH_SIGMOID: math_func_arr<float, ENN_MATH_SIGMOID>((ENN_MATH_ACCURACY)accuracy, scalar, a, n); break;
+					case ENN_MATH_SOFTPLUS: math_func_arr<float, ENN_MATH_SOFTPLUS>((ENN_MATH_ACCURACY)accuracy, scalar, a, n); break;
+				}
+				copy(ref, scalar, n);
+				assert_near(dst, ref, n, 1e-6, "math_arr");
+			}
+		}
+		fill(dst, n);
+		kernel_relu_arr(dst, a, 0.01f, n);
+		for (size_t i = 0; i < n; i++)
+			TEST_ASSERT_EQUAL_FLOAT(a[i] > 0 ? a[i] : 0.01f * a[i], dst[i]);
+	}
+}
+
+void test_quantized() {
+	static int8_t vec[67], mat[67 * 67];
+	static int16_t wvec[67], wmat[67 * 67];
+	static int32_t dst[67], ref[67];
+	static float fvec[67], fdst[67];
+	static double dvec[67], dref[67];
+	for (size_t s = 0; s < num_sizes; s++) {
+		const size_t N = sizes[s], M = sizes[num_sizes - 1 - s];
+		for (size_t i = 0; i < N; i++)
+			wvec[i] = vec[i] = (int8_t)(rand() % 256 - 128);
+		for (size_t i = 0; i < N * M; i++)
+			wmat[i] = mat[i] = (int8_t)(rand() % 256 - 128);
+		kernel_qmat_mul(dst, vec, mat, N, M);
+		kernel_qmat_mul<int16_t>(ref, wvec, wmat, N, M);
+		TEST_ASSERT_EQUAL_INT32_ARRAY(ref, dst, M);
+
+		fill(fvec, N);
+		copy(dvec, fvec, N);
+		kernel_wmat_mul_i8(fdst, fvec, mat, N, M);
+		kernel_wmat_mul_i8<double>(dref, dvec, mat, N, M);
+		assert_near(fdst, dref, M, 1e-5, "wmat_mul_i8");
+		kernel_wmat_mul_i4(fdst, fvec, (const uint8_t *)mat, N, M);
+		kernel_wmat_mul_i4<double>(dref, dvec, (const uint8_t *)mat, N, M);
+		assert_near(fdst, dref, M, 1e-5, "wmat_mul_i4");
+	}
+}
+
+void test_fixed16_arr_ops() {
+	F a[67], b[67], dst[67], ref[67];
+	for (size_t s = 0; s < num_sizes; s++) {
+		const size_t n = sizes[s];
+		// the full range, sums and products wrap around as FixedPointType does
+		fill(a, n, 32767);
+		fill(b, n, 32767);
+		for (int op = ENN_ARR_SUM; op <= ENN_ARR_MUL; op++) {
+			for (int add = 0; add < 2; add++) {
+				fill(dst, n, 32767);
+				copy(ref, dst, n);
+				kernel_arr_binary((ENN_ARR_OP)op, add, dst, a, b, n);
+				kernel_arr_binary<F>((ENN_ARR_OP)op, add, ref, a, b, n);
+				assert_equal(dst, ref, n, "fixed16 arr_binary");
+				copy(ref, dst, n);
+				kernel_arr_const((ENN_ARR_OP)op, add, dst, a, b[0], n);
+				kernel_arr_const<F>((ENN_ARR_OP)op, add, ref, a, b[0], n);
+				assert_equal(dst, ref, n, "fixed16 arr_const");
+			}
+		}
+	}
+}
+
+void test_fixed16_mat_mul() {
+	static F vec[67], mat[68 * 67], dst[67], ref[67];
+	static int32_t wvec[67], wmat[68 * 67];
+	for (size_t s = 0; s < num_sizes; s++) {
+		const size_t N = sizes[s], M = sizes[num_sizes - 1 - s];
+		for (int bias = 0; bias < 2; bias++) {
+			const size_t row = bias ? N + 1 : N;
+			// up to 4.0 in magnitude, large enough for the outputs to saturate
+			fill(vec, N, 4096);
+			fill(mat, row * M, 4096);
+			for (size_t i = 0; i < N; i++)
+				wvec[i] = vec[i].get_raw();
+			for (size_t i = 0; i < row * M; i++)
+				wmat[i] = mat[i].get_raw();
+			for (int add = 0; add < 2; add++) {
+				fill(dst, M, 4096);
+				// the pure kernel: the exact sum of the raw products, rounded and saturated once
+				for (size_t j = 0; j < M; j++) {
+					int64_t acc = kernel_fixed_dot<int32_t>(wvec, wmat + j * row, N);
+					if (bias)
+						acc += (int64_t)wmat[j * row + N] << 10;
+					if (add)
+						acc += (int64_t)dst[j].get_raw() << 10;
+					ref[j] = F::from_raw(fixed_narrow<int16_t>((int32_t)acc, 10));
+				}
+				kernel_mat_mul(dst, vec, mat, N, M, bias, add);
+				assert_equal(dst, ref, M, "fixed16 mat_mul");
+			}
+
+			F r = kernel_dot_product(vec, mat, N);
+			F rref = F::from_raw(fixed_narrow<int16_t>((int32_t)kernel_fixed_dot<int32_t>(wvec, wmat, N), 10));
+			assert_equal(&r, &rref, 1, "fixed16 dot_product");
+
+			// VEC is M here, the result N
+			fill(dst, N, 4096);
+			copy(ref, dst, N);
+			kernel_mat_mul_transposed(dst, vec, mat, N, M, bias, true);
+			kernel_mat_mul_transposed<F>(ref, vec, mat, N, M, bias, true);
+			assert_equal(dst, ref, N, "fixed16 mat_mul_transposed");
+		}
+	}
+}
+
+int main() {
+	UNITY_BEGIN();
+	RUN_TEST(test_arch);
+	RUN_TEST(test_arr_ops);
+	RUN_TEST(test_reductions);
+	RUN_TEST(test_mat_mul);
+	RUN_TEST(test_convolve);
+	RUN_TEST(test_math);
+	RUN_TEST(test_quantized);
+	RUN_TEST(test_fixed16_arr_ops);
+	RUN_TEST(test_fixed16_mat_mul);
+	return UNITY_END();
+}
@@ -0,0 +1,93 @@
+///
+/// Checks max pooling and the min/max reductions on integer types, see [env:native] in platformio.ini.
+/// The int8 layers pool the quantized values as they are (see QuantizedLayerBase), so values
+/// below the zero point, which are negative, must pool like any other. The same goes for the
+/// int16 mantissas of the block floating point layers.
+///
+#include <unity.h>
+#include <NeuralNetwork.h>
+
+using namespace EasyNeuralNetworks;
+
+typedef ENN_DEFAULT_SIZE_TYPE S;
+
+void setUp() {}
+void tearDown() {}
+
+void test_int8_max_pooling_2d() {
+	static int8_t in[16];
+	for (int i = 0; i < 16; i++)
+		in[i] = (int8_t)(-100 + i);
+	tensor<int8_t, S> t(in, 4, 4, 1);
+	MaxPoolingLayer2D<int8_t, S> mp(t, 2, 2);
+	mp.forward();
+	const int8_t expected[] = { -95, -93, -87, -85 };
+	TEST_ASSERT_EQUAL_INT8_ARRAY(expected, mp.outputs().data(), 4);
+}
+
+void test_int8_max_pooling_1d() {
+	static int8_t in[16];
+	for (int i = 0; i < 16; i++)
+		in[i] = (int8_t)(-128 + 3 * i);
+	tensor<int8_t, S> t(in, 16, 1, 1);
+	MaxPoolingLayer1D<int8_t, S> mp(t, 4);
+	mp.forward();
+	const int8_t expected[] = { -119, -107, -95, -83 };
+	TEST_ASSERT_EQUAL_INT8_ARRAY(expected, mp.outputs().data(), 4);
+}
+
+void test_int8_min_max() {
+	const int8_t a[] = { -5, -9, -3, -9, -128, -2, -7, -1 };
+	S index = 0, x = 0, y = 0;
+
+	TEST_ASSERT_EQUAL_INT8(-1, (max_arr<int8_t, S>(&index, a, 8)));
+	TEST_ASSERT_EQUAL(7, index);
+	TEST_ASSERT_EQUAL_INT8(-128, (min_arr<int8_t, S>(&index, a, 8)));
+	TEST_ASSERT_EQUAL(4, index);
+	// strided: -5, -3, -128, -7
+	TEST_ASSERT_EQUAL_INT8(-3, (max_arr<int8_t, S>(&index, a, 4, 2)));
+	TEST_ASSERT_EQUAL(1, index);
+	TEST_ASSERT_EQUAL_INT8(-128, (min_arr<int8_t, S>(&index, a, 4, 2)));
+	TEST_ASSERT_EQUAL(2, index);
+
+	// 4x2 matrix, the 3x2 window on the left
+	TEST_ASSERT_EQUAL_INT8(-2, (max_mat<int8_t, S>(&x, &y, a, 4, 3, 2)));
+	TEST_ASSERT_EQUAL(1, x);
+	TEST_ASSERT_EQUAL(1, y);
+	TEST_ASSERT_EQUAL_INT8(-128, (min_mat<int8_t, S>(&x, &y, a, 4, 3, 2)));
+	TEST_ASSERT_EQUAL(0, x);
+	TEST_ASSERT_EQUAL(1, y);
+	// stride 2: -5, -3 and -128, -7
+	TEST_ASSERT_EQUAL_INT8(-3, (max_mat<int8_t, S>(&x, &y, a, 4, 2, 2, 2)));
+	TEST_ASSERT_EQUAL(1, x);
+	TEST_ASSERT_EQUAL(0, y);
+}
+
+void test_bfp_max_pooling() {
+	// two depth slices of negative values, one exponent each, see BlockFloatLayerBase
+	static float x[32];
+	for (int i = 0; i < 32; i++)
+		x[i] = -0.5f + 0.01f * i - (i < 16 ? 1.5f : 0);
+	static int16_t in[32];
+	static int8_t exponents[2];
+	to_bfp_arr<int16_t, S>(in, exponents, x, 32, 16);
+	tensor<int16_t, S> t(in, 4, 4, 2);
+	MaxPoolingLayer2D<int16_t, S> mp(t, 2, 2);
+	mp.forward();
+	float y[8];
+	from_bfp_arr<int16_t, S>(y, mp.outputs().data(), exponents, 8, 4);
+	const S max_index[] = { 5, 7, 13, 15 };
+	for (int i = 0; i < 8; i++) {
+		TEST_ASSERT_TRUE_MESSAGE(mp.outputs().data()[i] < 0, "negative mantissa");
+		TEST_ASSERT_TRUE_MESSAGE(fabs(y[i] - x[16 * (i / 4) + max_index[i % 4]]) < 1e-3f, "max of the window");
+	}
+}
+
+int main() {
+	UNITY_BEGIN();
+	RUN_TEST(test_int8_max_pooling_2d);
+	RUN_TEST(test_int8_max_pooling_1d);
+	RUN_TEST(test_int8_min_max);
+	RUN_TEST(test_bfp_max_pooling);
+	return UNITY_END();
+}